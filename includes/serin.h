@@ -1,10 +1,16 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 #include <memory>
 #include <optional>
+#include <initializer_list>
+#include <functional>
 
 #include "ordered_map.h"
 
@@ -15,11 +21,20 @@ enum class Type {
     JSON,
     TOON,
     YAML,
+    SERIN_BIN, // binary snapshot, .serinb
     UNKOWN
 };
 
 Type stringToType(const std::string & name);
 
+// Guesses the format of a document from its first bytes: `{`, `[` and
+// string scalars are JSON unless they start a TOON array header such as
+// `[3]:`; a `key[2]{a,b}:` header anywhere in `head` marks TOON, and other
+// text is YAML. Key/value lines read the same in TOON and YAML, so pass as
+// much of the start as is at hand. The binary format is told by its magic
+// bytes. Returns Type::UNKOWN for blank input.
+Type sniff(std::string_view head);
+
 // Forward declarations
 struct Value;
 
@@ -51,6 +66,16 @@ struct Primitive: std::variant<std::string, double, int64_t, bool, std::nullptr_
     
     // Conversion to string
     std::string asString() const;
+
+    // Upper bound on the text length of any non-string primitive.
+    static constexpr size_t MAX_SCALAR_LENGTH = 40;
+
+    // Appends the textual form to `out` without creating a temporary string.
+    void appendTo(std::string& out) const;
+
+    // Writes the textual form into `buffer` when it fits in `size` bytes and
+    // returns the full length (no null terminator is written).
+    size_t writeTo(char* buffer, size_t size) const;
 };
 
 struct Value {
@@ -93,6 +118,12 @@ struct EncoderOptions {
     EncoderOptions(int indent) : indent(std::max(0, indent)) {}
 };
 
+// Maximum nesting depth accepted by loaders and emitters. Deeper documents
+// raise std::runtime_error instead of exhausting the call stack.
+constexpr size_t DEFAULT_MAX_DEPTH = 1024;
+void setMaxDepth(size_t depth);
+size_t getMaxDepth();
+
 // Utility functions
 bool isPrimitive(const Value& value);
 bool isObject(const Value& value);
@@ -117,6 +148,14 @@ Value loadsYaml(const std::string& yamlString);
 std::string dumpsYaml(const Value& value, int indent = 2);
 void dumpYaml(const Value& value, const std::string& filename, int indent = 2);
 
+// Binary snapshot functions (.serinb): a Value tree laid out with relative
+// offsets, so a file can be memory-mapped and read in place through
+// BinaryDocument without parsing. dumps() returns the bytes in a string.
+Value loadBinary(const std::string& filename);
+Value loadsBinary(std::string_view data);
+std::string dumpsBinary(const Value& value);
+void dumpBinary(const Value& value, const std::string& filename);
+
 // Generic file format functions (auto-detect format from file extension)
 Value load(const std::string& filename);
 void dump(const Value& value, const std::string& filename);
@@ -125,4 +164,797 @@ void dump(const Value& value, const std::string& filename);
 Value loads(const std::string& content, Type format);
 std::string dumps(const Value& value, Type format, int indent = 2);
 
+// Outcome of validate(). On failure the position points at the first error.
+struct ValidationResult {
+    bool valid = true;
+    size_t offset = 0; // byte offset into the content
+    size_t line = 0;   // 1-based
+    size_t column = 0; // 1-based, in bytes
+    std::string message;
+
+    explicit operator bool() const { return valid; }
+};
+
+// Checks that `content` is well-formed without building a Value. This is
+// stricter than load(): the YAML and TOON loaders read some malformed input
+// without an error, and validate() reports it.
+//   - JSON: the yyjson reader, plus the nesting limit load() applies
+//   - YAML: the block structure the loader understands (indentation, keys,
+//     items, quoted scalars). Also rejected, though the loader reads them:
+//     lines it would skip or stop at, duplicate keys (it keeps the first),
+//     unterminated quotes and tabs in indentation
+//   - TOON: strict structure: indentation, quoting and escapes, and that
+//     `[N]` lengths and `{fields}` match the values, rows and items present
+//   - SERIN_BIN: the header, and that every slot, string and key table lies
+//     inside the file; errors are on line 1, with the byte offset as column
+// Throws std::runtime_error only for an unsupported format.
+ValidationResult validate(std::string_view content, Type format);
+// Validates a file, choosing the format from its extension.
+ValidationResult validateFile(const std::string& filename);
+
+// Shape profile of a document, gathered in one pass without converting it.
+struct DocumentStats {
+    size_t objects = 0;
+    size_t arrays = 0;
+    size_t strings = 0;
+    size_t integers = 0;
+    size_t doubles = 0;
+    size_t booleans = 0;
+    size_t nulls = 0;
+    size_t maxDepth = 0; // containers on the deepest path; 0 for a scalar document
+    // Non-empty arrays of objects sharing the same keys with only primitive
+    // values: the arrays TOON writes as tables.
+    size_t tabularArrays = 0;
+    // Occurrences of each member name, most frequent first.
+    std::vector<std::pair<std::string, size_t>> keyFrequency;
+    // stringLengths[0] counts empty strings and stringLengths[i] lengths in
+    // [2^(i-1), 2^i); the last bucket also holds everything longer.
+    std::array<size_t, 17> stringLengths{};
+    // Estimated size of dumps() output with indent 2.
+    size_t jsonBytes = 0;
+    size_t yamlBytes = 0;
+    size_t toonBytes = 0;
+
+    size_t nodes() const { return objects + arrays + strings + integers + doubles + booleans + nulls; }
+    double tabularShare() const { return arrays ? static_cast<double>(tabularArrays) / arrays : 0.0; }
+};
+
+// Walks a loaded Value.
+DocumentStats stats(const Value& value);
+// Scans text without building a Value: JSON through the yyjson DOM, YAML and
+// TOON through the validate() tokenisers, SERIN_BIN by walking its slots.
+// YAML and TOON that validate() rejects are loaded and walked instead, so
+// the profile describes what load() reads. Throws std::runtime_error on
+// input load() rejects.
+DocumentStats stats(std::string_view content, Type format);
+DocumentStats statsFile(const std::string& filename);
+
+// Compiled query over a Value tree. Accepts JSON Pointer ("/statuses/*/id",
+// "/statuses/0:10/user/name") and a JSONPath subset ("$.statuses[*].user.name",
+// "$.a['b c'][-1]", "$.items[1:5:2]", "$.users[?(@.age >= 18)].name").
+// Member names are hashed once at compile time; evaluation creates no
+// temporary key strings and returns pointers into the queried tree.
+class Path {
+public:
+    enum class FilterOp { Exists, Equal, NotEqual, Less, LessEqual, Greater, GreaterEqual };
+
+    struct Step {
+        enum class Kind { Key, Index, Wildcard, Slice, Filter };
+        Kind kind = Kind::Key;
+        // Member name and its hash. Index and Slice steps compiled from a JSON
+        // Pointer segment keep the segment here and use it on objects.
+        std::string key;
+        size_t hash = 0;
+        // Index (negative counts from the end) or slice bounds
+        int64_t index = 0;
+        std::optional<int64_t> start;
+        std::optional<int64_t> end;
+        int64_t step = 1;
+        // Filter: children whose member path `filterKeys` compares to `literal`
+        std::vector<std::pair<std::string, size_t>> filterKeys;
+        FilterOp op = FilterOp::Exists;
+        Primitive literal;
+    };
+
+    // Throws std::runtime_error if the expression is malformed.
+    explicit Path(std::string_view expression);
+
+    const std::string& expression() const { return expression_; }
+    const std::vector<Step>& steps() const { return steps_; }
+
+    // True when the path can match at most one value (only key and index steps).
+    bool isSingular() const;
+
+    // All matches in document order.
+    std::vector<const Value*> evaluate(const Value& root) const;
+    std::vector<Value*> evaluate(Value& root) const;
+
+    // First match, or nullptr.
+    const Value* find(const Value& root) const;
+    Value* find(Value& root) const;
+
+private:
+    std::string expression_;
+    std::vector<Step> steps_;
+};
+
+namespace detail { struct ProjectionNode; }
+
+// The parts of a document to materialise when loading: a set of paths made
+// of key, index, wildcard and slice steps. Everything below a selected path
+// is kept; subtrees off every path are skipped without building values.
+class Projection {
+public:
+    Projection();
+    Projection(std::initializer_list<std::string_view> paths);
+
+    // Throws std::runtime_error for malformed paths or filter steps.
+    void add(std::string_view path);
+    void add(const Path& path);
+
+    const detail::ProjectionNode& root() const { return *root_; }
+
+private:
+    std::shared_ptr<detail::ProjectionNode> root_;
+};
+
+// Sparse loading: the result keeps the document's shape along the selected
+// paths and drops everything else. JSON is filtered while converting from the
+// yyjson DOM and YAML skips unselected blocks by indentation.
+Value load(const std::string& filename, const Projection& projection);
+Value loads(const std::string& content, Type format, const Projection& projection);
+
+// Applies a projection to an already loaded value.
+Value project(const Value& value, const Projection& projection);
+
+// Read-only view of one value inside a BinaryDocument. A view is a few
+// words, cheap to copy, and valid while its document is. Accessors read the
+// mapped bytes directly; offsets are checked as they are followed, so a
+// damaged file raises std::runtime_error instead of reading out of
+// bounds. Asking a view for the wrong kind also throws std::runtime_error.
+class BinaryView {
+public:
+    enum class Kind : uint8_t { Null, Bool, Int, Double, String, Array, Object };
+
+    Kind kind() const { return kind_; }
+    bool isNull() const { return kind_ == Kind::Null; }
+    bool isBool() const { return kind_ == Kind::Bool; }
+    bool isInt() const { return kind_ == Kind::Int; }
+    bool isDouble() const { return kind_ == Kind::Double; }
+    bool isNumber() const { return isInt() || isDouble(); }
+    bool isString() const { return kind_ == Kind::String; }
+    bool isArray() const { return kind_ == Kind::Array; }
+    bool isObject() const { return kind_ == Kind::Object; }
+
+    bool asBool() const;
+    int64_t asInt() const;
+    // Ints are converted, as Primitive::getNumber() does
+    double asDouble() const;
+    // Points into the document
+    std::string_view asString() const;
+
+    // Items of an array or members of an object; 0 for scalars.
+    size_t size() const;
+    // Array item, or object member value in document order.
+    BinaryView operator[](size_t index) const;
+    // Key of object member `index`.
+    std::string_view key(size_t index) const;
+    // Object member by key, using the sorted key table (O(log n)).
+    std::optional<BinaryView> find(std::string_view key) const;
+    // Like find(), throwing std::runtime_error for a missing key.
+    BinaryView at(std::string_view key) const;
+
+    // Builds the Value this view stands for, and everything below it.
+    Value toValue() const;
+
+private:
+    friend class BinaryDocument;
+    BinaryView(std::string_view data, uint64_t slot);
+
+    std::string_view data_;
+    uint64_t slot_ = 0;
+    Kind kind_ = Kind::Null;
+    uint32_t count_ = 0;
+    uint64_t payload_ = 0;
+};
+
+// A .serinb file mapped into memory. Opening checks the header only; nothing
+// is decoded until a view asks for it, so startup costs the same for any
+// document size and pages are shared between processes mapping one file.
+class BinaryDocument {
+public:
+    // Throws std::runtime_error if the file cannot be opened or is not a
+    // serin binary document.
+    explicit BinaryDocument(const std::string& filename);
+    // Views `bytes` (e.g. from dumpsBinary()) in place; they must outlive the
+    // document and its views.
+    static BinaryDocument fromBytes(std::string_view bytes);
+    ~BinaryDocument();
+    BinaryDocument(BinaryDocument&&) noexcept;
+    BinaryDocument& operator=(BinaryDocument&&) noexcept;
+
+    BinaryView root() const;
+    // The whole file
+    std::string_view bytes() const;
+
+private:
+    struct Impl;
+    explicit BinaryDocument(std::unique_ptr<Impl> impl);
+    std::unique_ptr<Impl> impl_;
+};
+
+// Pull reader for one tabular array in a TOON file (a `key[N]{a,b,...}:`
+// header followed by one row per line). The file is memory-mapped and rows
+// are returned as views into it, so memory use does not grow with the table.
+// Column selection and predicates are applied while a row is tokenised:
+// rejected rows are skipped to the next line without building any cells.
+class ToonTableReader {
+public:
+    // One accepted row, holding the selected columns in selection order.
+    // Views stay valid for the lifetime of the reader.
+    class Row {
+    public:
+        size_t size() const { return cells_.size(); }
+        // Raw cell text as written in the file, quotes included.
+        std::string_view text(size_t column) const { return cells_[column]; }
+        // Cell decoded into a number, boolean, null or unescaped string.
+        Primitive value(size_t column) const;
+        // 1-based line number of the row in the input.
+        size_t line() const { return line_; }
+
+    private:
+        friend class ToonTableReader;
+        std::vector<std::string_view> cells_;
+        size_t line_ = 0;
+    };
+
+    // Opens `filename` and reads the header of the table stored under `key`,
+    // or of the first table when `key` is empty.
+    // Throws std::runtime_error if the file has no such table.
+    explicit ToonTableReader(const std::string& filename, std::string_view key = {});
+    ~ToonTableReader();
+    ToonTableReader(ToonTableReader&&) noexcept;
+    ToonTableReader& operator=(ToonTableReader&&) noexcept;
+
+    const std::string& key() const;
+    size_t declaredRows() const;
+    char delimiter() const;
+    const std::vector<std::string>& fields() const;
+    // Selected columns in output order (all fields unless select() was called).
+    const std::vector<std::string>& columns() const;
+
+    // Restricts rows to `columns`. Throws std::runtime_error for unknown fields.
+    void select(const std::vector<std::string>& columns);
+    // Adds a predicate; rows must satisfy all of them. Comparisons follow Path
+    // filters. The string form is `field op literal`, e.g. `age >= 30` or
+    // `role == 'admin'`.
+    void where(const std::string& field, Path::FilterOp op, Primitive literal);
+    void where(std::string_view expression);
+
+    // Reads the next accepted row into `row`. Returns false at the end of the table.
+    // Throws std::runtime_error for rows with the wrong number of cells.
+    bool next(Row& row);
+    // Restarts from the first row, keeping the selection and predicates.
+    void rewind();
+    // Rows read so far, including rejected ones.
+    size_t rowsScanned() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// Incremental parser for documents that arrive in chunks. Each feed() parses
+// as far as the data allows and carries the incomplete tail (a partial line
+// for YAML, the unfinished top-level entry for JSON) into the next call. With
+// a callback, completed top-level entries (mapping members or sequence items)
+// are handed over as soon as they are known to be finished and are not kept:
+// a JSON entry when its last byte arrives, a YAML entry when the next one
+// starts. Duplicate keys and YAML lines after the end of the root block are
+// handled as loadsJson() and loadsYaml() handle them, except that with a
+// callback every JSON member is handed over, duplicates included.
+class PushParser {
+public:
+    struct Entry {
+        std::string key;  // member name, empty for sequence items
+        size_t index = 0; // position among the top-level entries
+        Value value;
+    };
+    using Callback = std::function<void(Entry&)>;
+
+    // `sizeHint` is the expected document size, used to size the JSON buffer.
+    explicit PushParser(Type format, Callback callback = {}, size_t sizeHint = 0);
+    ~PushParser();
+    PushParser(PushParser&&) noexcept;
+    PushParser& operator=(PushParser&&) noexcept;
+
+    // Throws std::runtime_error as soon as the input is known to be invalid.
+    void feed(const char* data, size_t size);
+    void feed(std::string_view chunk) { feed(chunk.data(), chunk.size()); }
+
+    // Parses what is still buffered and returns the document, then resets the
+    // parser for the next one, also when it throws. Entries already passed to the callback are not
+    // part of the result, which then only keeps the shape of the root.
+    // TOON input is buffered and decoded here.
+    Value finish();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// Options for convertStream().
+struct StreamOptions {
+    int indent = 2;
+    // Output format when writing to stdout; files use their extension.
+    Type outputType = Type::TOON;
+    // Write JSON as one compact document per line. Implied for `.ndjson` and
+    // `.jsonl` output files.
+    bool ndjson = false;
+};
+
+// Converts a file one top-level entry at a time, so peak memory follows the
+// largest entry rather than the document. The input is memory-mapped:
+//   - JSON: items of a top-level array or members of a top-level object
+//   - NDJSON (`.ndjson`, `.jsonl`): one entry per line
+//   - YAML: items or members at the root
+//   - TOON: the rows of a tabular array `key[N]{...}:`
+//   - SERIN_BIN: items or members of the root, read in place
+// TOON output of an array needs its length and layout up front, so the input
+// is read twice: the first pass works out the length and whether the items
+// form a table, the second writes them. Output matches what load() and
+// dump() would produce, including for repeated keys and YAML lines after the
+// end of the root block. A JSON object is first scanned for repeated member
+// names, so the first occurrence can be written with the last value.
+// `outputPath` empty writes to stdout.
+// Returns the number of entries converted; throws std::runtime_error.
+size_t convertStream(const std::string& inputPath, const std::string& outputPath,
+                     const StreamOptions& options = {});
+
+// Shapes of synthetic documents.
+enum class Shape {
+    Table,   // `rows`: uniform flat records (a TOON tabular array)
+    Wide,    // one root object with many members
+    Deep,    // `records`: objects nested `depth` levels
+    Strings, // `strings`: long strings with punctuation and non-ASCII text
+    Numeric, // `series`: arrays of large integers and doubles
+    Mixed    // `items`: records with nested objects, arrays and nulls
+};
+
+// Parses a shape name ("table", "wide", ...); throws std::runtime_error.
+Shape stringToShape(const std::string& name);
+
+struct GeneratorOptions {
+    Shape shape = Shape::Mixed;
+    // Approximate size of the document as dumpsJson() writes it
+    size_t targetBytes = 1 << 20;
+    uint64_t seed = 1;
+    // Nesting of each Shape::Deep record
+    size_t depth = 32;
+};
+
+// Builds a synthetic document. The same options always give the same
+// document, on every platform.
+Value generate(const GeneratorOptions& options = {});
+
+// Writes the document generate() would build, one entry at a time like
+// convertStream(), so multi-GB corpora need little memory. The format
+// follows the extension of `outputPath`; stdout uses `streamOptions`.
+// Returns the number of entries written.
+size_t generateFile(const std::string& outputPath, const GeneratorOptions& options = {},
+                    const StreamOptions& streamOptions = {});
+
+// Phases of loading and dumping: file I/O, tokenising, building the Value
+// tree, formatting and writing. Used by memoryStats() and tracing.
+enum class Phase { Read, Parse, Build, Emit, Write, Other };
+constexpr size_t PHASE_COUNT = 6;
+const char* phaseName(Phase phase);
+
+// Allocation counts gathered while enableMemoryStats() is on, split by the
+// phase of loading or dumping that made them. Bytes are the allocator's
+// block sizes; live and peak bytes are relative to the last resetMemoryStats().
+struct MemoryStats {
+
+    struct Counters {
+        size_t allocations = 0;
+        size_t bytes = 0;
+        size_t peakBytes = 0; // highest live total reached during the phase
+    };
+
+    std::array<Counters, PHASE_COUNT> phases{};
+    size_t allocations = 0;
+    size_t bytes = 0;
+    size_t liveBytes = 0;
+    size_t peakBytes = 0;
+
+    const Counters& phase(Phase p) const { return phases[static_cast<size_t>(p)]; }
+};
+
+// Memory a loaded document spends on structure, in bytes.
+struct NodeOverhead {
+    size_t value = 0;        // sizeof(Value): every node, inline in its parent
+    size_t object = 0;       // sizeof(Object), part of the Value holding it
+    size_t array = 0;        // sizeof(Array), part of the Value holding it
+    size_t objectMember = 0; // heap per object member: key, value and hash bucket
+    size_t arrayItem = 0;    // heap per array item
+    size_t inlineString = 0; // longest string (or key) that needs no allocation
+};
+
+// Counting is available to programs that link the serin_alloc_hooks target,
+// which replaces the global operator new/delete so that everything the
+// process allocates is counted. Without it, the SERIN_MEMORY_STATS CMake
+// option (off by default) counts only yyjson's blocks. Either way counting
+// stays off until enabled.
+bool memoryStatsAvailable();
+void enableMemoryStats(bool enabled = true);
+void resetMemoryStats();
+MemoryStats memoryStats();
+NodeOverhead nodeOverhead();
+
+// One completed phase of a load or dump.
+struct TraceEvent {
+    Phase phase = Phase::Other;
+    uint64_t startNs = 0;    // steady-clock time the phase began
+    uint64_t durationNs = 0;
+    size_t bytes = 0;        // text consumed or produced; 0 when not known
+    uint32_t thread = 0;     // small per-thread number, from 1
+};
+
+using TraceCallback = std::function<void(const TraceEvent&)>;
+
+// Reports every phase of every load, dump and conversion, on any thread, to
+// `callback`; the callback may run on several threads at once. An empty
+// callback turns tracing off, which leaves one relaxed atomic load per phase;
+// building without the SERIN_TRACING CMake option removes that too.
+void setTraceCallback(TraceCallback callback);
+bool tracingAvailable();
+
+// Records trace events between start() and stop() (or destruction), sums
+// them per phase and exports them in the Chrome trace format, which
+// chrome://tracing and Perfetto open. Only one recorder or callback is
+// active at a time: start() replaces the current trace callback.
+class TraceRecorder {
+public:
+    struct Totals {
+        size_t count = 0;
+        uint64_t durationNs = 0;
+        size_t bytes = 0;
+    };
+
+    TraceRecorder();
+    ~TraceRecorder();
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    void start();
+    void stop();
+    void clear();
+
+    std::vector<TraceEvent> events() const;
+    std::array<Totals, PHASE_COUNT> totals() const;
+
+    // {"traceEvents": [...]} with one complete ("X") event per phase;
+    // timestamps are microseconds from start().
+    std::string chromeTrace() const;
+    void writeChromeTrace(const std::string& filename) const;
+
+private:
+    struct Impl;
+    // Shared with the installed callback, which may outlive a stop() racing
+    // with events from other threads.
+    std::shared_ptr<Impl> impl_;
+};
+
+// Reusable parsing context. Keeps the yyjson allocator pool, the YAML line
+// index and the file read buffer between calls, so repeated loads of small
+// documents only pay for the parsing itself. Not thread-safe: use one per thread.
+class Parser {
+public:
+    Parser();
+    ~Parser();
+    Parser(Parser&&) noexcept;
+    Parser& operator=(Parser&&) noexcept;
+    Parser(const Parser&) = delete;
+    Parser& operator=(const Parser&) = delete;
+
+    Value loadsJson(std::string_view jsonString);
+    Value loadsToon(std::string_view toonString, bool strict = true);
+    Value loadsYaml(std::string_view yamlString);
+    Value loads(std::string_view content, Type format);
+
+    // Loads a file, detecting the format from its extension
+    Value load(const std::string& filename);
+
+    // Nesting limit for this context; defaults to getMaxDepth() at construction
+    void setMaxDepth(size_t depth);
+    size_t getMaxDepth() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// Reusable encoding context. Keeps the output buffer and the yyjson allocator
+// pool between calls. The returned strings are owned by the encoder and are
+// overwritten by its next call. Not thread-safe: use one per thread.
+class Encoder {
+public:
+    Encoder();
+    ~Encoder();
+    Encoder(Encoder&&) noexcept;
+    Encoder& operator=(Encoder&&) noexcept;
+    Encoder(const Encoder&) = delete;
+    Encoder& operator=(const Encoder&) = delete;
+
+    const std::string& dumpsJson(const Value& value, int indent = 2);
+    const std::string& dumpsToon(const Value& value, const EncoderOptions& options = {});
+    const std::string& dumpsYaml(const Value& value, int indent = 2);
+    const std::string& dumps(const Value& value, Type format, int indent = 2);
+
+    // Writes a file, detecting the format from its extension
+    void dump(const Value& value, const std::string& filename, int indent = 2);
+
+    void setMaxDepth(size_t depth);
+    size_t getMaxDepth() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// Thread-safe LRU cache of parsed documents. An entry is reused while the
+// file's size, modification time and inode (device and inode on POSIX) are
+// those it was parsed from, so a repeated load costs one stat(). Documents
+// are shared immutable handles that stay valid after eviction. Two threads
+// missing on the same file at once may both parse it.
+class DocumentCache {
+public:
+    struct Limits {
+        size_t maxBytes = size_t{256} << 20; // estimated memory of the cached Values
+        size_t maxEntries = 0;               // 0 for no limit
+    };
+
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;    // loads that parsed the file
+        size_t evictions = 0; // entries dropped for the limits or a changed file
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+
+    DocumentCache();
+    explicit DocumentCache(const Limits& limits);
+    ~DocumentCache();
+    DocumentCache(const DocumentCache&) = delete;
+    DocumentCache& operator=(const DocumentCache&) = delete;
+
+    // The document in `filename`, parsed as `format` (Type::UNKOWN: by
+    // extension). A document larger than Limits::maxBytes is returned but not
+    // kept. Throws like load().
+    std::shared_ptr<const Value> load(const std::string& filename, Type format = Type::UNKOWN);
+
+    void erase(const std::string& filename);
+    void clear();
+    void setLimits(const Limits& limits);
+    Stats stats() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// Routes load(filename) through `cache`, or stops doing so with nullptr.
+// load() still returns its own copy; use DocumentCache::load() directly to
+// share the cached document.
+void setLoadCache(std::shared_ptr<DocumentCache> cache);
+
+// Holder of an immutable value that is replaced as a whole: publish() swaps
+// in a new version and readers see the old one or the new one, never a mix.
+// Old versions are freed when the last Reader holding one moves on (or is
+// destroyed).
+//
+// Cost of reading. Each reading thread uses its own Reader, which keeps the
+// version it last saw:
+//   - Reader::get()/shared() while nothing new is published: one acquire load
+//     of the version counter. No lock, and no reference count traffic.
+//   - the first get() after a publish: one std::atomic_load of the shared_ptr,
+//     which takes one reference. The snapshot has no mutex; libstdc++ guards
+//     atomic shared_ptr access with a short spinlock picked by address from a
+//     global pool, held only for the copy.
+//   - load(): that same atomic_load on every call.
+// publish() is an atomic exchange plus the version increment.
+template <typename T>
+class Snapshot {
+public:
+    class Reader {
+    public:
+        explicit Reader(const Snapshot& snapshot) : snapshot_(&snapshot) {}
+
+        // The current version. The reference stays valid until the next
+        // get() or shared() on this Reader.
+        const T& get() { return *shared(); }
+
+        const std::shared_ptr<const T>& shared() {
+            // publish() stores the value before raising the version, so the
+            // value loaded here is at least as new as `version`
+            const uint64_t version = snapshot_->version_.load(std::memory_order_acquire);
+            if (version != version_) {
+                current_ = std::atomic_load_explicit(&snapshot_->current_, std::memory_order_acquire);
+                version_ = version;
+            }
+            return current_;
+        }
+
+    private:
+        const Snapshot* snapshot_;
+        uint64_t version_ = 0;
+        std::shared_ptr<const T> current_;
+    };
+
+    Snapshot() : current_(std::make_shared<const T>()) {}
+    explicit Snapshot(T value) : current_(std::make_shared<const T>(std::move(value))) {}
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+
+    void publish(T value) { publish(std::make_shared<const T>(std::move(value))); }
+
+    void publish(std::shared_ptr<const T> value) {
+        value = std::atomic_exchange_explicit(&current_, std::move(value), std::memory_order_acq_rel);
+        version_.fetch_add(1, std::memory_order_release);
+        // The previous version is released here, outside any reader's path
+    }
+
+    // A counted handle on the current version.
+    std::shared_ptr<const T> load() const { return std::atomic_load_explicit(&current_, std::memory_order_acquire); }
+
+    // Starts at 1 and grows by one with every publish().
+    uint64_t version() const { return version_.load(std::memory_order_acquire); }
+
+private:
+    std::shared_ptr<const T> current_;
+    std::atomic<uint64_t> version_{1};
+};
+
+// Keeps a Snapshot<Value> in step with a file. The constructor loads the file
+// (throwing like load() if that fails); a background thread then re-parses it
+// whenever it is written or replaced (inotify on Linux, a stat() poll twice a
+// second elsewhere) and publishes the result. A version that fails to parse
+// is reported to `onError` and the previous snapshot stays in place.
+class SnapshotWatcher {
+public:
+    using ErrorCallback = std::function<void(const std::string& message)>;
+
+    SnapshotWatcher(const std::string& filename, Snapshot<Value>& snapshot, ErrorCallback onError = {},
+                    Type format = Type::UNKOWN);
+    ~SnapshotWatcher();
+    SnapshotWatcher(const SnapshotWatcher&) = delete;
+    SnapshotWatcher& operator=(const SnapshotWatcher&) = delete;
+
+    // Versions published since the initial load.
+    size_t reloads() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// Re-parses a YAML document after edits, one top-level member at a time.
+// update() splits the text at the lines that start a member of the root
+// mapping; a member whose text is byte-for-byte the same as in the previous
+// update() keeps its parsed Value (the same shared pointer), and only changed
+// or new members are parsed again. A document whose root is not a mapping is
+// parsed whole. The result always matches loadsYaml() on the same text.
+class YamlReloader {
+public:
+    using Member = std::pair<std::string, std::shared_ptr<const Value>>;
+
+    struct Stats {
+        size_t sections = 0;      // top-level members in the text
+        size_t reparsed = 0;      // of which parsed by this update
+        size_t reparsedBytes = 0; // text parsed by this update
+    };
+
+    YamlReloader();
+    ~YamlReloader();
+    YamlReloader(const YamlReloader&) = delete;
+    YamlReloader& operator=(const YamlReloader&) = delete;
+
+    // Parses `yaml`, reusing unchanged members. Throws like loadsYaml(), in
+    // which case the previous document is kept.
+    const Stats& update(std::string_view yaml);
+
+    // Top-level members in document order; a repeated key keeps its first
+    // value, as in loadsYaml(). Empty when the root is not a mapping.
+    const std::vector<Member>& members() const;
+    // The member named `key`, or null.
+    std::shared_ptr<const Value> find(const std::string& key) const;
+    // The whole document. Copies the members; prefer members() or find() to
+    // share them.
+    Value value() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// Options for loadMany() and convertMany().
+struct BatchOptions {
+    // Worker threads; 0 uses std::thread::hardware_concurrency()
+    size_t threads = 0;
+    // Indent of converted output
+    int indent = 2;
+    // convertMany() only: manifest file of the input hashes and options of
+    // earlier conversions. Outputs it shows to be up to date are skipped, and
+    // it is rewritten (atomically) afterwards. Empty converts everything.
+    std::string manifest;
+};
+
+// Outcome of one file of loadMany().
+struct LoadResult {
+    std::string path;
+    Value value;
+    std::string error; // empty on success
+
+    bool ok() const { return error.empty(); }
+};
+
+// Outcome of one file of convertMany().
+struct ConvertResult {
+    std::string input;
+    std::string output;
+    size_t inputBytes = 0;
+    size_t outputBytes = 0;
+    bool skipped = false; // output was already up to date
+    std::string error; // empty on success
+
+    bool ok() const { return error.empty(); }
+};
+
+// Loads many files in parallel. Files are shared out to worker threads that
+// steal from each other when they run out, and each worker reuses one Parser
+// for all of its files. The threads belong to a pool that lives for the rest
+// of the process, so later calls start no new threads. Results come back in input order; a file that fails
+// gets its message in `error` instead of throwing.
+std::vector<LoadResult> loadMany(const std::vector<std::string>& paths, const BatchOptions& options = {});
+
+// Converts each (input, output) pair in parallel like loadMany(), writing
+// `format`, or the format of the output extension when `format` is
+// Type::UNKOWN. Each worker reuses one Parser and one Encoder. With
+// BatchOptions::manifest set, conversions whose input content, format and
+// indent match the manifest and whose output is unchanged are skipped.
+std::vector<ConvertResult> convertMany(const std::vector<std::pair<std::string, std::string>>& pairs,
+                                       Type format = Type::UNKOWN, const BatchOptions& options = {});
+
+// One output of dumpAll().
+struct DumpTarget {
+    std::string path;
+    Type format = Type::UNKOWN; // UNKOWN: from the extension of `path`
+    int indent = 2;
+};
+
+// Options for dumpShards(). A shard ends when either limit would be passed.
+struct ShardOptions {
+    size_t rows = 0;  // items per shard; 0 for no limit
+    size_t bytes = 0; // approximate bytes per shard, from stats() estimates; 0 for no limit
+    Type format = Type::UNKOWN; // UNKOWN: from the extension of the output path
+    int indent = 2;
+    size_t threads = 0; // 0: one per core
+};
+
+// Splits an array across numbered files: `rows.toon` becomes `rows-00000.toon`,
+// `rows-00001.toon`, ... The array is `value` itself, or the only member of
+// an object, whose key then wraps every shard (so TOON shards each get their
+// own `key[N]{...}:` header); an object with other members is rejected rather
+// than have them dropped. Shards are formatted in parallel straight from the
+// items, without copying them, and written as soon as each is done, so at
+// most one shard per thread is held as text. Returns the shard paths in
+// order; throws std::runtime_error.
+std::vector<std::string> dumpShards(const Value& value, const std::string& outputPath,
+                                    const ShardOptions& options);
+
+// Writes `value` to every target at once, each formatted by its own thread
+// into its own file. All targets are attempted; if any fail, the error of the
+// first failing target (in `targets` order) is thrown afterwards.
+void dumpAll(const Value& value, const std::vector<DumpTarget>& targets);
+
 } // namespace serin
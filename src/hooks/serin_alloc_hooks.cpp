@@ -0,0 +1,44 @@
+// Replacements for the global allocation functions, so that memoryStats()
+// covers everything the process allocates and not only yyjson's blocks.
+// Built as the serin_alloc_hooks target, which applications link explicitly;
+// libserin itself never replaces operator new.
+#include "serin_internal.h"
+
+#include <new>
+
+namespace {
+
+// Linking the hooks is what makes counting available, whatever the
+// SERIN_MEMORY_STATS option.
+[[maybe_unused]] const bool installed = (serin::detail::installCounting(), true);
+
+} // namespace
+
+// The aligned and nothrow forms keep their defaults, which end up here or are
+// freed by their own matching operator delete.
+void* operator new(std::size_t size) {
+    if (void* ptr = serin::detail::countedMalloc(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    serin::detail::countedFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    serin::detail::countedFree(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    serin::detail::countedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    serin::detail::countedFree(ptr);
+}
@@ -1,10 +1,43 @@
 #include "serin.h"
 #include "CLI11.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
 #include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+// `serin serve` and --connect use Unix domain sockets
+#if defined(__unix__) || defined(__APPLE__)
+#define SERIN_UNIX_SOCKETS
+#include <cerrno>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#endif
 
 #define STRINGIFY(x) #x
 #define MACRO_STRINGIFY(x) STRINGIFY(x)
@@ -17,16 +50,901 @@ const std::string serinVersion = MACRO_STRINGIFY(SERIN_VERSION);
 
 
 std::string availableFormats() {
-    return "json, toon, yaml";
+    return "json, toon, yaml, serinb";
 }
 
 void printHelp(const CLI::App &app) {
     std::cout << app.help() << std::endl;
 }
 
+std::vector<std::string> splitList(const std::string &list) {
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+// Writes a document and, for text, a newline to stdout. main() makes stdout
+// fully buffered in large blocks, so big documents go out in few writes.
+void writeStdout(std::string_view text, bool newline = true) {
+    if (std::fwrite(text.data(), 1, text.size(), stdout) != text.size() ||
+        (newline && std::fputc('\n', stdout) == EOF)) {
+        throw std::runtime_error("Error writing to stdout");
+    }
+}
+
+// Calls `consume` with successive blocks of stdin ("-") or a file, so input
+// is handled as it arrives instead of being read whole first.
+template <typename Consume>
+void readBlocks(const std::string &inputPath, Consume consume) {
+    const bool standardInput = inputPath == "-";
+    std::FILE *file = standardInput ? stdin : std::fopen(inputPath.c_str(), "rb");
+    if (!file) {
+        throw std::runtime_error("Cannot open file: " + inputPath);
+    }
+    std::unique_ptr<std::FILE, int (*)(std::FILE *)> closer(standardInput ? nullptr : file, &std::fclose);
+    std::vector<char> block(1 << 20);
+    size_t size;
+    while ((size = std::fread(block.data(), 1, block.size(), file)) > 0) {
+        consume(std::string_view(block.data(), size));
+    }
+    if (std::ferror(file)) {
+        throw std::runtime_error("Error reading " + (standardInput ? std::string("stdin") : inputPath));
+    }
+}
+
+serin::Type sniffedType(const std::string &inputPath, std::string_view head) {
+    const serin::Type type = serin::sniff(head);
+    if (type == serin::Type::UNKOWN) {
+        throw std::runtime_error("Cannot tell the format of " + (inputPath == "-" ? std::string("stdin") : inputPath) +
+                                 "; use -f/--from");
+    }
+    return type;
+}
+
+// Parses stdin or a file block by block; without a `type` the format is
+// sniffed from the first block. Binary documents are collected whole, since
+// their offsets point anywhere in the file.
+serin::Value readDocument(const std::string &inputPath, serin::Type type) {
+    std::optional<serin::PushParser> parser;
+    std::string binary;
+    readBlocks(inputPath, [&](std::string_view block) {
+        if (type == serin::Type::UNKOWN) {
+            type = sniffedType(inputPath, block);
+        }
+        if (type == serin::Type::SERIN_BIN) {
+            binary += block;
+            return;
+        }
+        if (!parser) {
+            parser.emplace(type);
+        }
+        parser->feed(block);
+    });
+    if (type == serin::Type::UNKOWN) {
+        sniffedType(inputPath, {});
+    }
+    // An explicit --from with nothing to read
+    if (!parser && binary.empty()) {
+        throw std::runtime_error("No input on " + (inputPath == "-" ? std::string("stdin") : inputPath));
+    }
+    if (type == serin::Type::SERIN_BIN) {
+        return serin::loadsBinary(binary);
+    }
+    return parser->finish();
+}
+
+serin::Type outputTypeFor(const std::string &outputPath, const std::string &outputType) {
+    if (!outputPath.empty()) {
+        const std::string extension = fs::path(outputPath).extension().string();
+        return serin::stringToType(extension.empty() ? extension : extension.substr(1));
+    }
+    return outputType.empty() ? serin::Type::TOON : serin::stringToType(outputType);
+}
+
+// Streams the accepted rows of a TOON table straight from the mapped input.
+// TOON output copies the cells verbatim; a first pass counts the rows so the
+// header can carry the length. Other formats materialise the filtered rows.
+void filterTable(serin::ToonTableReader &reader, serin::Type type, int indent,
+                 const std::string &outputPath) {
+    const auto &columns = reader.columns();
+    serin::ToonTableReader::Row row;
+
+    if (type != serin::Type::TOON) {
+        serin::Array rows;
+        while (reader.next(row)) {
+            serin::Object object;
+            for (size_t i = 0; i < columns.size(); ++i) {
+                object[columns[i]] = serin::Value(row.value(i));
+            }
+            rows.emplace_back(std::move(object));
+        }
+        serin::Object table;
+        table[reader.key()] = serin::Value(std::move(rows));
+        if (outputPath.empty()) {
+            writeStdout(serin::dumps(serin::Value(std::move(table)), type, indent));
+        } else {
+            serin::dump(serin::Value(std::move(table)), outputPath);
+        }
+        return;
+    }
+
+    size_t count = 0;
+    while (reader.next(row)) {
+        ++count;
+    }
+    reader.rewind();
+
+    std::ofstream file;
+    if (!outputPath.empty()) {
+        file.open(outputPath, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot open file for writing: " + outputPath);
+        }
+    }
+    std::ostream &out = outputPath.empty() ? std::cout : file;
+
+    const char delimiter = reader.delimiter();
+    std::string buffer = reader.key() + "[" + std::to_string(count) + "]{";
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (i > 0) {
+            buffer += delimiter;
+        }
+        buffer += columns[i];
+    }
+    buffer += "}:";
+
+    constexpr size_t flushThreshold = 1 << 20;
+    const std::string rowIndent(static_cast<size_t>(indent), ' ');
+    while (reader.next(row)) {
+        buffer += '\n';
+        buffer += rowIndent;
+        for (size_t i = 0; i < row.size(); ++i) {
+            if (i > 0) {
+                buffer += delimiter;
+            }
+            buffer += row.text(i);
+        }
+        if (buffer.size() >= flushThreshold) {
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if (outputPath.empty()) {
+        out << std::endl;
+    }
+    if (!out) {
+        throw std::runtime_error("Error writing table output");
+    }
+}
+
+// Parses sizes such as "4096", "64KB", "1.5MB" or "2G" (binary units).
+size_t parseSize(const std::string &text) {
+    size_t end = 0;
+    double number = -1;
+    try {
+        number = std::stod(text, &end);
+    } catch (const std::exception &) {
+    }
+    std::string unit = text.substr(end);
+    std::transform(unit.begin(), unit.end(), unit.begin(), ::toupper);
+    static const std::pair<const char *, double> units[] = {
+        {"", 1}, {"B", 1}, {"K", 1 << 10}, {"KB", 1 << 10}, {"M", 1 << 20}, {"MB", 1 << 20},
+        {"G", 1 << 30}, {"GB", 1 << 30}};
+    for (const auto &[name, scale] : units) {
+        if (number >= 0 && unit == name) {
+            return static_cast<size_t>(number * scale);
+        }
+    }
+    throw std::runtime_error("Invalid size: " + text);
+}
+
+// Applies `-t` to streamed output written to stdout; false for an unknown type.
+bool setStreamType(const std::string &outputType, serin::StreamOptions &options) {
+    if (outputType == "ndjson" || outputType == "jsonl") {
+        options.outputType = serin::Type::JSON;
+        options.ndjson = true;
+        return true;
+    }
+    options.outputType = serin::stringToType(outputType);
+    if (options.outputType == serin::Type::UNKOWN) {
+        std::cerr << "Unknown output type: " << outputType << std::endl;
+        std::cerr << "Supported formats: " << availableFormats() << ", ndjson" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::string formatBytes(size_t bytes) {
+    static const char* units[] = {"B", "KB", "MB", "GB", "TB"};
+    double size = static_cast<double>(bytes);
+    size_t unit = 0;
+    while (size >= 1024 && unit + 1 < std::size(units)) {
+        size /= 1024;
+        ++unit;
+    }
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(unit == 0 ? 0 : 1) << size << ' ' << units[unit];
+    return out.str();
+}
+
+void printStats(const std::string &inputPath, const serin::DocumentStats &stats, size_t topKeys) {
+    std::cout << inputPath << "\n"
+              << "  nodes:           " << stats.nodes() << " (" << stats.objects << " objects, " << stats.arrays
+              << " arrays, " << stats.strings << " strings, " << stats.integers << " integers, " << stats.doubles
+              << " doubles, " << stats.booleans << " booleans, " << stats.nulls << " nulls)\n"
+              << "  max depth:       " << stats.maxDepth << "\n"
+              << "  tabular arrays:  " << stats.tabularArrays << " of " << stats.arrays << " ("
+              << std::fixed << std::setprecision(1) << stats.tabularShare() * 100 << "%)\n"
+              << "  estimated size:  json " << formatBytes(stats.jsonBytes) << ", yaml "
+              << formatBytes(stats.yamlBytes) << ", toon " << formatBytes(stats.toonBytes) << "\n"
+              << "  string lengths:";
+    for (size_t i = 0; i < stats.stringLengths.size(); ++i) {
+        if (stats.stringLengths[i] == 0) {
+            continue;
+        }
+        const size_t low = i == 0 ? 0 : size_t{1} << (i - 1);
+        std::cout << "  " << low;
+        if (i + 1 == stats.stringLengths.size()) {
+            std::cout << "+";
+        } else if (i > 1) {
+            std::cout << "-" << (size_t{1} << i) - 1;
+        }
+        std::cout << ": " << stats.stringLengths[i];
+    }
+    std::cout << "\n  top keys:";
+    const size_t shown = std::min(topKeys, stats.keyFrequency.size());
+    for (size_t i = 0; i < shown; ++i) {
+        std::cout << (i == 0 ? " " : ", ") << stats.keyFrequency[i].first << " " << stats.keyFrequency[i].second;
+    }
+    std::cout << " (" << stats.keyFrequency.size() << " distinct)" << std::endl;
+}
+
+void printMemoryStats(const serin::MemoryStats &stats) {
+    std::cerr << "memory: " << stats.allocations << " allocations, " << formatBytes(stats.bytes)
+              << " allocated, peak " << formatBytes(stats.peakBytes) << "\n";
+    for (size_t i = 0; i < serin::PHASE_COUNT; ++i) {
+        const auto phase = static_cast<serin::Phase>(i);
+        const auto &counters = stats.phase(phase);
+        if (counters.allocations == 0) {
+            continue;
+        }
+        std::cerr << "  " << std::left << std::setw(7) << serin::phaseName(phase) << std::right
+                  << std::setw(10) << counters.allocations << " allocations " << std::setw(10)
+                  << formatBytes(counters.bytes) << "  peak " << formatBytes(counters.peakBytes) << "\n";
+    }
+    const serin::NodeOverhead overhead = serin::nodeOverhead();
+    std::cerr << "node overhead: value " << overhead.value << " B, object member " << overhead.objectMember
+              << " B, array item " << overhead.arrayItem << " B, strings up to " << overhead.inlineString
+              << " B inline" << std::endl;
+}
+
+void printProfile(const serin::TraceRecorder &recorder, std::chrono::steady_clock::duration elapsed) {
+    const double total = std::chrono::duration<double, std::milli>(elapsed).count();
+    std::cerr << "profile: " << std::fixed << std::setprecision(2) << total << " ms\n";
+    double traced = 0;
+    const auto totals = recorder.totals();
+    for (size_t i = 0; i < serin::PHASE_COUNT; ++i) {
+        const auto &phase = totals[i];
+        if (phase.count == 0) {
+            continue;
+        }
+        const double ms = phase.durationNs / 1e6;
+        traced += ms;
+        std::cerr << "  " << std::left << std::setw(7) << serin::phaseName(static_cast<serin::Phase>(i))
+                  << std::right << std::setw(10) << std::setprecision(2) << ms << " ms " << std::setw(6)
+                  << std::setprecision(1) << (total > 0 ? ms / total * 100 : 0) << "%";
+        if (phase.bytes > 0 && ms > 0) {
+            std::cerr << std::setw(11) << formatBytes(phase.bytes) << std::setw(10) << std::setprecision(1)
+                      << phase.bytes / ms / 1e3 << " MB/s";
+        }
+        std::cerr << "\n";
+    }
+    std::cerr << "  " << std::left << std::setw(7) << "rest" << std::right << std::setw(10) << std::setprecision(2)
+              << std::max(total - traced, 0.0) << " ms" << std::endl;
+}
+
+// Files under the given paths whose extension names a format, each paired with
+// its output under `outputDir`: the path relative to the directory it was
+// found in, with `extension`. A file given directly keeps only its name.
+std::vector<std::pair<std::string, std::string>> collectConversions(const std::vector<std::string> &inputs,
+                                                                    const fs::path &outputDir,
+                                                                    const std::string &extension) {
+    std::vector<std::pair<std::string, std::string>> pairs;
+    auto add = [&](const fs::path &file, const fs::path &relative) {
+        const std::string ext = file.extension().string();
+        if (ext.size() < 2 || serin::stringToType(ext.substr(1)) == serin::Type::UNKOWN) {
+            return;
+        }
+        pairs.emplace_back(file.string(), (outputDir / relative).replace_extension(extension).string());
+    };
+    for (const std::string &input : inputs) {
+        const fs::path root(input);
+        if (fs::is_directory(root)) {
+            std::vector<fs::path> files;
+            for (const auto &entry : fs::recursive_directory_iterator(root)) {
+                if (entry.is_regular_file()) {
+                    files.push_back(entry.path());
+                }
+            }
+            // Directory order is unspecified; sort so runs are repeatable
+            std::sort(files.begin(), files.end());
+            for (const fs::path &file : files) {
+                add(file, file.lexically_relative(root));
+            }
+        } else if (fs::is_regular_file(root)) {
+            add(root, root.filename());
+        } else {
+            throw std::runtime_error("Input not found: " + input);
+        }
+    }
+    return pairs;
+}
+
+// A conversion, validation or query as given on the command line. main()
+// runs it directly; `serin serve` runs it for clients of its socket.
+struct Request {
+    std::string inputPath;
+    serin::Type inputType = serin::Type::UNKOWN; // UNKOWN: extension, else sniffed
+    std::vector<std::string> outputPaths;        // none: the document goes to Response::out
+    std::string outputType;
+    std::string query;
+    int indent = 2;
+    bool check = false;
+    size_t splitRows = 0; // write numbered shards of the output instead
+    size_t splitBytes = 0;
+};
+
+struct Response {
+    int status = 0;
+    bool hasOutput = false; // `out` is a document for stdout
+    bool binary = false;    // `out` is binary and gets no trailing newline
+    std::string out;
+    std::string err;
+};
+
+using DocumentLoader = std::function<std::shared_ptr<const serin::Value>(const std::string &, serin::Type)>;
+
+bool knownExtension(const std::string &path) {
+    const std::string extension = fs::path(path).extension().string();
+    return extension.size() > 1 && serin::stringToType(extension.substr(1)) != serin::Type::UNKOWN;
+}
+
+// Files with a known extension and no --from are mapped and parsed by
+// extension; everything else goes through the block reader.
+std::shared_ptr<const serin::Value> loadLocal(const std::string &inputPath, serin::Type type) {
+    if (inputPath != "-" && type == serin::Type::UNKOWN && knownExtension(inputPath)) {
+        return std::make_shared<const serin::Value>(serin::load(inputPath));
+    }
+    return std::make_shared<const serin::Value>(readDocument(inputPath, type));
+}
+
+Response runRequest(const Request &request, const DocumentLoader &load, serin::Encoder &encoder) {
+    Response response;
+    auto fail = [&](const std::string &message) {
+        response.status = 1;
+        response.err += message + "\n";
+        return response;
+    };
+
+    try {
+        if (request.check) {
+            serin::ValidationResult result;
+            if (request.inputPath == "-" || request.inputType != serin::Type::UNKOWN ||
+                !knownExtension(request.inputPath)) {
+                std::string text;
+                readBlocks(request.inputPath, [&](std::string_view block) { text += block; });
+                result = serin::validate(text, request.inputType == serin::Type::UNKOWN
+                                                   ? sniffedType(request.inputPath, text)
+                                                   : request.inputType);
+            } else {
+                result = serin::validateFile(request.inputPath);
+            }
+            if (!result) {
+                return fail(request.inputPath + ":" + std::to_string(result.line) + ":" +
+                            std::to_string(result.column) + ": " + result.message);
+            }
+            return response;
+        }
+
+        const std::shared_ptr<const serin::Value> document = load(request.inputPath, request.inputType);
+        const serin::Value *value = document.get();
+        serin::Value selected;
+        if (!request.query.empty()) {
+            const serin::Path path(request.query);
+            const auto matches = path.evaluate(*document);
+            if (path.isSingular()) {
+                if (matches.empty()) {
+                    return fail("No value matches query: " + request.query);
+                }
+                selected = serin::Value(*matches.front());
+            } else {
+                serin::Array items;
+                items.reserve(matches.size());
+                for (const serin::Value *match : matches) {
+                    items.push_back(*match);
+                }
+                selected = serin::Value(std::move(items));
+            }
+            value = &selected;
+        }
+
+        if (request.splitRows > 0 || request.splitBytes > 0) {
+            serin::ShardOptions options;
+            options.rows = request.splitRows;
+            options.bytes = request.splitBytes;
+            options.indent = request.indent;
+            serin::dumpShards(*value, request.outputPaths.front(), options);
+            return response;
+        }
+        if (!request.outputPaths.empty()) {
+            // Dump to files using auto-detection, formatting them in parallel
+            std::vector<serin::DumpTarget> targets;
+            for (const std::string &outputPath : request.outputPaths) {
+                targets.push_back({outputPath, serin::Type::UNKOWN, request.indent});
+            }
+            serin::dumpAll(*value, targets);
+            return response;
+        }
+        // Determine output format for stdout
+        serin::Type type = serin::Type::TOON; // default
+        if (!request.outputType.empty()) {
+            type = serin::stringToType(request.outputType);
+            if (type == serin::Type::UNKOWN) {
+                return fail("Unknown output type: " + request.outputType + "\nSupported formats: " +
+                            availableFormats());
+            }
+        }
+        response.out = encoder.dumps(*value, type, request.indent);
+        response.hasOutput = true;
+        response.binary = type == serin::Type::SERIN_BIN;
+    } catch (const std::exception &error) {
+        return fail(std::string("Failed to process: ") + error.what());
+    }
+    return response;
+}
+
+int printResponse(const Response &response) {
+    std::cerr << response.err << std::flush;
+    if (response.hasOutput) {
+        try {
+            writeStdout(response.out, !response.binary);
+        } catch (const std::exception &error) {
+            std::cerr << error.what() << std::endl;
+            return 1;
+        }
+    }
+    return response.status;
+}
+
+#ifdef SERIN_UNIX_SOCKETS
+
+// Frames on the socket: a 4-byte little-endian length, then the fields, each
+// a length-prefixed string. Requests start with a protocol tag so a client
+// and a server of different versions refuse each other cleanly.
+constexpr std::string_view PROTOCOL = "serin-serve/2";
+
+// How long the server waits for a client to send or take a frame before it
+// drops the connection, so an idle client cannot hold a worker.
+constexpr timeval CLIENT_TIMEOUT = {5, 0};
+
+// How long a client waits for the server to start or continue a reply. The
+// first byte comes after the whole request has run, so this is generous.
+constexpr timeval SERVER_TIMEOUT = {60, 0};
+
+// Largest request the server reads. Requests carry only paths and options;
+// a bigger length prefix is malformed and closes the connection unread.
+constexpr size_t MAX_REQUEST_SIZE = 4 << 20;
+
+// Formats travel by name, not by enum value, so adding a format cannot
+// change the meaning of an older peer's request. Empty means UNKOWN.
+std::string_view typeName(serin::Type type) {
+    switch (type) {
+        case serin::Type::JSON:
+            return "json";
+        case serin::Type::TOON:
+            return "toon";
+        case serin::Type::YAML:
+            return "yaml";
+        case serin::Type::SERIN_BIN:
+            return "serinb";
+        default:
+            return "";
+    }
+}
+
+void putField(std::string &frame, std::string_view field) {
+    const uint32_t size = static_cast<uint32_t>(field.size());
+    for (int i = 0; i < 4; ++i) {
+        frame += static_cast<char>((size >> (8 * i)) & 0xFF);
+    }
+    frame += field;
+}
+
+class FieldReader {
+public:
+    explicit FieldReader(std::string_view frame) : frame_(frame) {}
+
+    std::string next() {
+        if (frame_.size() < 4) {
+            throw std::runtime_error("Truncated message");
+        }
+        uint32_t size = 0;
+        for (int i = 3; i >= 0; --i) {
+            size = (size << 8) | static_cast<unsigned char>(frame_[i]);
+        }
+        frame_.remove_prefix(4);
+        if (frame_.size() < size) {
+            throw std::runtime_error("Truncated message");
+        }
+        std::string field(frame_.substr(0, size));
+        frame_.remove_prefix(size);
+        return field;
+    }
+
+    int number() { return std::stoi(next()); }
+
+private:
+    std::string_view frame_;
+};
+
+bool sendAll(int fd, std::string_view data) {
+    while (!data.empty()) {
+        const ssize_t sent = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return false;
+        }
+        data.remove_prefix(static_cast<size_t>(sent));
+    }
+    return true;
+}
+
+bool receiveAll(int fd, char *data, size_t size) {
+    while (size > 0) {
+        const ssize_t received = ::recv(fd, data, size, 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            return false;
+        }
+        data += received;
+        size -= static_cast<size_t>(received);
+    }
+    return true;
+}
+
+bool sendFrame(int fd, const std::string &body) {
+    std::string frame;
+    putField(frame, body);
+    return sendAll(fd, frame);
+}
+
+// A frame of at most `maxSize` bytes, or nothing if the peer closed, timed
+// out or announced a larger one.
+std::optional<std::string> receiveFrame(int fd, size_t maxSize = SIZE_MAX) {
+    unsigned char header[4];
+    if (!receiveAll(fd, reinterpret_cast<char *>(header), sizeof(header))) {
+        return std::nullopt;
+    }
+    const uint32_t size = header[0] | header[1] << 8 | header[2] << 16 | static_cast<uint32_t>(header[3]) << 24;
+    if (size > maxSize) {
+        return std::nullopt;
+    }
+    std::string body(size, '\0');
+    if (!receiveAll(fd, body.data(), size)) {
+        return std::nullopt;
+    }
+    return body;
+}
+
+sockaddr_un socketAddress(const std::string &socketPath) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path too long: " + socketPath);
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+    return address;
+}
+
+// A connected socket, or -1.
+int connectTo(const std::string &socketPath) {
+    const sockaddr_un address = socketAddress(socketPath);
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (::connect(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Sends `request` to a server. Returns nothing when no server answers, so
+// the caller can run the request itself; a server that takes the request but
+// stops replying is reported as an error instead.
+std::optional<Response> forward(const std::string &socketPath, const Request &request) {
+    const int fd = connectTo(socketPath);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &SERVER_TIMEOUT, sizeof(SERVER_TIMEOUT));
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &SERVER_TIMEOUT, sizeof(SERVER_TIMEOUT));
+    std::string body;
+    putField(body, PROTOCOL);
+    putField(body, request.inputPath);
+    putField(body, typeName(request.inputType));
+    putField(body, std::to_string(request.outputPaths.size()));
+    for (const std::string &outputPath : request.outputPaths) {
+        putField(body, outputPath);
+    }
+    putField(body, request.outputType);
+    putField(body, request.query);
+    putField(body, std::to_string(request.indent));
+    putField(body, request.check ? "1" : "0");
+    putField(body, std::to_string(request.splitRows));
+    putField(body, std::to_string(request.splitBytes));
+
+    std::optional<std::string> reply;
+    bool timedOut = false;
+    errno = 0;
+    if (sendFrame(fd, body)) {
+        reply = receiveFrame(fd);
+    }
+    if (!reply) {
+        timedOut = errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    ::close(fd);
+    if (timedOut) {
+        Response response;
+        response.status = 1;
+        response.err = "Failed to process: the server on " + socketPath + " did not respond within " +
+                       std::to_string(SERVER_TIMEOUT.tv_sec) + " s\n";
+        return response;
+    }
+    if (!reply) {
+        return std::nullopt;
+    }
+    FieldReader reader(*reply);
+    Response response;
+    response.status = reader.number();
+    const std::string output = reader.next();
+    response.hasOutput = output != "0";
+    response.binary = output == "2";
+    response.out = reader.next();
+    response.err = reader.next();
+    return response;
+}
+
+volatile std::sig_atomic_t stopServing = 0;
+
+extern "C" void onStopSignal(int) {
+    stopServing = 1;
+}
+
+// Serves requests on a Unix domain socket until SIGINT or SIGTERM. The main
+// thread accepts connections and queues them; each worker keeps its own
+// Encoder warm across requests, and parsed documents are shared through a
+// DocumentCache, which keeps a parsing context per thread.
+int serve(const std::string &socketPath, size_t threads, size_t cacheEntries) {
+    if (const int existing = connectTo(socketPath); existing >= 0) {
+        ::close(existing);
+        throw std::runtime_error("A server is already listening on " + socketPath);
+    }
+    // A stale socket from an earlier server is replaced; anything else at
+    // the path is left alone.
+    std::error_code error;
+    const fs::file_status status = fs::symlink_status(socketPath, error);
+    if (fs::exists(status)) {
+        if (!fs::is_socket(status)) {
+            throw std::runtime_error("Refusing to replace " + socketPath + ": not a socket");
+        }
+        ::unlink(socketPath.c_str());
+    }
+    const sockaddr_un address = socketAddress(socketPath);
+    const int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    // Requests read and write files with the server's rights, so only its
+    // owner may connect. The socket is created 0600 rather than chmod-ed
+    // afterwards, leaving no window where others can connect.
+    const mode_t previousMask = ::umask(077);
+    const bool bound =
+        listener >= 0 && ::bind(listener, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == 0;
+    const int bindErrno = errno;
+    ::umask(previousMask);
+    errno = bindErrno;
+    if (!bound || ::listen(listener, 128) != 0) {
+        const std::string reason = std::strerror(errno);
+        if (listener >= 0) {
+            ::close(listener);
+        }
+        throw std::runtime_error("Cannot listen on " + socketPath + ": " + reason);
+    }
+
+    std::signal(SIGINT, onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    serin::DocumentCache::Limits limits;
+    limits.maxEntries = cacheEntries;
+    serin::DocumentCache cache(limits);
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<int> connections;
+    std::unordered_set<int> active; // connections a worker is handling
+    bool stopping = false;
+
+    auto handle = [&](int fd, serin::Encoder &encoder) {
+        Response response;
+        try {
+            const std::optional<std::string> body = receiveFrame(fd, MAX_REQUEST_SIZE);
+            if (!body) {
+                return;
+            }
+            FieldReader reader(*body);
+            if (reader.next() != PROTOCOL) {
+                throw std::runtime_error("Unsupported protocol; is the client the same serin version?");
+            }
+            Request request;
+            request.inputPath = reader.next();
+            const std::string inputType = reader.next();
+            request.inputType = inputType.empty() ? serin::Type::UNKOWN : serin::stringToType(inputType);
+            if (!inputType.empty() && request.inputType == serin::Type::UNKOWN) {
+                throw std::runtime_error("Unknown input type: " + inputType);
+            }
+            for (int count = reader.number(); count > 0; --count) {
+                request.outputPaths.push_back(reader.next());
+            }
+            request.outputType = reader.next();
+            request.query = reader.next();
+            request.indent = reader.number();
+            request.check = reader.next() == "1";
+            request.splitRows = std::stoull(reader.next());
+            request.splitBytes = std::stoull(reader.next());
+            // Files whose format has to be sniffed bypass the cache
+            const DocumentLoader load = [&](const std::string &path, serin::Type type) {
+                if (cacheEntries > 0 && (type != serin::Type::UNKOWN || knownExtension(path))) {
+                    return cache.load(path, type);
+                }
+                return loadLocal(path, type);
+            };
+            response = runRequest(request, load, encoder);
+        } catch (const std::exception &error) {
+            response.status = 1;
+            response.err = std::string("Failed to process: ") + error.what() + "\n";
+        }
+        std::string reply;
+        putField(reply, std::to_string(response.status));
+        putField(reply, !response.hasOutput ? "0" : response.binary ? "2" : "1");
+        putField(reply, response.out);
+        putField(reply, response.err);
+        sendFrame(fd, reply);
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < std::max<size_t>(threads ? threads : std::thread::hardware_concurrency(), 1); ++i) {
+        workers.emplace_back([&] {
+            serin::Encoder encoder;
+            for (;;) {
+                int fd;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    ready.wait(lock, [&] { return stopping || !connections.empty(); });
+                    if (connections.empty()) {
+                        return;
+                    }
+                    fd = connections.front();
+                    connections.pop_front();
+                    // Clients still queued at shutdown find the connection
+                    // closed and run their request themselves.
+                    if (stopping) {
+                        ::close(fd);
+                        continue;
+                    }
+                    active.insert(fd);
+                }
+                handle(fd, encoder);
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    active.erase(fd);
+                }
+                ::close(fd);
+            }
+        });
+    }
+
+    std::cerr << "serin " << serinVersion << " serving on " << socketPath << " with " << workers.size()
+              << " workers" << std::endl;
+    while (!stopServing) {
+        pollfd waiting{listener, POLLIN, 0};
+        if (::poll(&waiting, 1, 200) <= 0) {
+            continue;
+        }
+        const int fd = ::accept(listener, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &CLIENT_TIMEOUT, sizeof(CLIENT_TIMEOUT));
+        ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &CLIENT_TIMEOUT, sizeof(CLIENT_TIMEOUT));
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            connections.push_back(fd);
+        }
+        ready.notify_one();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        // Wakes workers blocked reading a request; replies still go out.
+        for (const int fd : active) {
+            ::shutdown(fd, SHUT_RD);
+        }
+    }
+    ready.notify_all();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    ::close(listener);
+    ::unlink(socketPath.c_str());
+    return 0;
+}
+
+#endif
+
+// Prints the requested reports when the command finishes, whichever way it returns.
+struct RunReport {
+    bool memory = false;
+    bool profile = false;
+    std::string tracePath;
+    serin::TraceRecorder recorder;
+    std::chrono::steady_clock::time_point start;
+
+    void begin() {
+        if (memory) {
+            serin::enableMemoryStats();
+        }
+        if (profile || !tracePath.empty()) {
+            recorder.start();
+        }
+        start = std::chrono::steady_clock::now();
+    }
+
+    ~RunReport() {
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        recorder.stop();
+        if (memory) {
+            printMemoryStats(serin::memoryStats());
+        }
+        if (profile) {
+            printProfile(recorder, elapsed);
+        }
+        if (!tracePath.empty()) {
+            try {
+                recorder.writeChromeTrace(tracePath);
+            } catch (const std::exception &error) {
+                std::cerr << "Failed to write trace: " << error.what() << std::endl;
+            }
+        }
+    }
+};
+
 } // namespace
 
 int main(int argc, char **argv) {
+    static char stdoutBuffer[1 << 20];
+    std::setvbuf(stdout, stdoutBuffer, _IOFBF, sizeof(stdoutBuffer));
+
     CLI::App app{"Serin - A modern C++ serialization library and CLI tool\n"
                  "Version: " + serinVersion + "\n"
                  "\n"
@@ -36,20 +954,115 @@ int main(int argc, char **argv) {
                  "Examples:\n"
                  "$  serin input.json -o output.yaml          # Convert JSON to YAML\n"
                  "$  serin input.yaml -t json                 # Convert YAML to JSON (stdout)\n"
-                 "$  serin input.toon -o output.json -i 4     # Convert Toon to JSON with 4-space indent"};
+                 "$  serin input.toon -o output.json -i 4     # Convert Toon to JSON with 4-space indent\n"
+                 "$  serin data.yaml -o d.json -o d.toon      # Parse once, write several formats in parallel\n"
+                 "$  serin input.json -q '/statuses/*/id'     # Extract fields with a JSON Pointer or JSONPath query\n"
+                 "$  serin rows.toon --select id,name --where 'age >= 30'   # Filter a TOON table as it streams\n"
+                 "$  serin big.json -o big.ndjson --stream   # Convert entry by entry without loading the whole file\n"
+                 "$  serin big.json -o part.toon --split-rows 100000   # part-00000.toon, part-00001.toon, ...\n"
+                 "$  serin config.yaml --check               # Validate without loading\n"
+                 "$  curl -s api/users | serin - -t yaml      # Read stdin; the format is sniffed (or use -f json)\n"
+                 "$  serin big.json -o big.toon --stats       # Report allocations and peak memory per phase\n"
+                 "$  serin big.json -o big.yaml --profile     # Report time per phase (--trace t.json for Chrome)\n"
+                 "$  serin stats data.json                   # Profile node counts, depth, keys and output sizes\n"
+                 "$  serin generate --shape table --size 1GB -o rows.toon   # Write a synthetic corpus\n"
+                 "$  serin convert configs/ --to toon --out out/ -j 8       # Convert a directory tree in parallel"};
 
     std::string inputPath;
-    std::string outputPath;
+    std::string inputType;
+    std::vector<std::string> outputPaths;
     std::string outputType;
+    std::string query;
+    std::string table;
+    std::string selectColumns;
+    std::vector<std::string> predicates;
+    size_t splitRows = 0;
+    std::string splitBytes;
     int indent = 2;
+    bool stream = false;
+    bool check = false;
     bool showVersion = false;
+    RunReport report;
 
     app.set_help_flag("-h,--help", "Show this help message and exit");
-    app.add_option("input", inputPath, "Path to the input document (required)");
-    app.add_option("-o,--output", outputPath, "Path to the output document (if omitted, prints to stdout)");
+    app.add_option("input", inputPath, "Path to the input document, or - for stdin (required)");
+    app.add_option("-f,--from", inputType,
+                   "Input format: " + availableFormats() + " (default: file extension, else sniffed from the content)");
+    app.add_option("-o,--output", outputPaths,
+                   "Path to the output document (if omitted or -, prints to stdout); repeat to write several "
+                   "formats from one parse")
+        ->allow_extra_args(false);
     app.add_option("-t,--type", outputType, "Output format: " + availableFormats() + " (default: toon)");
     app.add_option("-i,--indent", indent, "Indent level for structured output (default: 2)");
+    app.add_option("-q,--query", query, "Only output the values selected by a JSON Pointer or JSONPath expression");
+    app.add_option("--table", table, "Name of the TOON table to stream with --select/--where (default: first table)");
+    app.add_option("--select", selectColumns, "Comma-separated columns to keep from a TOON table");
+    app.add_option("--where", predicates, "Row filter for a TOON table, e.g. \"age >= 30\" (repeatable)");
+    app.add_option("--split-rows", splitRows, "Write the array as numbered shards of N items next to -o");
+    app.add_option("--split-bytes", splitBytes, "Write the array as numbered shards of about SIZE each, e.g. 64MB");
+    app.add_flag("--stream", stream,
+                 "Convert one top-level entry at a time to bound memory (also accepts -t ndjson)");
+    app.add_flag("--check", check,
+                 "Only check that the input is well-formed; report the first error (stricter than "
+                 "loading, which skips some malformed lines)");
+    app.add_flag("--stats", report.memory, "Print allocations and peak memory per phase to stderr");
+    app.add_flag("--profile", report.profile, "Print the time spent in each phase to stderr");
+    app.add_option("--trace", report.tracePath, "Write the phase timings to a Chrome trace file");
     app.add_flag("--version", showVersion, "Show version information and exit");
+    std::string connectPath;
+    app.add_option("--connect", connectPath,
+                   "Send the conversion to a `serin serve` socket; runs locally if none answers")
+        ->envname("SERIN_SOCKET");
+
+    std::string statsPath;
+    size_t topKeys = 10;
+    CLI::App *statsCommand = app.add_subcommand("stats", "Print a profile of a document without converting it");
+    statsCommand->fallthrough();
+    statsCommand->add_option("file", statsPath, "Path to the document")->required();
+    statsCommand->add_option("--top", topKeys, "Number of most frequent keys to list (default: 10)");
+
+    std::string generatePath;
+    std::string generateType = "json";
+    std::string shape = "mixed";
+    std::string size = "1MB";
+    int generateIndent = 2;
+    serin::GeneratorOptions generatorOptions;
+    CLI::App *generateCommand = app.add_subcommand("generate", "Write a deterministic synthetic document");
+    generateCommand->fallthrough();
+    generateCommand->add_option("--shape", shape, "table, wide, deep, strings, numeric or mixed (default: mixed)");
+    generateCommand->add_option("--size", size, "Approximate JSON size, e.g. 64KB, 10MB, 2GB (default: 1MB)");
+    generateCommand->add_option("--seed", generatorOptions.seed, "Random seed (default: 1)");
+    generateCommand->add_option("--depth", generatorOptions.depth, "Nesting of the deep shape (default: 32)");
+    generateCommand->add_option("-o,--output", generatePath, "Output file; the extension picks the format");
+    generateCommand->add_option("-t,--type", generateType, "Format for stdout: " + availableFormats() + ", ndjson (default: json)");
+    generateCommand->add_option("-i,--indent", generateIndent, "Indent level (default: 2)");
+
+    std::vector<std::string> convertInputs;
+    std::string convertTo;
+    std::string convertOut;
+    int convertIndent = 2;
+    bool noCache = false;
+    serin::BatchOptions batchOptions;
+    CLI::App *convertCommand =
+        app.add_subcommand("convert", "Convert files and directory trees in parallel, keeping relative paths");
+    convertCommand->fallthrough();
+    convertCommand->add_option("inputs", convertInputs, "Files or directories to convert")->required();
+    convertCommand->add_option("--to", convertTo, "Output format: " + availableFormats())->required();
+    convertCommand->add_option("--out", convertOut, "Output directory")->required();
+    convertCommand->add_option("-j,--jobs", batchOptions.threads, "Worker threads (default: one per core)");
+    convertCommand->add_option("-i,--indent", convertIndent, "Indent level (default: 2)");
+    convertCommand->add_option("--manifest", batchOptions.manifest,
+                               "Manifest of earlier conversions (default: <out>/.serin-manifest)");
+    convertCommand->add_flag("--no-cache", noCache, "Convert every file, even those already up to date");
+
+    std::string socketPath;
+    size_t serveThreads = 0;
+    size_t cacheEntries = 64;
+    CLI::App *serveCommand =
+        app.add_subcommand("serve", "Serve conversions, validations and queries on a Unix domain socket");
+    serveCommand->add_option("--socket", socketPath, "Path of the socket to listen on")->required();
+    serveCommand->add_option("-j,--jobs", serveThreads, "Worker threads (default: one per core)");
+    serveCommand->add_option("--cache", cacheEntries, "Parsed documents to keep (default: 64, 0 disables)");
 
     if (argc == 1) {
         printHelp(app);
@@ -67,52 +1080,259 @@ int main(int argc, char **argv) {
         return 1;
     }
 
+    if (report.memory && !serin::memoryStatsAvailable()) {
+        std::cerr << "--stats is not supported on this platform" << std::endl;
+        report.memory = false;
+        return 1;
+    }
+    if ((report.profile || !report.tracePath.empty()) && !serin::tracingAvailable()) {
+        std::cerr << "--profile and --trace need a build with SERIN_TRACING" << std::endl;
+        report.profile = false;
+        report.tracePath.clear();
+        return 1;
+    }
+    report.begin();
+
     if (showVersion) {
         std::cout << "serin " << serinVersion << std::endl;
         return 0;
     }
 
+    if (statsCommand->parsed()) {
+        try {
+            printStats(statsPath, serin::statsFile(statsPath), topKeys);
+        } catch (const std::exception &error) {
+            std::cerr << "Failed to process: " << error.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (generateCommand->parsed()) {
+        serin::StreamOptions options;
+        options.indent = generateIndent;
+        if (generatePath.empty() && !setStreamType(generateType, options)) {
+            return 1;
+        }
+        try {
+            generatorOptions.shape = serin::stringToShape(shape);
+            generatorOptions.targetBytes = parseSize(size);
+            serin::generateFile(generatePath, generatorOptions, options);
+        } catch (const std::exception &error) {
+            std::cerr << "Failed to generate: " << error.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (serveCommand->parsed()) {
+#ifdef SERIN_UNIX_SOCKETS
+        try {
+            return serve(socketPath, serveThreads, cacheEntries);
+        } catch (const std::exception &error) {
+            std::cerr << "Failed to serve: " << error.what() << std::endl;
+            return 1;
+        }
+#else
+        std::cerr << "serve needs Unix domain sockets, which this platform lacks" << std::endl;
+        return 1;
+#endif
+    }
+
+    if (convertCommand->parsed()) {
+        const serin::Type type = serin::stringToType(convertTo);
+        if (type == serin::Type::UNKOWN) {
+            std::cerr << "Unknown output type: " << convertTo << std::endl;
+            std::cerr << "Supported formats: " << availableFormats() << std::endl;
+            return 1;
+        }
+        batchOptions.indent = convertIndent;
+        if (noCache) {
+            batchOptions.manifest.clear();
+        } else if (batchOptions.manifest.empty()) {
+            batchOptions.manifest = (fs::path(convertOut) / ".serin-manifest").string();
+        }
+        try {
+            const auto start = std::chrono::steady_clock::now();
+            std::string extension = convertTo;
+            std::transform(extension.begin(), extension.end(), extension.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            const auto pairs = collectConversions(convertInputs, convertOut, "." + extension);
+            fs::create_directories(convertOut);
+            for (const auto &pair : pairs) {
+                fs::create_directories(fs::path(pair.second).parent_path());
+            }
+            const auto results = serin::convertMany(pairs, type, batchOptions);
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            size_t converted = 0;
+            size_t skipped = 0;
+            size_t inputBytes = 0;
+            size_t outputBytes = 0;
+            for (const auto &result : results) {
+                if (!result.ok()) {
+                    std::cerr << result.input << ": " << result.error << std::endl;
+                    continue;
+                }
+                ++(result.skipped ? skipped : converted);
+                inputBytes += result.inputBytes;
+                outputBytes += result.outputBytes;
+            }
+            std::cerr << std::fixed << std::setprecision(2) << "Converted " << converted << " of " << results.size()
+                      << " files";
+            if (skipped > 0) {
+                std::cerr << ", " << skipped << " up to date";
+            }
+            std::cerr << " (" << formatBytes(inputBytes) << " -> " << formatBytes(outputBytes) << ") in " << seconds
+                      << " s";
+            if (seconds > 0) {
+                std::cerr << std::setprecision(1) << ": " << results.size() / seconds << " files/s, "
+                          << inputBytes / seconds / 1e6 << " MB/s";
+            }
+            std::cerr << std::endl;
+            return converted + skipped == results.size() ? 0 : 1;
+        } catch (const std::exception &error) {
+            std::cerr << "Failed to convert: " << error.what() << std::endl;
+            return 1;
+        }
+    }
+
     if (inputPath.empty()) {
         printHelp(app);
         return 0;
     }
 
+    if (outputPaths.size() == 1 && outputPaths[0] == "-") {
+        outputPaths.clear();
+    }
+    if (outputPaths.size() > 1 && std::find(outputPaths.begin(), outputPaths.end(), "-") != outputPaths.end()) {
+        std::cerr << "stdout (-) cannot be one of several outputs" << std::endl;
+        return 1;
+    }
+    // --stream and the table filters write a single output
+    const std::string outputPath = outputPaths.empty() ? std::string() : outputPaths.front();
+    const bool standardInput = inputPath == "-";
+    const serin::Type fromType = inputType.empty() ? serin::Type::UNKOWN : serin::stringToType(inputType);
+    if (!inputType.empty() && fromType == serin::Type::UNKOWN) {
+        std::cerr << "Unknown input type: " << inputType << std::endl;
+        std::cerr << "Supported formats: " << availableFormats() << std::endl;
+        return 1;
+    }
+
     if (indent < 0) {
         std::cerr << "Indent level must be non-negative" << std::endl;
         return 1;
     }
 
-    if (!fs::exists(inputPath)) {
+    if (!standardInput && !fs::exists(inputPath)) {
         std::cerr << "Input file not found: " << inputPath << std::endl;
         return 1;
     }
 
+    Request request;
+    request.inputPath = inputPath;
+    request.inputType = fromType;
+    request.outputPaths = outputPaths;
+    request.outputType = outputType;
+    request.query = query;
+    request.indent = indent;
+    request.check = check;
+    request.splitRows = splitRows;
     try {
-        // Load the file using auto-detection
-        serin::Value value = serin::load(inputPath);
+        request.splitBytes = splitBytes.empty() ? 0 : parseSize(splitBytes);
+    } catch (const std::exception &error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+    if ((request.splitRows > 0 || request.splitBytes > 0) &&
+        (outputPaths.size() != 1 || stream || !table.empty() || !selectColumns.empty() || !predicates.empty())) {
+        std::cerr << "--split-rows and --split-bytes need one -o file and no --stream or table filters" << std::endl;
+        return 1;
+    }
+    serin::Encoder encoder;
 
-        if (!outputPath.empty()) {
-            // Dump to file using auto-detection
-            serin::dump(value, outputPath);
-        } else {
-            // Determine output format for stdout
-            serin::Type type = serin::Type::TOON; // default
-            if (!outputType.empty()) {
-                serin::Type requested = serin::stringToType(outputType);
-                if (requested == serin::Type::UNKOWN) {
-                    std::cerr << "Unknown output type: " << outputType << std::endl;
-                    std::cerr << "Supported formats: " << availableFormats() << std::endl;
-                    return 1;
-                }
-                type = requested;
+#ifdef SERIN_UNIX_SOCKETS
+    // Forward what the server can do on its own: no stdin, streaming, table
+    // filters or local reports
+    if (!connectPath.empty() && !standardInput && (check || (!stream && table.empty() && selectColumns.empty() &&
+                                                            predicates.empty())) &&
+        !report.memory && !report.profile && report.tracePath.empty()) {
+        Request remote = request;
+        remote.inputPath = fs::absolute(inputPath).string();
+        for (std::string &path : remote.outputPaths) {
+            path = fs::absolute(path).string();
+        }
+        if (const std::optional<Response> response = forward(connectPath, remote)) {
+            return printResponse(*response);
+        }
+    }
+#endif
+
+    if (check) {
+        return printResponse(runRequest(request, loadLocal, encoder));
+    }
+
+    if (stream) {
+        if (!query.empty() || !table.empty() || !selectColumns.empty() || !predicates.empty()) {
+            std::cerr << "--stream cannot be combined with --query, --table, --select or --where" << std::endl;
+            return 1;
+        }
+        if (standardInput || fromType != serin::Type::UNKOWN) {
+            std::cerr << "--stream needs an input file and takes its format from the extension" << std::endl;
+            return 1;
+        }
+        if (outputPaths.size() > 1) {
+            std::cerr << "--stream writes a single output" << std::endl;
+            return 1;
+        }
+        serin::StreamOptions options;
+        options.indent = indent;
+        if (outputPath.empty() && !outputType.empty() && !setStreamType(outputType, options)) {
+            return 1;
+        }
+        try {
+            serin::convertStream(inputPath, outputPath, options);
+        } catch (const std::exception &error) {
+            std::cerr << "Failed to process: " << error.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (!table.empty() || !selectColumns.empty() || !predicates.empty()) {
+        if (!query.empty()) {
+            std::cerr << "--query cannot be combined with --table, --select or --where" << std::endl;
+            return 1;
+        }
+        if (standardInput) {
+            std::cerr << "--table, --select and --where need an input file" << std::endl;
+            return 1;
+        }
+        if (outputPaths.size() > 1) {
+            std::cerr << "--table, --select and --where write a single output" << std::endl;
+            return 1;
+        }
+        const serin::Type type = outputTypeFor(outputPath, outputType);
+        if (type == serin::Type::UNKOWN) {
+            std::cerr << "Unknown output type: " << (outputPath.empty() ? outputType : outputPath) << std::endl;
+            std::cerr << "Supported formats: " << availableFormats() << std::endl;
+            return 1;
+        }
+        try {
+            serin::ToonTableReader reader(inputPath, table);
+            if (!selectColumns.empty()) {
+                reader.select(splitList(selectColumns));
+            }
+            for (const std::string &predicate : predicates) {
+                reader.where(predicate);
             }
-            // Dump to stdout with specified format and indent
-            std::cout << serin::dumps(value, type, indent) << std::endl;
+            filterTable(reader, type, indent, outputPath);
+        } catch (const std::exception &error) {
+            std::cerr << "Failed to process: " << error.what() << std::endl;
+            return 1;
         }
-    } catch (const std::exception &error) {
-        std::cerr << "Failed to process: " << error.what() << std::endl;
-        return 1;
+        return 0;
     }
 
-    return 0;
+    return printResponse(runRequest(request, loadLocal, encoder));
 }
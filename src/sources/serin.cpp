@@ -1,12 +1,16 @@
 #include "serin.h"
+#include "serin_internal.h"
 #include "yyjson.h"
 #include "utils.h"
 
 
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
-#include <sstream>
 #include <stdexcept>
 
 namespace serin {
@@ -69,46 +73,80 @@ double Primitive::getNumber() const {
     }
 }
 
-// Primitive conversion to string
-std::string Primitive::asString() const {
-    return std::visit([](const auto& value) -> std::string {
+// Formats a non-string primitive into `buffer`, which must hold at least
+// Primitive::MAX_SCALAR_LENGTH bytes, and returns the end of the written text.
+static char* formatScalar(const Primitive& primitive, char* buffer) {
+    char* const limit = buffer + Primitive::MAX_SCALAR_LENGTH;
+    return std::visit([&](const auto& value) -> char* {
         using T = std::decay_t<decltype(value)>;
         if constexpr (std::is_same_v<T, std::nullptr_t>) {
-            return "null";
+            std::memcpy(buffer, "null", 4);
+            return buffer + 4;
         } else if constexpr (std::is_same_v<T, bool>) {
-            return value ? "true" : "false";
-        } else if constexpr (std::is_same_v<T, double>) {
-            // Use yyjson for double serialization
-            char buffer[64];
-            yyjson_val val;
-            unsafe_yyjson_set_real(&val, value);
-            char *result = yyjson_write_number(&val, buffer);
-            if (result) {
-                return std::string(buffer, result - buffer);
+            if (value) {
+                std::memcpy(buffer, "true", 4);
+                return buffer + 4;
             }
-            // Fallback to stringstream if yyjson fails
-            std::ostringstream oss;
-            oss << value;
-            return oss.str();
+            std::memcpy(buffer, "false", 5);
+            return buffer + 5;
         } else if constexpr (std::is_same_v<T, int64_t>) {
-            // Use yyjson for int64_t serialization
-            char buffer[32];
+            return std::to_chars(buffer, limit, value).ptr;
+        } else if constexpr (std::is_same_v<T, double>) {
+            // Use yyjson for double serialization so output matches dumpsJson
             yyjson_val val;
-            unsafe_yyjson_set_sint(&val, value);
-            char *result = yyjson_write_number(&val, buffer);
-            if (result) {
-                return std::string(buffer, result - buffer);
+            unsafe_yyjson_set_real(&val, value);
+            if (char* result = yyjson_write_number(&val, buffer)) {
+                return result;
             }
-            // Fallback to stringstream if yyjson fails
-            std::ostringstream oss;
-            oss << value;
-            return oss.str();
-        } else { // std::string
-            return value;
+            return std::to_chars(buffer, limit, value).ptr;
+        } else {
+            return buffer;
+        }
+    }, static_cast<const Primitive::Base&>(primitive));
+}
+
+// Primitive conversion to string
+std::string Primitive::asString() const {
+    if (isString()) {
+        return std::get<std::string>(*this);
+    }
+    char buffer[MAX_SCALAR_LENGTH];
+    return std::string(buffer, formatScalar(*this, buffer));
+}
+
+void Primitive::appendTo(std::string& out) const {
+    if (isString()) {
+        out += std::get<std::string>(*this);
+        return;
+    }
+    char buffer[MAX_SCALAR_LENGTH];
+    out.append(buffer, formatScalar(*this, buffer));
+}
+
+size_t Primitive::writeTo(char* buffer, size_t size) const {
+    if (isString()) {
+        const std::string& text = std::get<std::string>(*this);
+        if (text.size() <= size) {
+            std::memcpy(buffer, text.data(), text.size());
         }
-    }, *this);
+        return text.size();
+    }
+    if (size >= MAX_SCALAR_LENGTH) {
+        return static_cast<size_t>(formatScalar(*this, buffer) - buffer);
+    }
+    char scratch[MAX_SCALAR_LENGTH];
+    const size_t length = static_cast<size_t>(formatScalar(*this, scratch) - scratch);
+    if (length <= size) {
+        std::memcpy(buffer, scratch, length);
+    }
+    return length;
 }
 
+static std::atomic<size_t> maxDepthSetting{DEFAULT_MAX_DEPTH};
+
+void setMaxDepth(size_t depth) { maxDepthSetting.store(depth, std::memory_order_relaxed); }
+size_t getMaxDepth() { return maxDepthSetting.load(std::memory_order_relaxed); }
+
 bool isPrimitive(const Value& value) { return value.isPrimitive(); }
 bool isObject(const Value& value) { return value.isObject(); }
 bool isArray(const Value& value) { return value.isArray(); }
@@ -125,11 +163,133 @@ Type stringToType(const std::string &name) {
     if (lowered == "yaml" || lowered == "yml") {
         return serin::Type::YAML;
     }
+    if (lowered == "serinb" || lowered == "serin_bin") {
+        return serin::Type::SERIN_BIN;
+    }
     return serin::Type::UNKOWN;
 }
 
-// Generic file format functions (auto-detect format from file extension)
-Value load(const std::string& filename) {
+namespace {
+
+bool isSniffSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Whether `text` at `pos` is a TOON array header: `[N]`, with an optional
+// `#` length marker and delimiter, then an optional `{fields}`, then `:`.
+bool isToonHeader(std::string_view text, size_t pos) {
+    if (pos >= text.size() || text[pos] != '[') {
+        return false;
+    }
+    ++pos;
+    if (pos < text.size() && text[pos] == '#') {
+        ++pos;
+    }
+    const size_t digits = pos;
+    while (pos < text.size() && std::isdigit(static_cast<unsigned char>(text[pos]))) {
+        ++pos;
+    }
+    if (pos == digits) {
+        return false;
+    }
+    if (pos < text.size() && (text[pos] == '\t' || text[pos] == '|')) {
+        ++pos;
+    }
+    if (pos >= text.size() || text[pos++] != ']') {
+        return false;
+    }
+    if (pos < text.size() && text[pos] == '{') {
+        pos = text.find('}', pos);
+        if (pos == std::string_view::npos) {
+            return false;
+        }
+        ++pos;
+    }
+    return pos < text.size() && text[pos] == ':';
+}
+
+// Whether a line (without indentation) starts with a key followed by a TOON
+// array header, e.g. `items[2]{id,name}:` or `"a b"[3]: x,y,z`.
+bool hasToonKey(std::string_view line) {
+    size_t pos = 0;
+    if (!line.empty() && line[0] == '"') {
+        pos = 1;
+        while (pos < line.size() && line[pos] != '"') {
+            pos += line[pos] == '\\' ? 2 : 1;
+        }
+        ++pos;
+    } else if (!line.empty() && line[0] == '-' && line.size() > 1 && line[1] == ' ') {
+        // List item of a TOON list array: `- key[N]: ...`
+        return hasToonKey(line.substr(2));
+    } else {
+        while (pos < line.size() && line[pos] != '[' && line[pos] != ':' && !isSniffSpace(line[pos])) {
+            ++pos;
+        }
+    }
+    return isToonHeader(line, pos);
+}
+
+} // namespace
+
+Type sniff(std::string_view head) {
+    if (detail::isBinary(head)) {
+        return Type::SERIN_BIN;
+    }
+    if (head.substr(0, 3) == "\xEF\xBB\xBF") {
+        head.remove_prefix(3);
+    }
+    size_t start = 0;
+    while (start < head.size() && isSniffSpace(head[start])) {
+        ++start;
+    }
+    if (start == head.size()) {
+        return Type::UNKOWN;
+    }
+
+    const char first = head[start];
+    if (first == '[') {
+        return isToonHeader(head, start) ? Type::TOON : Type::JSON;
+    }
+    if (first == '{') {
+        return Type::JSON;
+    }
+    if (first == '"') {
+        // A quoted key is TOON or YAML; a lone string is JSON
+        size_t end = start + 1;
+        while (end < head.size() && head[end] != '"') {
+            end += head[end] == '\\' ? 2 : 1;
+        }
+        size_t next = end + 1;
+        while (next < head.size() && (head[next] == ' ' || head[next] == '\t')) {
+            ++next;
+        }
+        if (next >= head.size() || (head[next] != ':' && head[next] != '[')) {
+            return Type::JSON;
+        }
+    }
+
+    // Key/value lines read the same in TOON and YAML; only an array header
+    // tells TOON apart. A partial last line can still hold one.
+    for (size_t pos = start; pos < head.size();) {
+        size_t end = head.find('\n', pos);
+        if (end == std::string_view::npos) {
+            end = head.size();
+        }
+        std::string_view line = head.substr(pos, end - pos);
+        while (!line.empty() && isSniffSpace(line.front())) {
+            line.remove_prefix(1);
+        }
+        if (hasToonKey(line)) {
+            return Type::TOON;
+        }
+        pos = end + 1;
+    }
+    return Type::YAML;
+}
+
+namespace detail {
+
+Type typeFromFilename(const std::string& filename) {
     // Extract file extension
     std::filesystem::path filePath(filename);
     std::string extension = filePath.extension().string();
@@ -137,37 +297,62 @@ Value load(const std::string& filename) {
     // Convert to lowercase for case-insensitive comparison
     std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
     
-    // Route to appropriate loader based on file extension
     if (extension == ".json") {
-        return loadJson(filename);
+        return Type::JSON;
     } else if (extension == ".toon") {
-        return loadToon(filename);
+        return Type::TOON;
     } else if (extension == ".yaml" || extension == ".yml") {
-        return loadYaml(filename);
-    } else {
-        throw std::runtime_error("Unsupported file format: " + extension + 
-                               ". Supported formats: .json, .toon, .yaml, .yml");
+        return Type::YAML;
+    } else if (extension == ".serinb") {
+        return Type::SERIN_BIN;
+    }
+    return Type::UNKOWN;
+}
+
+std::runtime_error unsupportedExtension(const std::string& filename) {
+    return std::runtime_error("Unsupported file format: " + std::filesystem::path(filename).extension().string() +
+                              ". Supported formats: .json, .toon, .yaml, .yml, .serinb");
+}
+
+} // namespace detail
+
+// Generic file format functions (auto-detect format from file extension)
+Value load(const std::string& filename) {
+    if (auto cache = detail::currentLoadCache()) {
+        return *cache->load(filename);
+    }
+    // Route to appropriate loader based on file extension
+    switch (detail::typeFromFilename(filename)) {
+        case Type::JSON:
+            return loadJson(filename);
+        case Type::TOON:
+            return loadToon(filename);
+        case Type::YAML:
+            return loadYaml(filename);
+        case Type::SERIN_BIN:
+            return loadBinary(filename);
+        default:
+            throw detail::unsupportedExtension(filename);
     }
 }
 
 void dump(const Value& value, const std::string& filename) {
-    // Extract file extension
-    std::filesystem::path filePath(filename);
-    std::string extension = filePath.extension().string();
-    
-    // Convert to lowercase for case-insensitive comparison
-    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
-    
     // Route to appropriate dumper based on file extension
-    if (extension == ".json") {
-        dumpJson(value, filename);
-    } else if (extension == ".toon") {
-        dumpToon(value, filename);
-    } else if (extension == ".yaml" || extension == ".yml") {
-        dumpYaml(value, filename);
-    } else {
-        throw std::runtime_error("Unsupported file format: " + extension + 
-                               ". Supported formats: .json, .toon, .yaml, .yml");
+    switch (detail::typeFromFilename(filename)) {
+        case Type::JSON:
+            dumpJson(value, filename);
+            break;
+        case Type::TOON:
+            dumpToon(value, filename);
+            break;
+        case Type::YAML:
+            dumpYaml(value, filename);
+            break;
+        case Type::SERIN_BIN:
+            dumpBinary(value, filename);
+            break;
+        default:
+            throw detail::unsupportedExtension(filename);
     }
 }
 
@@ -179,6 +364,8 @@ Value loads(const std::string& content, Type type) {
             return loadsToon(content);
         case Type::YAML:
             return loadsYaml(content);
+        case Type::SERIN_BIN:
+            return loadsBinary(content);
         default:
             throw std::runtime_error("Unsupported format type");
     }
@@ -192,6 +379,8 @@ std::string dumps(const Value& value, Type format, int indent) {
             return dumpsToon(value, EncoderOptions(indent));
         case Type::YAML:
             return dumpsYaml(value, indent);
+        case Type::SERIN_BIN:
+            return dumpsBinary(value);
         default:
             throw std::runtime_error("Unsupported format type");
     }
@@ -0,0 +1,563 @@
+#include "serin.h"
+#include "serin_internal.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#define STRINGIFY(x) #x
+#define MACRO_STRINGIFY(x) STRINGIFY(x)
+
+namespace serin {
+
+namespace {
+
+// Work-stealing queue of item indices. Each worker starts with a contiguous
+// block, takes from the back of its own deque and, once that is empty, steals
+// from the front of the others, so uneven file sizes even out.
+class StealingQueues {
+public:
+    StealingQueues(size_t items, size_t workers) : queues_(workers) {
+        const size_t block = (items + workers - 1) / workers;
+        for (size_t i = 0; i < items; ++i) {
+            queues_[i / block].tasks.push_back(i);
+        }
+    }
+
+    bool next(size_t worker, size_t& item) {
+        {
+            Queue& own = queues_[worker];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                item = own.tasks.back();
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for (size_t offset = 1; offset < queues_.size(); ++offset) {
+            Queue& victim = queues_[(worker + offset) % queues_.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                item = victim.tasks.front();
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    std::deque<Queue> queues_;
+};
+
+size_t workerCount(size_t requested, size_t items) {
+    size_t threads = requested ? requested : std::thread::hardware_concurrency();
+    return std::max<size_t>(std::min(threads, items), 1);
+}
+
+// Threads shared by every batch in the process, started on first use and
+// added to when a batch asks for more workers than there are, so repeated
+// small batches do not pay for thread start-up. A batch queues one task per
+// extra worker; the caller runs worker 0 itself and then any of its tasks
+// that no pool thread has picked up, so batches started from inside another
+// batch's work still finish.
+class WorkerPool {
+public:
+    static WorkerPool& instance() {
+        static WorkerPool pool;
+        return pool;
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        ready_.notify_all();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    // Runs `task(worker)` for each worker in [0, workers) and waits for all.
+    void run(size_t workers, const std::function<void(size_t)>& task) {
+        Batch batch{&task, workers - 1};
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            while (threads_.size() < workers - 1) {
+                threads_.emplace_back([this] { serve(); });
+            }
+            for (size_t worker = 1; worker < workers; ++worker) {
+                tasks_.push_back(Task{&batch, worker});
+            }
+        }
+        ready_.notify_all();
+
+        task(0);
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            const auto own = std::find_if(tasks_.begin(), tasks_.end(),
+                                          [&](const Task& queued) { return queued.batch == &batch; });
+            if (own != tasks_.end()) {
+                const size_t worker = own->worker;
+                tasks_.erase(own);
+                lock.unlock();
+                finish(batch, worker);
+                lock.lock();
+                continue;
+            }
+            if (batch.remaining == 0) {
+                return;
+            }
+            done_.wait(lock);
+        }
+    }
+
+private:
+    struct Batch {
+        const std::function<void(size_t)>* task;
+        size_t remaining; // queued or running tasks; guarded by mutex_
+    };
+
+    struct Task {
+        Batch* batch;
+        size_t worker;
+    };
+
+    WorkerPool() = default;
+
+    void serve() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            ready_.wait(lock, [&] { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty()) {
+                return;
+            }
+            const Task task = tasks_.front();
+            tasks_.pop_front();
+            lock.unlock();
+            finish(*task.batch, task.worker);
+            lock.lock();
+        }
+    }
+
+    void finish(Batch& batch, size_t worker) {
+        (*batch.task)(worker);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --batch.remaining;
+        }
+        done_.notify_all();
+    }
+
+    std::mutex mutex_;
+    std::condition_variable ready_; // tasks queued, or stopping
+    std::condition_variable done_;  // a task finished
+    std::deque<Task> tasks_;
+    std::vector<std::thread> threads_;
+    bool stopping_ = false;
+};
+
+// Runs `work(context, index)` for every index on workers of the shared pool,
+// each with its own `Context`. The calling thread is one of the workers.
+template <typename Context, typename Work>
+void runBatch(size_t items, size_t threads, Work work) {
+    if (items == 0) {
+        return;
+    }
+    const size_t workers = workerCount(threads, items);
+    StealingQueues queues(items, workers);
+    auto run = [&](size_t worker) {
+        Context context;
+        size_t item = 0;
+        while (queues.next(worker, item)) {
+            work(context, item);
+        }
+    };
+    if (workers == 1) {
+        run(0);
+        return;
+    }
+    WorkerPool::instance().run(workers, run);
+}
+
+template <typename Body>
+std::string errorOf(Body&& body) {
+    try {
+        body();
+    } catch (const std::exception& error) {
+        return error.what()[0] ? error.what() : "unknown error";
+    } catch (...) {
+        return "unknown error";
+    }
+    return {};
+}
+
+// `format`, or the format named by the extension of `path`.
+Type formatFor(const std::string& path, Type format) {
+    if (format == Type::UNKOWN) {
+        format = detail::typeFromFilename(path);
+    }
+    if (format == Type::UNKOWN) {
+        throw detail::unsupportedExtension(path);
+    }
+    return format;
+}
+
+struct ConvertContext {
+    Parser parser;
+    Encoder encoder;
+};
+
+// What an output was last produced from. An output is up to date while its
+// input hashes the same, the options match and its own size and write time
+// are those recorded after writing it.
+struct ManifestEntry {
+    std::string input;
+    uint64_t inputHash = 0;
+    uint64_t inputBytes = 0;
+    uint64_t outputBytes = 0;
+    int64_t outputTime = 0;
+    uint32_t format = 0;
+    int32_t indent = 0;
+};
+
+// Entries by output path. On disk: magic, format version, library version,
+// entry count, then each entry as length-prefixed strings and fixed-width
+// little-endian integers. A manifest that is missing, from another version or
+// damaged is treated as empty, so everything is converted again.
+class Manifest {
+public:
+    explicit Manifest(std::string path) : path_(std::move(path)) {
+        std::string data;
+        try {
+            if (!std::filesystem::exists(path_)) {
+                return;
+            }
+            data = readStringFromFile(path_);
+        } catch (const std::exception&) {
+            return;
+        }
+        Reader reader{data};
+        std::unordered_map<std::string, ManifestEntry> entries;
+        if (reader.bytes(MAGIC.size()) != MAGIC || reader.string() != VERSION) {
+            return;
+        }
+        for (uint64_t count = reader.integer(4); count > 0 && reader.ok; --count) {
+            std::string output = reader.string();
+            ManifestEntry entry;
+            entry.input = reader.string();
+            entry.inputHash = reader.integer(8);
+            entry.inputBytes = reader.integer(8);
+            entry.outputBytes = reader.integer(8);
+            entry.outputTime = static_cast<int64_t>(reader.integer(8));
+            entry.format = static_cast<uint32_t>(reader.integer(4));
+            entry.indent = static_cast<int32_t>(reader.integer(4));
+            entries.emplace(std::move(output), std::move(entry));
+        }
+        if (reader.ok && reader.pos == data.size()) {
+            entries_ = std::move(entries);
+        }
+    }
+
+    const ManifestEntry* find(const std::string& output) const {
+        auto it = entries_.find(output);
+        return it == entries_.end() ? nullptr : &it->second;
+    }
+
+    void set(const std::string& output, ManifestEntry entry) { entries_[output] = std::move(entry); }
+    void erase(const std::string& output) { entries_.erase(output); }
+
+    // Writes a temporary file next to the manifest and renames it over the
+    // old one, so readers see either the old or the new manifest.
+    void save() const {
+        std::string data(MAGIC);
+        putString(data, VERSION);
+        putInteger(data, entries_.size(), 4);
+        for (const auto& [output, entry] : entries_) {
+            putString(data, output);
+            putString(data, entry.input);
+            putInteger(data, entry.inputHash, 8);
+            putInteger(data, entry.inputBytes, 8);
+            putInteger(data, entry.outputBytes, 8);
+            putInteger(data, static_cast<uint64_t>(entry.outputTime), 8);
+            putInteger(data, entry.format, 4);
+            putInteger(data, static_cast<uint32_t>(entry.indent), 4);
+        }
+        const std::string temporary = path_ + ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            file.write(data.data(), static_cast<std::streamsize>(data.size()));
+            if (!file) {
+                throw std::runtime_error("Cannot write manifest: " + temporary);
+            }
+        }
+        std::filesystem::rename(temporary, path_);
+    }
+
+private:
+    static constexpr std::string_view MAGIC = "SERINMF\x01";
+    static constexpr std::string_view VERSION = MACRO_STRINGIFY(SERIN_VERSION);
+
+    struct Reader {
+        std::string_view data;
+        size_t pos = 0;
+        bool ok = true;
+
+        std::string_view bytes(size_t count) {
+            if (!ok || data.size() - pos < count) {
+                ok = false;
+                return {};
+            }
+            pos += count;
+            return data.substr(pos - count, count);
+        }
+
+        uint64_t integer(size_t width) {
+            const std::string_view raw = bytes(width);
+            uint64_t value = 0;
+            for (size_t i = raw.size(); i-- > 0;) {
+                value = (value << 8) | static_cast<unsigned char>(raw[i]);
+            }
+            return value;
+        }
+
+        std::string string() { return std::string(bytes(static_cast<size_t>(integer(4)))); }
+    };
+
+    static void putInteger(std::string& data, uint64_t value, size_t width) {
+        for (size_t i = 0; i < width; ++i) {
+            data += static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+    }
+
+    static void putString(std::string& data, std::string_view text) {
+        putInteger(data, text.size(), 4);
+        data += text;
+    }
+
+    std::string path_;
+    std::unordered_map<std::string, ManifestEntry> entries_;
+};
+
+int64_t writeTime(const std::string& path) {
+    return static_cast<int64_t>(std::filesystem::last_write_time(path).time_since_epoch().count());
+}
+
+bool upToDate(const ManifestEntry& entry, const ManifestEntry& current, const std::string& output) {
+    if (entry.input != current.input || entry.inputHash != current.inputHash ||
+        entry.inputBytes != current.inputBytes || entry.format != current.format ||
+        entry.indent != current.indent) {
+        return false;
+    }
+    std::error_code error;
+    const auto size = std::filesystem::file_size(output, error);
+    return !error && size == entry.outputBytes && writeTime(output) == entry.outputTime;
+}
+
+} // namespace
+
+std::vector<LoadResult> loadMany(const std::vector<std::string>& paths, const BatchOptions& options) {
+    std::vector<LoadResult> results(paths.size());
+    runBatch<Parser>(paths.size(), options.threads, [&](Parser& parser, size_t index) {
+        LoadResult& result = results[index];
+        result.path = paths[index];
+        result.error = errorOf([&] { result.value = parser.load(result.path); });
+    });
+    return results;
+}
+
+std::vector<ConvertResult> convertMany(const std::vector<std::pair<std::string, std::string>>& pairs, Type format,
+                                       const BatchOptions& options) {
+    std::vector<ConvertResult> results(pairs.size());
+    std::unique_ptr<Manifest> manifest;
+    std::vector<ManifestEntry> produced;
+    if (!options.manifest.empty()) {
+        manifest = std::make_unique<Manifest>(options.manifest);
+        produced.resize(pairs.size());
+    }
+
+    runBatch<ConvertContext>(pairs.size(), options.threads, [&](ConvertContext& context, size_t index) {
+        ConvertResult& result = results[index];
+        result.input = pairs[index].first;
+        result.output = pairs[index].second;
+        result.error = errorOf([&] {
+            const Type outputFormat = formatFor(result.output, format);
+            if (!manifest) {
+                const Value value = context.parser.load(result.input);
+                const std::string& text = context.encoder.dumps(value, outputFormat, options.indent);
+                writeStringToFile(text, result.output);
+                result.outputBytes = text.size();
+                return;
+            }
+
+            // Hash the mapped input, and parse the same mapping if it changed
+            const MappedFile input(result.input);
+            ManifestEntry& entry = produced[index];
+            entry.input = result.input;
+            entry.inputHash = hash64(input.view());
+            entry.inputBytes = input.view().size();
+            entry.format = static_cast<uint32_t>(outputFormat);
+            entry.indent = options.indent;
+            result.inputBytes = entry.inputBytes;
+            const ManifestEntry* previous = manifest->find(result.output);
+            if (previous && upToDate(*previous, entry, result.output)) {
+                entry = *previous;
+                result.outputBytes = entry.outputBytes;
+                result.skipped = true;
+                return;
+            }
+            const Type inputFormat = detail::typeFromFilename(result.input);
+            const Value value = inputFormat == Type::UNKOWN ? context.parser.load(result.input)
+                                                            : context.parser.loads(input.view(), inputFormat);
+            const std::string& text = context.encoder.dumps(value, outputFormat, options.indent);
+            writeStringToFile(text, result.output);
+            result.outputBytes = entry.outputBytes = text.size();
+            entry.outputTime = writeTime(result.output);
+        });
+        if (!manifest) {
+            std::error_code ignored;
+            const auto size = std::filesystem::file_size(result.input, ignored);
+            result.inputBytes = ignored ? 0 : static_cast<size_t>(size);
+        }
+    });
+
+    if (manifest) {
+        for (size_t i = 0; i < results.size(); ++i) {
+            if (results[i].ok()) {
+                manifest->set(results[i].output, std::move(produced[i]));
+            } else {
+                manifest->erase(results[i].output);
+            }
+        }
+        manifest->save();
+    }
+    return results;
+}
+
+void dumpAll(const Value& value, const std::vector<DumpTarget>& targets) {
+    std::vector<std::string> errors(targets.size());
+    runBatch<Encoder>(targets.size(), targets.size(), [&](Encoder& encoder, size_t index) {
+        const DumpTarget& target = targets[index];
+        errors[index] = errorOf([&] {
+            const Type format = formatFor(target.path, target.format);
+            writeStringToFile(encoder.dumps(value, format, target.indent), target.path);
+        });
+    });
+    for (size_t i = 0; i < targets.size(); ++i) {
+        if (!errors[i].empty()) {
+            throw std::runtime_error(targets[i].path + ": " + errors[i]);
+        }
+    }
+}
+
+std::vector<std::string> dumpShards(const Value& value, const std::string& outputPath,
+                                    const ShardOptions& options) {
+    if (options.rows == 0 && options.bytes == 0) {
+        throw std::runtime_error("Sharding needs a row or byte limit");
+    }
+    const Type format = formatFor(outputPath, options.format);
+
+    const Array* items = nullptr;
+    const std::string* key = nullptr;
+    if (value.isArray()) {
+        items = &value.asArray();
+    } else if (value.isObject()) {
+        for (const auto& [name, member] : value.asObject()) {
+            if (member.isArray()) {
+                items = &member.asArray();
+                key = &name;
+                break;
+            }
+        }
+    }
+    if (!items) {
+        throw std::runtime_error("Nothing to split: the document is not an array and has no array member");
+    }
+    if (key && value.asObject().size() > 1) {
+        // Every shard holds only the array; the other members would be lost
+        throw std::runtime_error("Cannot split \"" + *key +
+                                 "\": the object has other members that no shard would keep; "
+                                 "select the array first");
+    }
+
+    // Item sizes from the stats() estimates, scaled so they add up to the
+    // estimate for the whole document in the output format. Binary output
+    // has no text to estimate; its items are sized by their slots and strings.
+    std::vector<double> sizes;
+    if (options.bytes > 0 && format == Type::SERIN_BIN) {
+        sizes.reserve(items->size());
+        for (const Value& item : *items) {
+            sizes.push_back(static_cast<double>(detail::binarySize(item)));
+        }
+    } else if (options.bytes > 0) {
+        sizes.reserve(items->size());
+        double sum = 0;
+        for (const Value& item : *items) {
+            sizes.push_back(static_cast<double>(stats(item).jsonBytes) + 1);
+            sum += sizes.back();
+        }
+        const DocumentStats total = stats(value);
+        const size_t target = format == Type::JSON ? total.jsonBytes
+                              : format == Type::YAML ? total.yamlBytes
+                                                     : total.toonBytes;
+        for (double& size : sizes) {
+            size *= sum > 0 ? target / sum : 0;
+        }
+    }
+    std::vector<size_t> starts = {0};
+    double bytes = 0;
+    for (size_t i = 0; i < items->size(); ++i) {
+        const size_t count = i - starts.back();
+        const double size = sizes.empty() ? 0 : sizes[i];
+        if (count > 0 && ((options.rows && count >= options.rows) || (options.bytes && bytes + size > options.bytes))) {
+            starts.push_back(i);
+            bytes = 0;
+        }
+        bytes += size;
+    }
+    starts.push_back(items->size());
+    const size_t shards = starts.size() - 1;
+
+    const std::filesystem::path path(outputPath);
+    const std::string digits = std::to_string(shards - 1);
+    const size_t width = std::max<size_t>(digits.size(), 5);
+    std::vector<std::string> paths(shards);
+    for (size_t i = 0; i < shards; ++i) {
+        const std::string number = std::to_string(i);
+        const std::string name = path.stem().string() + "-" + std::string(width - number.size(), '0') + number +
+                                 path.extension().string();
+        paths[i] = (path.parent_path() / name).string();
+    }
+
+    std::vector<std::string> errors(shards);
+    // Each worker formats its shards into one reused buffer, straight from the items
+    runBatch<std::string>(shards, options.threads, [&](std::string& text, size_t index) {
+        errors[index] = errorOf([&] {
+            const Value* first = items->data();
+            detail::writeItems(first + starts[index], first + starts[index + 1], key, format, options.indent, text);
+            writeStringToFile(text, paths[index]);
+        });
+    });
+    for (size_t i = 0; i < shards; ++i) {
+        if (!errors[i].empty()) {
+            throw std::runtime_error(paths[i] + ": " + errors[i]);
+        }
+    }
+    return paths;
+}
+
+} // namespace serin
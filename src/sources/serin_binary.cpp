@@ -0,0 +1,714 @@
+#include "serin.h"
+#include "serin_internal.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace serin {
+
+namespace {
+
+// Layout of a .serinb file. Integers are little-endian; every offset is from
+// the start of the file except string offsets, which are from the start of
+// the string blob. All structures are 8-byte aligned.
+//
+//   header   magic "SERINB" | u8 version (1) | u8 0 | u64 file size |
+//            u64 blob offset | u64 blob size | root slot
+//   slot     u8 kind | 3 zero bytes | u32 count | u64 payload
+//              Bool, Int, Double: the value in the payload
+//              String: count = length, payload = blob offset
+//              Array:  count = items, payload = offset of `count` slots
+//              Object: count = members, payload = offset of a u64 key table
+//                      offset followed by `count` slots
+//   key table  `count` x (u64 blob offset | u32 length | u32 zero), then
+//              `count` x u32 member indexes in key order, padded to 8 bytes
+//   blob     string bytes, each distinct string stored once
+//
+// Objects with the same keys in the same order share one key table, which
+// keeps arrays of records close to their data size.
+constexpr std::string_view MAGIC("SERINB\x01\x00", 8);
+constexpr size_t HEADER_SIZE = 48;
+constexpr size_t ROOT_SLOT = 32;
+constexpr size_t SLOT_SIZE = 16;
+constexpr size_t KEY_SIZE = 16;
+
+using Kind = BinaryView::Kind;
+
+std::runtime_error corrupt(const std::string& what) {
+    return std::runtime_error("Corrupt serin binary document: " + what);
+}
+
+uint64_t readInteger(const char* bytes, size_t width) {
+    uint64_t value = 0;
+    for (size_t i = width; i-- > 0;) {
+        value = (value << 8) | static_cast<unsigned char>(bytes[i]);
+    }
+    return value;
+}
+
+// `length` bytes at `offset`, checked against the end of `data`.
+const char* checkedRange(std::string_view data, uint64_t offset, uint64_t length) {
+    if (offset > data.size() || length > data.size() - offset) {
+        throw corrupt("offset " + std::to_string(offset) + " is past the end of the file");
+    }
+    return data.data() + offset;
+}
+
+uint64_t readAt(std::string_view data, uint64_t offset, size_t width) {
+    return readInteger(checkedRange(data, offset, width), width);
+}
+
+// Start of `count` records of `size` bytes at `offset`, all inside `data`.
+uint64_t checkedTable(std::string_view data, uint64_t offset, uint64_t count, uint64_t size) {
+    if (count > data.size() / size) {
+        throw corrupt("table of " + std::to_string(count) + " entries is larger than the file");
+    }
+    checkedRange(data, offset, count * size);
+    return offset;
+}
+
+std::string_view blobString(std::string_view data, uint64_t offset, uint64_t length) {
+    const uint64_t blob = readInteger(data.data() + 16, 8);
+    if (offset > std::numeric_limits<uint64_t>::max() - blob) {
+        throw corrupt("string offset overflows");
+    }
+    return {checkedRange(data, blob + offset, length), static_cast<size_t>(length)};
+}
+
+// Checks the header of `data` and returns it unchanged.
+std::string_view checkHeader(std::string_view data) {
+    if (data.size() < HEADER_SIZE || data.substr(0, 6) != MAGIC.substr(0, 6)) {
+        throw std::runtime_error("Not a serin binary document");
+    }
+    if (data.substr(6, 2) != MAGIC.substr(6, 2)) {
+        throw std::runtime_error("Unsupported serin binary version " +
+                                 std::to_string(static_cast<unsigned char>(data[6])));
+    }
+    if (readInteger(data.data() + 8, 8) > data.size()) {
+        throw corrupt("the file is truncated");
+    }
+    return data;
+}
+
+// A slot, read and range-checked.
+struct Slot {
+    Kind kind = Kind::Null;
+    uint32_t count = 0;
+    uint64_t payload = 0;
+};
+
+// The slot at `offset`. The child slots of a container are checked to lie
+// inside `data`, so indexing them needs no further checks.
+Slot readSlot(std::string_view data, uint64_t offset) {
+    const char* bytes = checkedRange(data, offset, SLOT_SIZE);
+    const auto kind = static_cast<unsigned char>(bytes[0]);
+    if (kind > static_cast<unsigned char>(Kind::Object)) {
+        throw corrupt("unknown value kind " + std::to_string(kind));
+    }
+    Slot slot;
+    slot.kind = static_cast<Kind>(kind);
+    slot.count = static_cast<uint32_t>(readInteger(bytes + 4, 4));
+    slot.payload = readInteger(bytes + 8, 8);
+    if (slot.kind == Kind::Array) {
+        checkedTable(data, slot.payload, slot.count, SLOT_SIZE);
+    } else if (slot.kind == Kind::Object) {
+        checkedRange(data, slot.payload, 8);
+        checkedTable(data, slot.payload + 8, slot.count, SLOT_SIZE);
+    }
+    return slot;
+}
+
+// Start of the key table of an object slot.
+uint64_t keyTable(std::string_view data, const Slot& slot) {
+    return checkedTable(data, readAt(data, slot.payload, 8), slot.count, KEY_SIZE + 4);
+}
+
+std::string_view tableKey(std::string_view data, uint64_t table, size_t index) {
+    const uint64_t entry = table + KEY_SIZE * index;
+    return blobString(data, readAt(data, entry, 8), readAt(data, entry + 8, 4));
+}
+
+class BinaryWriter {
+public:
+    explicit BinaryWriter(size_t maxDepth) : maxDepth_(maxDepth) {}
+
+    // Containers are laid out breadth-first from an explicit stack: each
+    // one reserves its block of child slots, and the children fill them in
+    // as they are popped, so depth costs no call stack.
+    std::string write(const Value& value) {
+        start();
+        stack_.push_back({&value, ROOT_SLOT, 0});
+        return finish();
+    }
+
+    // Writes the document `[first, last)`, or `{wrapper: [first, last)}`,
+    // with the same layout write() gives it.
+    std::string writeItems(const Value* first, const Value* last, const std::string* wrapper) {
+        start();
+        uint64_t slot = ROOT_SLOT;
+        size_t depth = 0;
+        if (wrapper) {
+            checkDepth(1, maxDepth_);
+            Object keys;
+            keys.emplace(*wrapper, Value());
+            const uint64_t table = keyTable(keys);
+            const uint64_t block = allocate(8 + SLOT_SIZE);
+            put(block, table, 8);
+            putSlot(ROOT_SLOT, Kind::Object, 1, block);
+            slot = block + 8;
+            depth = 1;
+        }
+        checkDepth(depth + 1, maxDepth_);
+        const size_t size = static_cast<size_t>(last - first);
+        const uint64_t block = allocate(SLOT_SIZE * size);
+        putSlot(slot, Kind::Array, count(size, "Array"), block);
+        for (size_t i = size; i-- > 0;) {
+            stack_.push_back({first + i, block + SLOT_SIZE * i, depth + 1});
+        }
+        return finish();
+    }
+
+private:
+    struct Pending {
+        const Value* value;
+        uint64_t slot;
+        size_t depth;
+    };
+
+    void start() {
+        out_.assign(HEADER_SIZE, '\0');
+        out_.replace(0, MAGIC.size(), MAGIC);
+    }
+
+    std::string finish() {
+        while (!stack_.empty()) {
+            const Pending pending = stack_.back();
+            stack_.pop_back();
+            writeValue(*pending.value, pending.slot, pending.depth);
+        }
+
+        out_.resize((out_.size() + 7) & ~size_t{7}, '\0');
+        const uint64_t blobOffset = out_.size();
+        put(16, blobOffset, 8);
+        put(24, blob_.size(), 8);
+        out_ += blob_;
+        put(8, out_.size(), 8);
+        return std::move(out_);
+    }
+
+    void put(uint64_t at, uint64_t value, size_t width) {
+        for (size_t i = 0; i < width; ++i) {
+            out_[at + i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+    }
+
+    uint64_t allocate(uint64_t bytes) {
+        const uint64_t at = out_.size();
+        out_.resize(at + bytes, '\0');
+        return at;
+    }
+
+    static uint32_t count(size_t size, const char* what) {
+        if (size > std::numeric_limits<uint32_t>::max()) {
+            throw std::runtime_error(std::string(what) + " is too large for the binary format");
+        }
+        return static_cast<uint32_t>(size);
+    }
+
+    void putSlot(uint64_t at, Kind kind, uint32_t count, uint64_t payload) {
+        out_[at] = static_cast<char>(kind);
+        put(at + 4, count, 4);
+        put(at + 8, payload, 8);
+    }
+
+    uint64_t intern(std::string_view text) {
+        const auto [it, inserted] = strings_.emplace(text, blob_.size());
+        if (inserted) {
+            blob_ += text;
+        }
+        return it->second;
+    }
+
+    uint64_t keyTable(const Object& object) {
+        signature_.clear();
+        for (const auto& [key, member] : object) {
+            const uint32_t length = count(key.size(), "Key");
+            signature_.append(reinterpret_cast<const char*>(&length), sizeof(length));
+            signature_ += key;
+        }
+        if (const auto found = tables_.find(signature_); found != tables_.end()) {
+            return found->second;
+        }
+
+        const size_t members = object.size();
+        const uint64_t table = allocate((KEY_SIZE * members + 4 * members + 7) & ~uint64_t{7});
+        std::vector<std::string_view> keys;
+        keys.reserve(members);
+        for (const auto& [key, member] : object) {
+            const uint64_t at = table + KEY_SIZE * keys.size();
+            put(at, intern(key), 8);
+            put(at + 8, key.size(), 4);
+            keys.push_back(key);
+        }
+        std::vector<uint32_t> order(members);
+        for (uint32_t i = 0; i < members; ++i) {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+        for (size_t i = 0; i < members; ++i) {
+            put(table + KEY_SIZE * members + 4 * i, order[i], 4);
+        }
+        tables_.emplace(signature_, table);
+        return table;
+    }
+
+    void writeValue(const Value& value, uint64_t slot, size_t depth) {
+        if (value.isArray()) {
+            checkDepth(depth + 1, maxDepth_);
+            const Array& items = value.asArray();
+            const uint64_t block = allocate(SLOT_SIZE * items.size());
+            putSlot(slot, Kind::Array, count(items.size(), "Array"), block);
+            for (size_t i = items.size(); i-- > 0;) {
+                stack_.push_back({&items[i], block + SLOT_SIZE * i, depth + 1});
+            }
+            return;
+        }
+        if (value.isObject()) {
+            checkDepth(depth + 1, maxDepth_);
+            const Object& object = value.asObject();
+            const uint32_t members = count(object.size(), "Object");
+            const uint64_t table = keyTable(object);
+            const uint64_t block = allocate(8 + SLOT_SIZE * members);
+            put(block, table, 8);
+            putSlot(slot, Kind::Object, members, block);
+            const size_t first = stack_.size();
+            uint64_t at = block + 8;
+            for (const auto& [key, member] : object) {
+                stack_.push_back({&member, at, depth + 1});
+                at += SLOT_SIZE;
+            }
+            std::reverse(stack_.begin() + static_cast<std::ptrdiff_t>(first), stack_.end());
+            return;
+        }
+
+        const Primitive& primitive = value.asPrimitive();
+        if (primitive.isString()) {
+            const std::string& text = primitive.getString();
+            putSlot(slot, Kind::String, count(text.size(), "String"), intern(text));
+        } else if (primitive.isInt()) {
+            putSlot(slot, Kind::Int, 0, static_cast<uint64_t>(primitive.getInt()));
+        } else if (primitive.isDouble()) {
+            const double number = primitive.getDouble();
+            uint64_t bits = 0;
+            std::memcpy(&bits, &number, sizeof(bits));
+            putSlot(slot, Kind::Double, 0, bits);
+        } else if (primitive.isBool()) {
+            putSlot(slot, Kind::Bool, 0, primitive.getBool() ? 1 : 0);
+        } else {
+            putSlot(slot, Kind::Null, 0, 0);
+        }
+    }
+
+    size_t maxDepth_;
+    std::string out_;
+    std::string blob_;
+    std::vector<Pending> stack_;
+    std::unordered_map<std::string_view, uint64_t> strings_;
+    std::unordered_map<std::string, uint64_t> tables_;
+    std::string signature_;
+};
+
+// Builds the Value under `view` from an explicit stack.
+Value materialize(const BinaryView& view, size_t maxDepth) {
+    struct Pending {
+        BinaryView view;
+        Value* target;
+        size_t depth;
+    };
+    Value root;
+    std::vector<Pending> stack{{view, &root, 0}};
+    while (!stack.empty()) {
+        const Pending pending = stack.back();
+        stack.pop_back();
+        const BinaryView& current = pending.view;
+        Value& target = *pending.target;
+        switch (current.kind()) {
+            case Kind::Null: target = Value(Primitive(nullptr)); break;
+            case Kind::Bool: target = Value(Primitive(current.asBool())); break;
+            case Kind::Int: target = Value(Primitive(current.asInt())); break;
+            case Kind::Double: target = Value(Primitive(current.asDouble())); break;
+            case Kind::String: target = Value(Primitive(std::string(current.asString()))); break;
+            case Kind::Array: {
+                checkDepth(pending.depth + 1, maxDepth);
+                target.value = Array(current.size());
+                Array& items = target.asArray();
+                for (size_t i = items.size(); i-- > 0;) {
+                    stack.push_back({current[i], &items[i], pending.depth + 1});
+                }
+                break;
+            }
+            case Kind::Object: {
+                checkDepth(pending.depth + 1, maxDepth);
+                target.value = Object();
+                Object& object = target.asObject();
+                object.reserve(current.size());
+                const size_t first = stack.size();
+                // Members live in a deque, so the slots stay put as more are added
+                for (size_t i = 0; i < current.size(); ++i) {
+                    auto [it, inserted] = object.emplace(std::string(current.key(i)), Value());
+                    if (inserted) {
+                        stack.push_back({current[i], &it.value(), pending.depth + 1});
+                    }
+                }
+                std::reverse(stack.begin() + static_cast<std::ptrdiff_t>(first), stack.end());
+                break;
+            }
+        }
+    }
+    return root;
+}
+
+} // namespace
+
+// =====================
+// BinaryView
+// =====================
+
+BinaryView::BinaryView(std::string_view data, uint64_t slot) : data_(data), slot_(slot) {
+    const Slot read = readSlot(data_, slot_);
+    kind_ = read.kind;
+    count_ = read.count;
+    payload_ = read.payload;
+}
+
+static std::runtime_error wrongKind(const char* expected) {
+    return std::runtime_error(std::string("Binary value is not ") + expected);
+}
+
+bool BinaryView::asBool() const {
+    if (!isBool()) {
+        throw wrongKind("a boolean");
+    }
+    return payload_ != 0;
+}
+
+int64_t BinaryView::asInt() const {
+    if (!isInt()) {
+        throw wrongKind("an integer");
+    }
+    return static_cast<int64_t>(payload_);
+}
+
+double BinaryView::asDouble() const {
+    if (isInt()) {
+        return static_cast<double>(static_cast<int64_t>(payload_));
+    }
+    if (!isDouble()) {
+        throw wrongKind("a number");
+    }
+    double number = 0;
+    std::memcpy(&number, &payload_, sizeof(number));
+    return number;
+}
+
+std::string_view BinaryView::asString() const {
+    if (!isString()) {
+        throw wrongKind("a string");
+    }
+    return blobString(data_, payload_, count_);
+}
+
+size_t BinaryView::size() const {
+    return isArray() || isObject() ? count_ : 0;
+}
+
+BinaryView BinaryView::operator[](size_t index) const {
+    if (!isArray() && !isObject()) {
+        throw wrongKind("an array or object");
+    }
+    if (index >= count_) {
+        throw std::runtime_error("Binary index " + std::to_string(index) + " out of range for size " +
+                                 std::to_string(count_));
+    }
+    const uint64_t first = isArray() ? payload_ : payload_ + 8;
+    return BinaryView(data_, first + SLOT_SIZE * index);
+}
+
+std::string_view BinaryView::key(size_t index) const {
+    if (!isObject()) {
+        throw wrongKind("an object");
+    }
+    if (index >= count_) {
+        throw std::runtime_error("Binary index " + std::to_string(index) + " out of range for size " +
+                                 std::to_string(count_));
+    }
+    return tableKey(data_, keyTable(data_, Slot{kind_, count_, payload_}), index);
+}
+
+std::optional<BinaryView> BinaryView::find(std::string_view name) const {
+    if (!isObject()) {
+        throw wrongKind("an object");
+    }
+    const uint64_t order = keyTable(data_, Slot{kind_, count_, payload_}) + KEY_SIZE * count_;
+    size_t low = 0;
+    size_t high = count_;
+    while (low < high) {
+        const size_t middle = low + (high - low) / 2;
+        const size_t index = static_cast<size_t>(readAt(data_, order + 4 * middle, 4));
+        if (index >= count_) {
+            throw corrupt("key order entry out of range");
+        }
+        const std::string_view candidate = key(index);
+        if (candidate == name) {
+            return (*this)[index];
+        }
+        if (candidate < name) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return std::nullopt;
+}
+
+BinaryView BinaryView::at(std::string_view name) const {
+    if (auto member = find(name)) {
+        return *member;
+    }
+    throw std::runtime_error("Key not found in binary object: " + std::string(name));
+}
+
+Value BinaryView::toValue() const {
+    return materialize(*this, getMaxDepth());
+}
+
+// =====================
+// BinaryDocument
+// =====================
+
+struct BinaryDocument::Impl {
+    std::unique_ptr<MappedFile> file; // null for fromBytes()
+    std::string_view data;
+};
+
+BinaryDocument::BinaryDocument(const std::string& filename) : impl_(std::make_unique<Impl>()) {
+    // Random access: read-ahead would only fetch pages no view asks for
+    impl_->file = std::make_unique<MappedFile>(filename, false);
+    impl_->data = checkHeader(impl_->file->view());
+}
+
+BinaryDocument::BinaryDocument(std::unique_ptr<Impl> impl) : impl_(std::move(impl)) {}
+
+BinaryDocument BinaryDocument::fromBytes(std::string_view bytes) {
+    auto impl = std::make_unique<Impl>();
+    impl->data = checkHeader(bytes);
+    return BinaryDocument(std::move(impl));
+}
+BinaryDocument::~BinaryDocument() = default;
+BinaryDocument::BinaryDocument(BinaryDocument&&) noexcept = default;
+BinaryDocument& BinaryDocument::operator=(BinaryDocument&&) noexcept = default;
+
+BinaryView BinaryDocument::root() const {
+    return BinaryView(impl_->data, ROOT_SLOT);
+}
+
+std::string_view BinaryDocument::bytes() const {
+    return impl_->data;
+}
+
+// =====================
+// Free functions
+// =====================
+
+namespace detail {
+
+bool isBinary(std::string_view head) {
+    return head.substr(0, 6) == MAGIC.substr(0, 6);
+}
+
+Value parseBinary(std::string_view data, size_t maxDepth) {
+    PhaseScope phase(Phase::Build, data.size());
+    return materialize(BinaryDocument::fromBytes(data).root(), maxDepth);
+}
+
+void writeBinary(const Value& value, size_t maxDepth, std::string& out) {
+    PhaseScope phase(Phase::Emit);
+    out = BinaryWriter(maxDepth).write(value);
+    phase.setBytes(out.size());
+}
+
+void writeBinaryItems(const Value* first, const Value* last, const std::string* wrapper, size_t maxDepth,
+                      std::string& out) {
+    PhaseScope phase(Phase::Emit);
+    out = BinaryWriter(maxDepth).writeItems(first, last, wrapper);
+    phase.setBytes(out.size());
+}
+
+size_t binarySize(const Value& value) {
+    size_t bytes = 0;
+    std::vector<const Value*> stack{&value};
+    while (!stack.empty()) {
+        const Value& current = *stack.back();
+        stack.pop_back();
+        bytes += SLOT_SIZE;
+        if (current.isArray()) {
+            for (const Value& item : current.asArray()) {
+                stack.push_back(&item);
+            }
+        } else if (current.isObject()) {
+            bytes += 8;
+            for (const auto& [key, member] : current.asObject()) {
+                stack.push_back(&member);
+            }
+        } else if (current.asPrimitive().isString()) {
+            bytes += current.asPrimitive().getString().size();
+        }
+    }
+    return bytes;
+}
+
+ValidationResult scanBinary(std::string_view data, size_t maxDepth, StructureSink* sink) {
+    using Scalar = StructureSink::Scalar;
+    struct Frame {
+        Slot slot;
+        uint64_t table; // key table of an object
+        uint32_t index;
+    };
+    ValidationResult result;
+    uint64_t at = 0;
+    try {
+        checkHeader(data);
+        // The writer gives every value a slot of its own, so a walk that
+        // visits more slots than the file can hold has met shared or cyclic ones
+        const uint64_t slotLimit = data.size() / SLOT_SIZE;
+        uint64_t visited = 0;
+        std::vector<Frame> stack;
+        std::unordered_set<uint64_t> checkedTables; // objects with the same keys share one
+        char buffer[Primitive::MAX_SCALAR_LENGTH];
+
+        auto scalar = [&](Scalar kind, const Primitive& primitive) {
+            if (sink) {
+                const size_t length = primitive.writeTo(buffer, sizeof(buffer));
+                sink->scalar(kind, std::string_view(buffer, std::min(length, sizeof(buffer))));
+            }
+        };
+        // Every order entry names a member and the keys come out sorted, so
+        // find() can rely on its binary search
+        auto checkKeyOrder = [&](uint64_t table, uint32_t count) {
+            if (!checkedTables.insert(table).second) {
+                return;
+            }
+            const uint64_t order = table + KEY_SIZE * count;
+            std::string_view previous;
+            for (uint32_t i = 0; i < count; ++i) {
+                const uint64_t index = readAt(data, order + 4 * i, 4);
+                if (index >= count) {
+                    throw corrupt("key order entry out of range");
+                }
+                const std::string_view key = tableKey(data, table, index);
+                if (i > 0 && key < previous) {
+                    throw corrupt("key table is not sorted");
+                }
+                previous = key;
+            }
+        };
+        auto visit = [&](uint64_t offset) {
+            at = offset;
+            if (++visited > slotLimit) {
+                throw corrupt("slots are shared or cyclic");
+            }
+            const Slot slot = readSlot(data, offset);
+            switch (slot.kind) {
+                case Kind::Null: scalar(Scalar::Null, Primitive(nullptr)); return;
+                case Kind::Bool: scalar(Scalar::Bool, Primitive(slot.payload != 0)); return;
+                case Kind::Int: scalar(Scalar::Int, Primitive(static_cast<int64_t>(slot.payload))); return;
+                case Kind::Double: {
+                    double number = 0;
+                    std::memcpy(&number, &slot.payload, sizeof(number));
+                    scalar(Scalar::Double, Primitive(number));
+                    return;
+                }
+                case Kind::String: {
+                    const std::string_view text = blobString(data, slot.payload, slot.count);
+                    if (sink) {
+                        sink->scalar(Scalar::String, text);
+                    }
+                    return;
+                }
+                case Kind::Array:
+                case Kind::Object: {
+                    checkDepth(stack.size() + 1, maxDepth);
+                    uint64_t table = 0;
+                    if (slot.kind == Kind::Object) {
+                        table = keyTable(data, slot);
+                        checkKeyOrder(table, slot.count);
+                    }
+                    if (sink) {
+                        slot.kind == Kind::Array ? sink->beginArray() : sink->beginObject();
+                    }
+                    stack.push_back({slot, table, 0});
+                    return;
+                }
+            }
+        };
+
+        visit(ROOT_SLOT);
+        while (!stack.empty()) {
+            Frame& frame = stack.back();
+            if (frame.index == frame.slot.count) {
+                if (sink) {
+                    sink->end();
+                }
+                stack.pop_back();
+                continue;
+            }
+            const uint32_t index = frame.index++;
+            uint64_t first = frame.slot.payload;
+            if (frame.slot.kind == Kind::Object) {
+                first += 8;
+                if (sink) {
+                    sink->key(tableKey(data, frame.table, index));
+                }
+            }
+            visit(first + SLOT_SIZE * index);
+        }
+    } catch (const std::runtime_error& error) {
+        // A binary document has no lines; columns count bytes from the start
+        result.valid = false;
+        result.offset = static_cast<size_t>(at);
+        result.line = 1;
+        result.column = static_cast<size_t>(at) + 1;
+        result.message = error.what();
+    }
+    return result;
+}
+
+} // namespace detail
+
+Value loadBinary(const std::string& filename) {
+    MappedFile file(filename, false);
+    return detail::parseBinary(file.view(), getMaxDepth());
+}
+
+Value loadsBinary(std::string_view data) {
+    return detail::parseBinary(data, getMaxDepth());
+}
+
+std::string dumpsBinary(const Value& value) {
+    std::string out;
+    detail::writeBinary(value, getMaxDepth(), out);
+    return out;
+}
+
+void dumpBinary(const Value& value, const std::string& filename) {
+    FileWriter writer(filename);
+    detail::writeBinary(value, getMaxDepth(), writer.buffer());
+    writer.close();
+}
+
+} // namespace serin
@@ -0,0 +1,224 @@
+#include "serin.h"
+#include "serin_internal.h"
+#include "utils.h"
+
+#include <atomic>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#define SERIN_HAS_STAT 1
+#endif
+
+namespace serin {
+
+namespace {
+
+// What identifies the contents of a file without reading it.
+struct FileStamp {
+    uint64_t size = 0;
+    int64_t modified = 0;
+    uint64_t device = 0;
+    uint64_t inode = 0;
+
+    bool operator==(const FileStamp& other) const {
+        return size == other.size && modified == other.modified && device == other.device && inode == other.inode;
+    }
+};
+
+FileStamp stampOf(const std::string& filename) {
+    FileStamp stamp;
+#ifdef SERIN_HAS_STAT
+    struct stat info {};
+    if (::stat(filename.c_str(), &info) != 0) {
+        throw std::runtime_error("Cannot open file: " + filename);
+    }
+#if defined(__APPLE__)
+    stamp.modified = static_cast<int64_t>(info.st_mtimespec.tv_sec) * 1000000000 + info.st_mtimespec.tv_nsec;
+#else
+    stamp.modified = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+#endif
+    stamp.size = static_cast<uint64_t>(info.st_size);
+    stamp.device = static_cast<uint64_t>(info.st_dev);
+    stamp.inode = static_cast<uint64_t>(info.st_ino);
+#else
+    std::error_code error;
+    stamp.size = std::filesystem::file_size(filename, error);
+    if (error) {
+        throw std::runtime_error("Cannot open file: " + filename);
+    }
+    stamp.modified = static_cast<int64_t>(std::filesystem::last_write_time(filename).time_since_epoch().count());
+#endif
+    return stamp;
+}
+
+// Heap memory held by a Value tree, from the per-node sizes nodeOverhead()
+// reports plus string storage beyond the inline buffer.
+size_t footprint(const Value& root) {
+    const NodeOverhead overhead = nodeOverhead();
+    auto stringBytes = [&](const std::string& text) {
+        return text.capacity() > overhead.inlineString ? text.capacity() + 1 : 0;
+    };
+    size_t bytes = sizeof(Value);
+    std::vector<const Value*> stack = {&root};
+    while (!stack.empty()) {
+        const Value* value = stack.back();
+        stack.pop_back();
+        if (value->isArray()) {
+            const Array& items = value->asArray();
+            bytes += items.capacity() * overhead.arrayItem;
+            for (const Value& item : items) {
+                stack.push_back(&item);
+            }
+        } else if (value->isObject()) {
+            const Object& members = value->asObject();
+            bytes += members.size() * overhead.objectMember;
+            for (const auto& [key, member] : members) {
+                bytes += stringBytes(key);
+                stack.push_back(&member);
+            }
+        } else if (value->asPrimitive().isString()) {
+            bytes += stringBytes(value->asPrimitive().getString());
+        }
+    }
+    return bytes;
+}
+
+std::shared_ptr<DocumentCache> loadCache;
+
+} // namespace
+
+struct DocumentCache::Impl {
+    struct Entry {
+        std::string filename;
+        Type format;
+        FileStamp stamp;
+        size_t bytes;
+        std::shared_ptr<const Value> value;
+    };
+    using Key = std::pair<std::string, Type>;
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return std::hash<std::string>()(key.first) ^ static_cast<size_t>(key.second);
+        }
+    };
+
+    mutable std::mutex mutex;
+    Limits limits;
+    Stats counters;
+    // Most recently used first
+    std::list<Entry> entries;
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+
+    void drop(std::list<Entry>::iterator entry) {
+        counters.bytes -= entry->bytes;
+        index.erase({entry->filename, entry->format});
+        entries.erase(entry);
+        ++counters.evictions;
+    }
+
+    void trim() {
+        while (!entries.empty() && (counters.bytes > limits.maxBytes ||
+                                    (limits.maxEntries > 0 && entries.size() > limits.maxEntries))) {
+            drop(std::prev(entries.end()));
+        }
+    }
+};
+
+DocumentCache::DocumentCache() : DocumentCache(Limits{}) {}
+
+DocumentCache::DocumentCache(const Limits& limits) : impl_(std::make_unique<Impl>()) {
+    impl_->limits = limits;
+}
+
+DocumentCache::~DocumentCache() = default;
+
+std::shared_ptr<const Value> DocumentCache::load(const std::string& filename, Type format) {
+    if (format == Type::UNKOWN) {
+        format = detail::typeFromFilename(filename);
+        if (format == Type::UNKOWN) {
+            throw detail::unsupportedExtension(filename);
+        }
+    }
+    const FileStamp stamp = stampOf(filename);
+    const Impl::Key key(filename, format);
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        auto it = impl_->index.find(key);
+        if (it != impl_->index.end()) {
+            if (it->second->stamp == stamp) {
+                impl_->entries.splice(impl_->entries.begin(), impl_->entries, it->second);
+                ++impl_->counters.hits;
+                return it->second->value;
+            }
+            impl_->drop(it->second);
+        }
+        ++impl_->counters.misses;
+    }
+
+    // Each thread keeps a warm parsing context for its misses
+    thread_local Parser parser;
+    std::string content;
+    readFileInto(filename, content);
+    auto value = std::make_shared<const Value>(parser.loads(content, format));
+    const size_t bytes = footprint(*value);
+
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    if (bytes <= impl_->limits.maxBytes && impl_->index.find(key) == impl_->index.end()) {
+        impl_->entries.push_front(Impl::Entry{filename, format, stamp, bytes, value});
+        impl_->index.emplace(key, impl_->entries.begin());
+        impl_->counters.bytes += bytes;
+        impl_->trim();
+    }
+    return value;
+}
+
+void DocumentCache::erase(const std::string& filename) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    for (auto it = impl_->entries.begin(); it != impl_->entries.end();) {
+        auto next = std::next(it);
+        if (it->filename == filename) {
+            impl_->drop(it);
+        }
+        it = next;
+    }
+}
+
+void DocumentCache::clear() {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->counters.evictions += impl_->entries.size();
+    impl_->entries.clear();
+    impl_->index.clear();
+    impl_->counters.bytes = 0;
+}
+
+void DocumentCache::setLimits(const Limits& limits) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->limits = limits;
+    impl_->trim();
+}
+
+DocumentCache::Stats DocumentCache::stats() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    Stats stats = impl_->counters;
+    stats.entries = impl_->entries.size();
+    return stats;
+}
+
+void setLoadCache(std::shared_ptr<DocumentCache> cache) {
+    std::atomic_store(&loadCache, std::move(cache));
+}
+
+namespace detail {
+
+std::shared_ptr<DocumentCache> currentLoadCache() {
+    return std::atomic_load(&loadCache);
+}
+
+} // namespace detail
+
+} // namespace serin
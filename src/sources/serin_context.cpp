@@ -0,0 +1,149 @@
+#include "serin.h"
+#include "serin_internal.h"
+#include "utils.h"
+
+#include <stdexcept>
+
+namespace serin {
+
+namespace {
+
+// yyjson dynamic allocator: chunks freed by one document are reused by the next.
+struct YyjsonPool {
+    YyjsonPool() : alc(yyjson_alc_dyn_new()) {
+        if (!alc) {
+            throw std::runtime_error("Failed to create yyjson allocator");
+        }
+    }
+    ~YyjsonPool() { yyjson_alc_dyn_free(alc); }
+    YyjsonPool(const YyjsonPool&) = delete;
+    YyjsonPool& operator=(const YyjsonPool&) = delete;
+
+    yyjson_alc* alc;
+};
+
+std::runtime_error unsupportedFormat() {
+    return std::runtime_error("Unsupported format type");
+}
+
+} // namespace
+
+// =====================
+// Parser
+// =====================
+
+struct Parser::Impl {
+    YyjsonPool pool;
+    std::vector<detail::YamlLine> yamlLines;
+    std::string fileBuffer;
+    size_t maxDepth = serin::getMaxDepth();
+};
+
+Parser::Parser() : impl_(std::make_unique<Impl>()) {}
+Parser::~Parser() = default;
+Parser::Parser(Parser&&) noexcept = default;
+Parser& Parser::operator=(Parser&&) noexcept = default;
+
+Value Parser::loadsJson(std::string_view jsonString) {
+    return detail::parseJson(jsonString, impl_->pool.alc, impl_->maxDepth);
+}
+
+Value Parser::loadsToon(std::string_view toonString, bool strict) {
+    return detail::parseToon(toonString, strict);
+}
+
+Value Parser::loadsYaml(std::string_view yamlString) {
+    return detail::parseYaml(yamlString, impl_->yamlLines, impl_->maxDepth);
+}
+
+Value Parser::loads(std::string_view content, Type format) {
+    switch (format) {
+        case Type::JSON:
+            return loadsJson(content);
+        case Type::TOON:
+            return loadsToon(content);
+        case Type::YAML:
+            return loadsYaml(content);
+        case Type::SERIN_BIN:
+            return detail::parseBinary(content, impl_->maxDepth);
+        default:
+            throw unsupportedFormat();
+    }
+}
+
+Value Parser::load(const std::string& filename) {
+    const Type format = detail::typeFromFilename(filename);
+    if (format == Type::UNKOWN) {
+        // Let the generic loader report the unsupported extension
+        return serin::load(filename);
+    }
+    readFileInto(filename, impl_->fileBuffer);
+    return loads(impl_->fileBuffer, format);
+}
+
+void Parser::setMaxDepth(size_t depth) { impl_->maxDepth = depth; }
+size_t Parser::getMaxDepth() const { return impl_->maxDepth; }
+
+// =====================
+// Encoder
+// =====================
+
+struct Encoder::Impl {
+    YyjsonPool pool;
+    std::string output;
+    size_t maxDepth = serin::getMaxDepth();
+};
+
+Encoder::Encoder() : impl_(std::make_unique<Impl>()) {}
+Encoder::~Encoder() = default;
+Encoder::Encoder(Encoder&&) noexcept = default;
+Encoder& Encoder::operator=(Encoder&&) noexcept = default;
+
+const std::string& Encoder::dumpsJson(const Value& value, int indent) {
+    impl_->output.clear();
+    detail::writeJson(value, indent, impl_->pool.alc, impl_->maxDepth, impl_->output);
+    return impl_->output;
+}
+
+const std::string& Encoder::dumpsToon(const Value& value, const EncoderOptions& options) {
+    impl_->output.clear();
+    detail::writeToon(value, options, impl_->maxDepth, impl_->output);
+    return impl_->output;
+}
+
+const std::string& Encoder::dumpsYaml(const Value& value, int indent) {
+    impl_->output.clear();
+    detail::writeYaml(value, indent, impl_->maxDepth, impl_->output);
+    return impl_->output;
+}
+
+const std::string& Encoder::dumps(const Value& value, Type format, int indent) {
+    switch (format) {
+        case Type::JSON:
+            return dumpsJson(value, indent);
+        case Type::TOON:
+            return dumpsToon(value, EncoderOptions(indent));
+        case Type::YAML:
+            return dumpsYaml(value, indent);
+        case Type::SERIN_BIN:
+            detail::writeBinary(value, impl_->maxDepth, impl_->output);
+            return impl_->output;
+        default:
+            throw unsupportedFormat();
+    }
+}
+
+void Encoder::dump(const Value& value, const std::string& filename, int indent) {
+    const Type format = detail::typeFromFilename(filename);
+    if (format == Type::UNKOWN) {
+        // Let the generic dumper report the unsupported extension
+        serin::dump(value, filename);
+        return;
+    }
+    writeStringToFile(dumps(value, format, indent), filename);
+}
+
+void Encoder::setMaxDepth(size_t depth) { impl_->maxDepth = depth; }
+size_t Encoder::getMaxDepth() const { return impl_->maxDepth; }
+
+} // namespace serin
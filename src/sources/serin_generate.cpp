@@ -0,0 +1,286 @@
+#include "serin.h"
+#include "serin_internal.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace serin {
+
+namespace {
+
+using Entry = detail::EntrySource::Entry;
+
+constexpr size_t SAMPLE_ENTRIES = 16;
+
+// splitmix64: small, fast and the same on every platform, unlike the
+// standard distributions.
+class Random {
+public:
+    explicit Random(uint64_t seed) : state_(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    size_t below(size_t bound) { return bound ? static_cast<size_t>(next() % bound) : 0; }
+    bool chance(size_t percent) { return below(100) < percent; }
+
+private:
+    uint64_t state_;
+};
+
+const char* const WORDS[] = {
+    "alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf", "hotel",
+    "india", "juliet", "kilo", "lima", "mike", "november", "oscar", "papa",
+    "quebec", "romeo", "sierra", "tango", "uniform", "victor", "whiskey", "xray",
+    "yankee", "zulu", "café", "naïve", "Zürich", "東京", "Ωmega", "data"};
+constexpr size_t WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+// Punctuation that forces quoting or escaping in some format.
+const char* const MARKS[] = {",", ":", "\"", "\\", " - ", "#", "[1]", "{x}"};
+constexpr size_t MARK_COUNT = sizeof(MARKS) / sizeof(MARKS[0]);
+
+const char* word(Random& random) {
+    return WORDS[random.below(WORD_COUNT)];
+}
+
+std::string sentence(Random& random, size_t words) {
+    std::string text;
+    for (size_t i = 0; i < words; ++i) {
+        if (i > 0) {
+            text += random.chance(5) ? MARKS[random.below(MARK_COUNT)] : " ";
+        }
+        text += word(random);
+    }
+    return text;
+}
+
+Value integer(int64_t number) {
+    return Value(Primitive(number));
+}
+
+// Doubles with a short exact decimal form, so every format writes them the same way.
+Value decimal(Random& random, size_t range) {
+    const int64_t cents = static_cast<int64_t>(random.below(range * 100)) - static_cast<int64_t>(range * 50);
+    return Value(static_cast<double>(cents) / 100.0);
+}
+
+std::string paddedIndex(size_t index) {
+    std::string digits = std::to_string(index);
+    return std::string(digits.size() < 6 ? 6 - digits.size() : 0, '0') + digits;
+}
+
+// Produces entry `index` of a document on its own: each entry has its own
+// random stream derived from the seed, so entries can be regenerated in any
+// order and a rewind costs nothing.
+class Generator {
+public:
+    explicit Generator(const GeneratorOptions& options) : options_(options) {
+        if (options_.shape == Shape::Deep && options_.depth + 2 > getMaxDepth()) {
+            throw std::runtime_error("Generator depth " + std::to_string(options_.depth) +
+                                     " exceeds the maximum nesting depth of " + std::to_string(getMaxDepth()));
+        }
+    }
+
+    bool mapping() const { return options_.shape == Shape::Wide; }
+
+    const std::string& wrapper() const {
+        static const std::string names[] = {"rows", "", "records", "strings", "series", "items"};
+        return names[static_cast<size_t>(options_.shape)];
+    }
+
+    void entry(size_t index, Entry& entry) const {
+        Random random(options_.seed ^ (index * 0xD1B54A32D192ED03ull));
+        entry.index = index;
+        entry.key.clear();
+        switch (options_.shape) {
+            case Shape::Table: entry.value = tableRow(index, random); break;
+            case Shape::Wide:
+                entry.key = "field_" + paddedIndex(index);
+                entry.value = wideValue(random);
+                break;
+            case Shape::Deep: entry.value = deepRecord(index, random); break;
+            case Shape::Strings: entry.value = Value(sentence(random, 16 + random.below(240))); break;
+            case Shape::Numeric: entry.value = numericSeries(random); break;
+            case Shape::Mixed: entry.value = mixedRecord(index, random); break;
+        }
+    }
+
+    // Number of entries that brings the document close to `targetBytes`,
+    // measured on the dumpsJson() size of a sample of entries.
+    size_t entryCount() const {
+        Value empty = wrap({});
+        Value sample = wrap(sampleEntries());
+        const size_t emptySize = dumpsJson(empty).size();
+        const size_t sampleSize = dumpsJson(sample).size();
+        const size_t perEntry = std::max<size_t>((sampleSize - emptySize) / SAMPLE_ENTRIES, 1);
+        return std::max<size_t>(options_.targetBytes / perEntry, 1);
+    }
+
+    // The whole document for the given entries.
+    Value wrap(std::vector<Entry> entries) const {
+        if (mapping()) {
+            Object root;
+            root.reserve(entries.size());
+            for (auto& entry : entries) {
+                root.emplace(std::move(entry.key), std::move(entry.value));
+            }
+            return Value(std::move(root));
+        }
+        Array items;
+        items.reserve(entries.size());
+        for (auto& entry : entries) {
+            items.push_back(std::move(entry.value));
+        }
+        Object root;
+        root.emplace(wrapper(), Value(std::move(items)));
+        return Value(std::move(root));
+    }
+
+private:
+    std::vector<Entry> sampleEntries() const {
+        std::vector<Entry> entries(SAMPLE_ENTRIES);
+        for (size_t i = 0; i < entries.size(); ++i) {
+            entry(i, entries[i]);
+        }
+        return entries;
+    }
+
+    static Value tableRow(size_t index, Random& random) {
+        Object row;
+        const std::string name = std::string(word(random)) + "_" + std::to_string(index);
+        row.emplace("id", integer(static_cast<int64_t>(index)));
+        row.emplace("name", Value(name));
+        row.emplace("email", Value(name + "@example.com"));
+        row.emplace("age", integer(static_cast<int64_t>(18 + random.below(70))));
+        row.emplace("score", decimal(random, 1000));
+        row.emplace("active", Value(random.chance(70)));
+        row.emplace("city", Value(word(random)));
+        return Value(std::move(row));
+    }
+
+    static Value wideValue(Random& random) {
+        switch (random.below(5)) {
+            case 0: return integer(static_cast<int64_t>(random.below(1000000)));
+            case 1: return decimal(random, 10000);
+            case 2: return Value(sentence(random, 1 + random.below(4)));
+            case 3: return Value(random.chance(50));
+            default: return Value(nullptr);
+        }
+    }
+
+    // Built from the innermost level out, so depth costs no stack.
+    Value deepRecord(size_t index, Random& random) const {
+        Array leaf;
+        for (size_t i = 0; i < 3; ++i) {
+            leaf.push_back(integer(static_cast<int64_t>(random.below(1000))));
+        }
+        Object node;
+        node.emplace("level", integer(static_cast<int64_t>(options_.depth)));
+        node.emplace("values", Value(std::move(leaf)));
+        for (size_t level = options_.depth; level-- > 1;) {
+            Object parent;
+            parent.emplace("level", integer(static_cast<int64_t>(level)));
+            parent.emplace("name", Value(word(random)));
+            parent.emplace("child", Value(std::move(node)));
+            node = std::move(parent);
+        }
+        node.emplace("id", integer(static_cast<int64_t>(index)));
+        return Value(std::move(node));
+    }
+
+    static Value numericSeries(Random& random) {
+        Array series;
+        series.reserve(16);
+        for (size_t i = 0; i < 16; ++i) {
+            if (i % 2 == 0) {
+                series.push_back(integer(static_cast<int64_t>(random.next() >> 20) - (int64_t{1} << 43)));
+            } else {
+                series.push_back(decimal(random, 2000000));
+            }
+        }
+        return Value(std::move(series));
+    }
+
+    static Value mixedRecord(size_t index, Random& random) {
+        Object user;
+        user.emplace("name", Value(sentence(random, 2)));
+        user.emplace("verified", Value(random.chance(10)));
+        user.emplace("followers", integer(static_cast<int64_t>(random.below(100000))));
+
+        Array tags;
+        for (size_t i = random.below(5); i > 0; --i) {
+            tags.push_back(Value(word(random)));
+        }
+
+        Object record;
+        record.emplace("id", integer(static_cast<int64_t>(index)));
+        record.emplace("text", Value(sentence(random, 4 + random.below(20))));
+        record.emplace("user", Value(std::move(user)));
+        record.emplace("tags", Value(std::move(tags)));
+        record.emplace("score", random.chance(20) ? Value(nullptr) : decimal(random, 100));
+        record.emplace("location", random.chance(50) ? Value(nullptr) : Value(word(random)));
+        return Value(std::move(record));
+    }
+
+    GeneratorOptions options_;
+};
+
+class GeneratorSource : public detail::EntrySource {
+public:
+    explicit GeneratorSource(const GeneratorOptions& options)
+        : generator_(options), count_(generator_.entryCount()) {}
+
+    bool mapping() const override { return generator_.mapping(); }
+    const std::string* wrapper() const override { return mapping() ? nullptr : &generator_.wrapper(); }
+
+    bool next(Entry& entry) override {
+        if (index_ == count_) {
+            return false;
+        }
+        generator_.entry(index_++, entry);
+        return true;
+    }
+
+    void rewind() override { index_ = 0; }
+
+private:
+    Generator generator_;
+    size_t count_;
+    size_t index_ = 0;
+};
+
+} // namespace
+
+Shape stringToShape(const std::string& name) {
+    const std::string lowered = toLower(name);
+    if (lowered == "table") return Shape::Table;
+    if (lowered == "wide") return Shape::Wide;
+    if (lowered == "deep") return Shape::Deep;
+    if (lowered == "strings") return Shape::Strings;
+    if (lowered == "numeric") return Shape::Numeric;
+    if (lowered == "mixed") return Shape::Mixed;
+    throw std::runtime_error("Unknown document shape: " + name +
+                             ". Supported shapes: table, wide, deep, strings, numeric, mixed");
+}
+
+Value generate(const GeneratorOptions& options) {
+    Generator generator(options);
+    std::vector<Entry> entries(generator.entryCount());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        generator.entry(i, entries[i]);
+    }
+    return generator.wrap(std::move(entries));
+}
+
+size_t generateFile(const std::string& outputPath, const GeneratorOptions& options,
+                    const StreamOptions& streamOptions) {
+    GeneratorSource source(options);
+    return detail::writeEntries(source, outputPath, streamOptions);
+}
+
+} // namespace serin
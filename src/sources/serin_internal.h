@@ -0,0 +1,241 @@
+#pragma once
+
+#include "serin.h"
+#include "yyjson.h"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace serin {
+namespace detail {
+
+// A non-empty YAML line with comments stripped.
+struct YamlLine {
+    int indent{};
+    bool isListItem{};
+    std::string text; // trimmed text (for list items this still contains the leading '-')
+};
+
+// Trie of projection paths. `keep` marks the end of a path: the whole subtree
+// below it is materialised.
+struct ProjectionNode {
+    bool keep = false;
+    std::vector<std::pair<Path::Step, std::unique_ptr<ProjectionNode>>> children;
+};
+
+// Trie nodes that apply to one container while loading a projection.
+using ProjectionSet = std::vector<const ProjectionNode*>;
+
+// Collects the children of `nodes` that select object member `key` (or array
+// item `index` of `length`) into `out`. Returns true when the whole child must
+// be kept; `out` is then left unspecified.
+bool matchMember(const ProjectionSet& nodes, std::string_view key, ProjectionSet& out);
+bool matchItem(const ProjectionSet& nodes, size_t index, size_t length, ProjectionSet& out);
+
+// True when matching items of `nodes` needs the array length (negative
+// indexes or open-ended reverse slices).
+bool needsLength(const ProjectionSet& nodes);
+
+// Filter comparison shared by Path filters and table predicates. Numbers
+// compare across int and double, strings lexicographically; other kinds only
+// support equality.
+bool compareFilter(const Primitive& value, Path::FilterOp op, const Primitive& literal);
+
+// Whether a three-way comparison result (-1, 0, 1) satisfies `op`.
+bool orderSatisfies(int order, Path::FilterOp op);
+
+// Format for a file name based on its extension, or Type::UNKOWN.
+Type typeFromFilename(const std::string& filename);
+
+// The error for a file whose extension names no supported format; the one
+// place that lists the supported extensions.
+std::runtime_error unsupportedExtension(const std::string& filename);
+
+// The cache set with setLoadCache(), or null.
+std::shared_ptr<DocumentCache> currentLoadCache();
+
+// Format entry points shared by the free functions and the reusable contexts.
+// `alc` may be null to use the libc allocator; `lines` is scratch storage that
+// keeps its capacity between calls.
+Value parseJson(std::string_view json, const yyjson_alc* alc, size_t maxDepth,
+                const ProjectionNode* projection = nullptr);
+// Converts a parsed yyjson value (and everything below it) into a Value.
+Value convertJson(yyjson_val* root, size_t maxDepth);
+void writeJson(const Value& value, int indent, const yyjson_alc* alc, size_t maxDepth, std::string& out);
+
+// `complete`, when set, receives whether every line belonged to the root value.
+Value parseYaml(std::string_view yaml, std::vector<YamlLine>& lines, size_t maxDepth,
+                const ProjectionNode* projection = nullptr, bool* complete = nullptr);
+void writeYaml(const Value& value, int indent, size_t maxDepth, std::string& out);
+// Appends the `- ...` lines writeYaml gives `item` as an item of an array
+// `level` containers deep (0: the root), each line ending in a newline.
+void writeYamlItem(const Value& item, int indent, size_t level, size_t maxDepth, std::string& out);
+
+Value parseToon(std::string_view toon, bool strict);
+
+// Whether `head` starts with the magic bytes of a serin binary document.
+bool isBinary(std::string_view head);
+Value parseBinary(std::string_view data, size_t maxDepth);
+// Replaces `out` with the encoding of `value`.
+void writeBinary(const Value& value, size_t maxDepth, std::string& out);
+// Replaces `out` with the encoding of the array `[first, last)`, or of
+// `{*wrapper: [first, last)}`, without building that document.
+void writeBinaryItems(const Value* first, const Value* last, const std::string* wrapper, size_t maxDepth,
+                      std::string& out);
+// Bytes the binary writer spends on `value` as part of a larger document:
+// its slots, object headers and string values. Key tables, which records
+// with the same keys share, and the file header are left out.
+size_t binarySize(const Value& value);
+void writeToon(const Value& value, const EncoderOptions& options, size_t maxDepth, std::string& out);
+
+// Receives the structure of a document from a tokeniser that does not build
+// it. Containers are bracketed by begin*() and end(); object members are a
+// key() followed by their value.
+class StructureSink {
+public:
+    enum class Scalar { Null, Bool, Int, Double, String };
+
+    virtual ~StructureSink() = default;
+    virtual void beginObject() = 0;
+    virtual void beginArray() = 0;
+    virtual void end() = 0;
+    virtual void key(std::string_view name) = 0;
+    // `text` is the string contents (still escaped) or the literal as written
+    virtual void scalar(Scalar kind, std::string_view text) = 0;
+};
+
+// The YAML and TOON tokenisers behind validate(), reporting to `sink` when set.
+ValidationResult scanYaml(std::string_view content, size_t maxDepth, StructureSink* sink);
+ValidationResult scanToon(std::string_view content, size_t maxDepth, StructureSink* sink);
+// Walks every slot of a serin binary document, checking its ranges, key
+// tables and nesting; errors are reported at the offset of the slot.
+ValidationResult scanBinary(std::string_view data, size_t maxDepth, StructureSink* sink);
+
+// Kind of an unquoted scalar, as the YAML loader and the TOON table reader decode it.
+StructureSink::Scalar yamlScalarKind(std::string_view token);
+StructureSink::Scalar toonScalarKind(std::string_view token);
+
+// Shape of an array seen one item at a time: which TOON array form it takes.
+struct ToonArrayLayout {
+    size_t length = 0;
+    bool primitives = true;
+    bool objects = true;
+    bool uniform = true;             // objects sharing the first object's fields
+    std::vector<std::string> fields; // fields of the first object, in order
+
+    void add(const Value& item);
+};
+
+// Writes `key[N]...` item by item, producing the same text as writeToon does
+// for the whole array at depth 0. `layout` comes from a first pass over the
+// same items.
+class ToonArrayWriter {
+public:
+    ToonArrayWriter(const std::string& key, const ToonArrayLayout& layout, const EncoderOptions& options,
+                    size_t maxDepth);
+
+    void begin(std::string& out);
+    void add(const Value& item, std::string& out);
+    void end(std::string& out);
+
+private:
+    const ToonArrayLayout& layout_;
+    EncoderOptions options_;
+    size_t maxDepth_;
+    std::vector<const std::string*> fieldRefs_;
+    std::string header_;
+    size_t written_ = 0;
+};
+
+// Marks a phase of loading or dumping on this thread. Allocations made in
+// the scope count towards it in memoryStats(), and while tracing is on its
+// duration and byte count are reported when the scope ends.
+class PhaseScope {
+public:
+    explicit PhaseScope(Phase phase, size_t bytes = 0);
+    ~PhaseScope();
+    PhaseScope(const PhaseScope&) = delete;
+    PhaseScope& operator=(const PhaseScope&) = delete;
+
+    void setBytes(size_t bytes) { bytes_ = bytes; }
+
+private:
+    Phase phase_;
+    Phase previous_;
+    size_t bytes_;
+    bool traced_ = false;
+    uint64_t start_ = 0;
+};
+
+// Tracing support for PhaseScope (serin_trace.cpp).
+bool tracing();
+uint64_t traceClock();
+void traceEvent(Phase phase, uint64_t start, size_t bytes);
+
+// Sums the phases traced on this thread while it lives and reports one event
+// per phase when it ends, laid end to end from its start. For loops that
+// repeat the same phases per entry, where an event each would swamp a trace.
+class TraceBatch {
+public:
+    TraceBatch();
+    ~TraceBatch();
+    TraceBatch(const TraceBatch&) = delete;
+    TraceBatch& operator=(const TraceBatch&) = delete;
+
+    void add(Phase phase, uint64_t duration, size_t bytes);
+
+private:
+    struct Total {
+        uint64_t durationNs = 0;
+        size_t bytes = 0;
+        size_t count = 0;
+    };
+
+    TraceBatch* outer_;
+    uint64_t start_ = 0;
+    std::array<Total, PHASE_COUNT> totals_{};
+};
+
+// Makes memoryStats() available; serin_alloc_hooks calls it at start-up.
+void installCounting();
+
+// malloc and free that memoryStats() counts while it is enabled; the
+// operator new/delete replacements in serin_alloc_hooks forward here.
+void* countedMalloc(size_t size);
+void countedFree(void* ptr);
+
+// `alc`, or when null an allocator whose blocks memoryStats() counts
+// (yyjson otherwise calls malloc directly).
+const yyjson_alc* trackedAllocator(const yyjson_alc* alc);
+
+// Yields the top-level entries of a document one at a time (convertStream).
+class EntrySource {
+public:
+    using Entry = PushParser::Entry;
+
+    virtual ~EntrySource() = default;
+    // True when entries are members of a root object, false for array items.
+    virtual bool mapping() const = 0;
+    // Name of the single root member that holds the items, if any (TOON tables).
+    virtual const std::string* wrapper() const { return nullptr; }
+    virtual bool next(Entry& entry) = 0;
+    // Restarts from the first entry; TOON output reads the entries twice.
+    virtual void rewind() = 0;
+};
+
+// Writes every entry of `source` to `outputPath` (stdout when empty) in the
+// format convertStream() would choose. Returns the number of entries.
+size_t writeEntries(EntrySource& source, const std::string& outputPath, const StreamOptions& options);
+
+// Replaces `out` with `format` text for the array `[first, last)`, or for
+// `{*wrapper: [first, last)}`, as dumps() would write that document, but
+// from the items where they are (dumpShards).
+void writeItems(const Value* first, const Value* last, const std::string* wrapper, Type format, int indent,
+                std::string& out);
+
+} // namespace detail
+} // namespace serin
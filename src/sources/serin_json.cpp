@@ -1,11 +1,16 @@
 #include "serin.h"
+#include "serin_internal.h"
 #include "yyjson.h"
 #include "utils.h"
 
+#include <algorithm>
+#include <deque>
 #include <iostream>
+#include <memory>
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
+#include <vector>
 
 namespace serin {
 
@@ -13,49 +18,192 @@ namespace serin {
 // Internal helpers
 // =====================
 
-static Value parseYyjson(yyjson_val *val) {
+// Containers still being converted. An explicit stack keeps the nesting depth
+// of the input off the call stack.
+struct ParseFrame {
+    Value *target;
+    bool isArray;
+    yyjson_arr_iter arr;
+    yyjson_obj_iter obj;
+};
+
+static Value scalarFromYyjson(yyjson_val *val) {
     if (yyjson_is_null(val)) return Value(nullptr);
     if (yyjson_is_bool(val)) return Value(yyjson_get_bool(val));
-    if (yyjson_is_int(val)) return Value(yyjson_get_int(val));
+    if (yyjson_is_uint(val) && yyjson_get_uint(val) > static_cast<uint64_t>(INT64_MAX)) {
+        return Value(static_cast<double>(yyjson_get_uint(val)));
+    }
+    if (yyjson_is_int(val)) return Value(yyjson_get_sint(val));
     if (yyjson_is_num(val))  return Value(yyjson_get_real(val));
-    if (yyjson_is_str(val)) return Value(yyjson_get_str(val));
+    if (yyjson_is_str(val)) return Value(std::string(yyjson_get_str(val), yyjson_get_len(val)));
 
+    throw std::runtime_error("Unsupported JSON type");
+}
+
+// Stores `val` into `slot`; containers are pushed on `stack` to be filled later.
+static void assignYyjson(yyjson_val *val, Value &slot, std::vector<ParseFrame> &stack, size_t maxDepth) {
     if (yyjson_is_arr(val)) {
-        Array arr;
-        size_t len = yyjson_arr_size(val);
-        for (size_t i = 0; i < len; ++i) {
-            arr.push_back(parseYyjson(yyjson_arr_get(val, i)));
-        }
-        return Value(arr);
+        checkDepth(stack.size() + 1, maxDepth);
+        slot = Value(Array{});
+        slot.asArray().reserve(yyjson_arr_size(val));
+        ParseFrame frame{&slot, true, {}, {}};
+        yyjson_arr_iter_init(val, &frame.arr);
+        stack.push_back(frame);
+        return;
     }
 
     if (yyjson_is_obj(val)) {
-        Object obj;
-        yyjson_obj_iter iter = yyjson_obj_iter_with(val);
-        yyjson_val *key;
-        while ((key = yyjson_obj_iter_next(&iter))) {
-            yyjson_val *item = yyjson_obj_iter_get_val(key);
-            obj[yyjson_get_str(key)] = parseYyjson(item);
+        checkDepth(stack.size() + 1, maxDepth);
+        slot = Value(Object{});
+        slot.asObject().reserve(yyjson_obj_size(val));
+        ParseFrame frame{&slot, false, {}, {}};
+        yyjson_obj_iter_init(val, &frame.obj);
+        stack.push_back(frame);
+        return;
+    }
+
+    slot = scalarFromYyjson(val);
+}
+
+static Value parseYyjson(yyjson_val *root, size_t maxDepth) {
+    Value result;
+    std::vector<ParseFrame> stack;
+    assignYyjson(root, result, stack, maxDepth);
+
+    while (!stack.empty()) {
+        ParseFrame &frame = stack.back();
+        if (frame.isArray) {
+            yyjson_val *item = yyjson_arr_iter_next(&frame.arr);
+            if (!item) {
+                stack.pop_back();
+                continue;
+            }
+            Array &arr = frame.target->asArray();
+            arr.emplace_back();
+            assignYyjson(item, arr.back(), stack, maxDepth);
+            continue;
+        }
+
+        yyjson_val *key = yyjson_obj_iter_next(&frame.obj);
+        if (!key) {
+            stack.pop_back();
+            continue;
         }
-        return Value(obj);
+        Value &slot = frame.target->asObject()[std::string(yyjson_get_str(key), yyjson_get_len(key))];
+        assignYyjson(yyjson_obj_iter_get_val(key), slot, stack, maxDepth);
     }
 
-    throw std::runtime_error("Unsupported JSON type");
+    return result;
+}
+
+// Containers on a projected path. `nodes` are the trie nodes that select their children.
+struct ProjectedFrame {
+    Value *target;
+    bool isArray;
+    yyjson_arr_iter arr;
+    yyjson_obj_iter obj;
+    size_t index;
+    size_t length;
+    const detail::ProjectionSet *nodes;
+};
+
+// Converts only the subtrees selected by `projection`; everything else stays in the
+// yyjson DOM and is never copied into Values.
+static Value parseYyjsonProjected(yyjson_val *root, const detail::ProjectionNode &projection, size_t maxDepth) {
+    if (projection.keep) {
+        return parseYyjson(root, maxDepth);
+    }
+
+    Value result;
+    std::vector<ProjectedFrame> stack;
+    std::deque<detail::ProjectionSet> sets;
+    detail::ProjectionSet matched;
+
+    auto open = [&](yyjson_val *val, Value &slot, detail::ProjectionSet &&nodes) {
+        checkDepth(stack.size() + 1, maxDepth);
+        sets.push_back(std::move(nodes));
+        ProjectedFrame frame{&slot, yyjson_is_arr(val), {}, {}, 0, yyjson_get_len(val), &sets.back()};
+        if (frame.isArray) {
+            slot = Value(Array{});
+            yyjson_arr_iter_init(val, &frame.arr);
+        } else {
+            slot = Value(Object{});
+            yyjson_obj_iter_init(val, &frame.obj);
+        }
+        stack.push_back(frame);
+    };
+    if (yyjson_is_ctn(root)) {
+        open(root, result, detail::ProjectionSet{&projection});
+    }
+
+    while (!stack.empty()) {
+        ProjectedFrame &frame = stack.back();
+        const size_t depth = stack.size();
+        if (frame.isArray) {
+            yyjson_val *item = yyjson_arr_iter_next(&frame.arr);
+            if (!item) {
+                stack.pop_back();
+                continue;
+            }
+            Array &arr = frame.target->asArray();
+            if (detail::matchItem(*frame.nodes, frame.index++, frame.length, matched)) {
+                arr.push_back(parseYyjson(item, maxDepth - depth));
+            } else if (!matched.empty() && yyjson_is_ctn(item)) {
+                arr.emplace_back();
+                open(item, arr.back(), std::move(matched));
+            }
+            continue;
+        }
+
+        yyjson_val *key = yyjson_obj_iter_next(&frame.obj);
+        if (!key) {
+            stack.pop_back();
+            continue;
+        }
+        yyjson_val *val = yyjson_obj_iter_get_val(key);
+        const std::string_view name(yyjson_get_str(key), yyjson_get_len(key));
+        if (detail::matchMember(*frame.nodes, name, matched)) {
+            frame.target->asObject()[std::string(name)] = parseYyjson(val, maxDepth - depth);
+        } else if (!matched.empty() && yyjson_is_ctn(val)) {
+            Value &slot = frame.target->asObject()[std::string(name)];
+            open(val, slot, std::move(matched));
+        }
+    }
+
+    return result;
 }
 
 // =====================
 // JSON Serialization
 // =====================
 
-Value loadsJson(const std::string& jsonString) {
-    yyjson_doc *doc = yyjson_read(jsonString.c_str(), jsonString.length(), 0);
+namespace detail {
+
+Value parseJson(std::string_view json, const yyjson_alc* alc, size_t maxDepth, const ProjectionNode* projection) {
+    yyjson_doc *doc = nullptr;
+    {
+        PhaseScope phase(Phase::Parse, json.size());
+        doc = yyjson_read_opts(const_cast<char *>(json.data()), json.size(), 0, trackedAllocator(alc), nullptr);
+    }
     if (!doc) throw std::runtime_error("Invalid JSON");
 
-    yyjson_val *root = yyjson_doc_get_root(doc);
-    Value value = parseYyjson(root);
+    std::unique_ptr<yyjson_doc, decltype(&yyjson_doc_free)> guard(doc, &yyjson_doc_free);
+    PhaseScope phase(Phase::Build, json.size());
+    if (projection) {
+        return parseYyjsonProjected(yyjson_doc_get_root(doc), *projection, maxDepth);
+    }
+    return parseYyjson(yyjson_doc_get_root(doc), maxDepth);
+}
 
-    yyjson_doc_free(doc); 
-    return value;
+Value convertJson(yyjson_val* root, size_t maxDepth) {
+    PhaseScope phase(Phase::Build);
+    return parseYyjson(root, maxDepth);
+}
+
+} // namespace detail
+
+Value loadsJson(const std::string& jsonString) {
+    return detail::parseJson(jsonString, nullptr, getMaxDepth());
 }
 
 Value loadJson(const std::string& filename) {
@@ -133,7 +281,15 @@ Value loadJson(const std::string& filename) {
 //    }
 //
 //#else
-    static yyjson_mut_val* buildYyjson(yyjson_mut_doc* doc, const Value& val) {
+    // Containers whose children are still being appended to the mutable doc.
+    struct BuildFrame {
+        const Value* source;
+        yyjson_mut_val* target;
+        size_t index;
+    };
+
+    static yyjson_mut_val* makeYyjson(yyjson_mut_doc* doc, const Value& val,
+                                      std::vector<BuildFrame>& stack, size_t maxDepth) {
         if (val.isPrimitive()) {
             const auto& p = val.asPrimitive();
             return std::visit([&](auto&& arg) -> yyjson_mut_val* {
@@ -147,40 +303,87 @@ Value loadJson(const std::string& filename) {
                 else if constexpr (std::is_same_v<T, double>)
                     return yyjson_mut_real(doc, arg);
                 else // std::string
-                    return yyjson_mut_strcpy(doc, arg.c_str());
-            }, p);
+                    return yyjson_mut_strncpy(doc, arg.data(), arg.size());
+            }, static_cast<const Primitive::Base&>(p));
         }
 
-        if (val.isArray()) {
-            yyjson_mut_val* arr = yyjson_mut_arr(doc);
-            for (const auto& e : val.asArray()) {
-                yyjson_mut_val* child = buildYyjson(doc, e);
-                yyjson_mut_arr_append(arr, child);
+        checkDepth(stack.size() + 1, maxDepth);
+        yyjson_mut_val* container = val.isArray() ? yyjson_mut_arr(doc) : yyjson_mut_obj(doc);
+        stack.push_back(BuildFrame{&val, container, 0});
+        return container;
+    }
+
+    static yyjson_mut_val* buildYyjson(yyjson_mut_doc* doc, const Value& root, size_t maxDepth) {
+        std::vector<BuildFrame> stack;
+        yyjson_mut_val* result = makeYyjson(doc, root, stack, maxDepth);
+
+        while (!stack.empty()) {
+            BuildFrame& frame = stack.back();
+            yyjson_mut_val* target = frame.target;
+            const size_t index = frame.index++;
+
+            if (frame.source->isArray()) {
+                const Array& arr = frame.source->asArray();
+                if (index == arr.size()) {
+                    stack.pop_back();
+                    continue;
+                }
+                yyjson_mut_arr_append(target, makeYyjson(doc, arr[index], stack, maxDepth));
+                continue;
             }
-            return arr;
+
+            const Object& obj = frame.source->asObject();
+            if (index == obj.size()) {
+                stack.pop_back();
+                continue;
+            }
+            const auto& [name, child] = obj.values_container()[index];
+            yyjson_mut_val* key = yyjson_mut_strncpy(doc, name.data(), name.size());
+            yyjson_mut_obj_add(target, key, makeYyjson(doc, child, stack, maxDepth));
         }
 
-        // Object
-        yyjson_mut_val* obj = yyjson_mut_obj(doc);
-        for (const auto& kv : val.asObject()) {
-            yyjson_mut_val* child = buildYyjson(doc, kv.second);
-            yyjson_mut_val* key = yyjson_mut_strcpy(doc, kv.first.c_str());
-            yyjson_mut_obj_add(obj, key, child);
+        return result;
+    }
+
+    // Same flags as yyjson_mut_write(doc, indent, len); indent <= 0 is compact.
+    static yyjson_write_flag writeFlags(int indent) {
+        if (indent <= 0) return YYJSON_WRITE_NOFLAG;
+        const uint32_t width = std::min<uint32_t>(static_cast<uint32_t>(indent), YYJSON_WRITE_MAX_INDENT);
+        yyjson_write_flag flg = YYJSON_WRITE_PRETTY |
+            (((yyjson_write_flag)(width + 1) << YYJSON_WRITE_INDENT_SHIFT) & YYJSON_WRITE_INDENT_MASK);
+        if (width == 2) flg |= YYJSON_WRITE_PRETTY_TWO_SPACES;
+        return flg;
+    }
+
+namespace detail {
+
+    void writeJson(const Value& value, int indent, const yyjson_alc* alc, size_t maxDepth, std::string& out) {
+        PhaseScope phase(Phase::Emit);
+        alc = trackedAllocator(alc);
+        yyjson_mut_doc* doc = yyjson_mut_doc_new(alc);
+        if (!doc) throw std::runtime_error("Failed to allocate JSON document");
+        std::unique_ptr<yyjson_mut_doc, decltype(&yyjson_mut_doc_free)> guard(doc, &yyjson_mut_doc_free);
+
+        yyjson_mut_doc_set_root(doc, buildYyjson(doc, value, maxDepth));
+
+        size_t length = 0;
+        char* json_cstr = yyjson_mut_write_opts(doc, writeFlags(indent), alc, &length, nullptr);
+        if (!json_cstr) throw std::runtime_error("Failed to write JSON");
+        out.append(json_cstr, length);
+        phase.setBytes(length);
+        if (alc) {
+            alc->free(alc->ctx, json_cstr);
+        } else {
+            free(json_cstr);
         }
-        return obj;
     }
 
+} // namespace detail
+
 // Serialize serin::Value → JSON string
     std::string dumpsJson(const Value& value, int indent) {
-        yyjson_mut_doc* doc = yyjson_mut_doc_new(nullptr);
-        yyjson_mut_val* root = buildYyjson(doc, value);
-        yyjson_mut_doc_set_root(doc, root);
-
-        if (indent == 0) indent = -1;
-        char* json_cstr = yyjson_mut_write(doc, indent, nullptr);
-        std::string json(json_cstr);
-        free(json_cstr);
-        yyjson_mut_doc_free(doc);
+        std::string json;
+        detail::writeJson(value, indent, nullptr, getMaxDepth(), json);
         return json;
     }
 
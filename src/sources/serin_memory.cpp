@@ -0,0 +1,219 @@
+#include "serin.h"
+#include "serin_internal.h"
+
+#include <atomic>
+#include <cstdlib>
+
+// Counting needs the size of a block when it is freed; use the allocator's
+// own record of it rather than a header on every allocation.
+#if defined(__GLIBC__) || defined(__linux__)
+#include <malloc.h>
+#define SERIN_BLOCK_SIZE(ptr) malloc_usable_size(ptr)
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#define SERIN_BLOCK_SIZE(ptr) malloc_size(ptr)
+#elif defined(_WIN32)
+#include <malloc.h>
+#define SERIN_BLOCK_SIZE(ptr) _msize(ptr)
+#endif
+
+namespace serin {
+
+namespace {
+
+struct PhaseCounters {
+    std::atomic<size_t> allocations{0};
+    std::atomic<size_t> bytes{0};
+    std::atomic<int64_t> peak{0};
+};
+
+// Plain globals with constant initialisation: operator new may run before
+// any dynamic initialiser.
+std::atomic<bool> enabled{false};
+// Whether counting can be enabled: from the start with the SERIN_MEMORY_STATS
+// option, otherwise once serin_alloc_hooks installs it.
+#if defined(SERIN_MEMORY_STATS) && defined(SERIN_BLOCK_SIZE)
+std::atomic<bool> installed{true};
+#else
+std::atomic<bool> installed{false};
+#endif
+std::atomic<int64_t> liveBytes{0};
+std::atomic<int64_t> peakBytes{0};
+PhaseCounters phases[PHASE_COUNT];
+thread_local Phase currentPhase = Phase::Other;
+
+void raise(std::atomic<int64_t>& peak, int64_t value) {
+    int64_t seen = peak.load(std::memory_order_relaxed);
+    while (value > seen && !peak.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+    }
+}
+
+[[maybe_unused]] void recordAllocation(size_t size) {
+    if (!enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    const int64_t live = liveBytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed) +
+                         static_cast<int64_t>(size);
+    raise(peakBytes, live);
+    PhaseCounters& phase = phases[static_cast<size_t>(currentPhase)];
+    phase.allocations.fetch_add(1, std::memory_order_relaxed);
+    phase.bytes.fetch_add(size, std::memory_order_relaxed);
+    raise(phase.peak, live);
+}
+
+[[maybe_unused]] void recordRelease(size_t size) {
+    if (enabled.load(std::memory_order_relaxed)) {
+        liveBytes.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+    }
+}
+
+#ifdef SERIN_BLOCK_SIZE
+
+// Both check `enabled` first: the block size lookup is the expensive part
+// and the hooks in serin_alloc_hooks run these for every allocation.
+void* trackedMalloc(size_t size) {
+    void* ptr = std::malloc(size ? size : 1);
+    if (ptr && enabled.load(std::memory_order_relaxed)) {
+        recordAllocation(SERIN_BLOCK_SIZE(ptr));
+    }
+    return ptr;
+}
+
+void trackedFree(void* ptr) {
+    if (ptr && enabled.load(std::memory_order_relaxed)) {
+        recordRelease(SERIN_BLOCK_SIZE(ptr));
+    }
+    std::free(ptr);
+}
+
+void* yyjsonMalloc(void*, size_t size) {
+    return trackedMalloc(size);
+}
+
+void* yyjsonRealloc(void*, void* ptr, size_t, size_t size) {
+    if (!enabled.load(std::memory_order_relaxed)) {
+        return std::realloc(ptr, size);
+    }
+    const size_t before = ptr ? SERIN_BLOCK_SIZE(ptr) : 0;
+    void* grown = std::realloc(ptr, size);
+    if (grown) {
+        recordRelease(before);
+        recordAllocation(SERIN_BLOCK_SIZE(grown));
+    }
+    return grown;
+}
+
+void yyjsonFree(void*, void* ptr) {
+    trackedFree(ptr);
+}
+
+const yyjson_alc TRACKED_ALC = {yyjsonMalloc, yyjsonRealloc, yyjsonFree, nullptr};
+
+#endif
+
+} // namespace
+
+namespace detail {
+
+PhaseScope::PhaseScope(Phase phase, size_t bytes) : phase_(phase), previous_(currentPhase), bytes_(bytes) {
+    currentPhase = phase;
+    if (tracing()) {
+        traced_ = true;
+        start_ = traceClock();
+    }
+}
+
+PhaseScope::~PhaseScope() {
+    currentPhase = previous_;
+    if (traced_) {
+        traceEvent(phase_, start_, bytes_);
+    }
+}
+
+void installCounting() {
+#ifdef SERIN_BLOCK_SIZE
+    installed.store(true, std::memory_order_relaxed);
+#endif
+}
+
+void* countedMalloc(size_t size) {
+#ifdef SERIN_BLOCK_SIZE
+    return trackedMalloc(size);
+#else
+    return std::malloc(size ? size : 1);
+#endif
+}
+
+void countedFree(void* ptr) {
+#ifdef SERIN_BLOCK_SIZE
+    trackedFree(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+// Documents read or written while counting is off keep yyjson's own
+// allocator, so a disabled build pays nothing per block.
+const yyjson_alc* trackedAllocator(const yyjson_alc* alc) {
+#ifdef SERIN_BLOCK_SIZE
+    return alc || !enabled.load(std::memory_order_relaxed) ? alc : &TRACKED_ALC;
+#else
+    return alc;
+#endif
+}
+
+} // namespace detail
+
+const char* phaseName(Phase phase) {
+    static const char* const names[PHASE_COUNT] = {"read", "parse", "build", "emit", "write", "other"};
+    return names[static_cast<size_t>(phase)];
+}
+
+bool memoryStatsAvailable() {
+    return installed.load(std::memory_order_relaxed);
+}
+
+void enableMemoryStats(bool enable) {
+    enabled.store(enable && memoryStatsAvailable(), std::memory_order_relaxed);
+}
+
+void resetMemoryStats() {
+    liveBytes.store(0, std::memory_order_relaxed);
+    peakBytes.store(0, std::memory_order_relaxed);
+    for (auto& phase : phases) {
+        phase.allocations.store(0, std::memory_order_relaxed);
+        phase.bytes.store(0, std::memory_order_relaxed);
+        phase.peak.store(0, std::memory_order_relaxed);
+    }
+}
+
+MemoryStats memoryStats() {
+    auto clamp = [](int64_t value) { return value > 0 ? static_cast<size_t>(value) : size_t{0}; };
+    MemoryStats stats;
+    for (size_t i = 0; i < PHASE_COUNT; ++i) {
+        auto& phase = stats.phases[i];
+        phase.allocations = phases[i].allocations.load(std::memory_order_relaxed);
+        phase.bytes = phases[i].bytes.load(std::memory_order_relaxed);
+        phase.peakBytes = clamp(phases[i].peak.load(std::memory_order_relaxed));
+        stats.allocations += phase.allocations;
+        stats.bytes += phase.bytes;
+    }
+    stats.liveBytes = clamp(liveBytes.load(std::memory_order_relaxed));
+    stats.peakBytes = clamp(peakBytes.load(std::memory_order_relaxed));
+    return stats;
+}
+
+NodeOverhead nodeOverhead() {
+    NodeOverhead overhead;
+    overhead.value = sizeof(Value);
+    overhead.object = sizeof(Object);
+    overhead.array = sizeof(Array);
+    // Members live in a deque of pairs, indexed by a table of 8-byte buckets
+    // kept at most 75% full.
+    overhead.objectMember = sizeof(Object::value_type) + 2 * sizeof(uint32_t) * 4 / 3;
+    overhead.arrayItem = sizeof(Value);
+    overhead.inlineString = std::string().capacity();
+    return overhead;
+}
+
+} // namespace serin
@@ -0,0 +1,557 @@
+#include "serin.h"
+#include "serin_internal.h"
+
+#include <cctype>
+#include <charconv>
+#include <stdexcept>
+
+namespace serin {
+
+namespace {
+
+using Step = Path::Step;
+using FilterOp = Path::FilterOp;
+
+size_t hashKey(const std::string& key) {
+    return Object::hasher()(key);
+}
+
+Step makeKeyStep(std::string key) {
+    Step step;
+    step.kind = Step::Kind::Key;
+    step.hash = hashKey(key);
+    step.key = std::move(key);
+    return step;
+}
+
+std::runtime_error invalidPath(std::string_view expression, const std::string& reason) {
+    return std::runtime_error("Invalid path expression '" + std::string(expression) + "': " + reason);
+}
+
+bool parseInteger(std::string_view text, int64_t& value) {
+    if (text.empty()) {
+        return false;
+    }
+    const char* begin = text.data();
+    const char* end = text.data() + text.size();
+    const auto result = std::from_chars(begin, end, value);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+// Parses "start:end[:step]" with optional bounds into `step`.
+bool parseSlice(std::string_view text, Step& step) {
+    const size_t firstColon = text.find(':');
+    if (firstColon == std::string_view::npos) {
+        return false;
+    }
+    const std::string_view startText = text.substr(0, firstColon);
+    std::string_view endText = text.substr(firstColon + 1);
+    std::string_view stepText;
+    const size_t secondColon = endText.find(':');
+    if (secondColon != std::string_view::npos) {
+        stepText = endText.substr(secondColon + 1);
+        endText = endText.substr(0, secondColon);
+    }
+
+    int64_t number = 0;
+    if (!startText.empty()) {
+        if (!parseInteger(startText, number)) return false;
+        step.start = number;
+    }
+    if (!endText.empty()) {
+        if (!parseInteger(endText, number)) return false;
+        step.end = number;
+    }
+    if (!stepText.empty()) {
+        if (!parseInteger(stepText, number) || number == 0) return false;
+        step.step = number;
+    }
+    step.kind = Step::Kind::Slice;
+    return true;
+}
+
+// ---------------------
+// JSON Pointer (RFC 6901) with `*` and slice segments
+// ---------------------
+
+std::vector<Step> compilePointer(std::string_view expression) {
+    std::vector<Step> steps;
+    size_t pos = 0;
+    while (pos < expression.size()) {
+        // Every segment starts with '/'
+        size_t next = expression.find('/', pos + 1);
+        if (next == std::string_view::npos) {
+            next = expression.size();
+        }
+        const std::string_view raw = expression.substr(pos + 1, next - pos - 1);
+        pos = next;
+
+        std::string segment;
+        segment.reserve(raw.size());
+        for (size_t i = 0; i < raw.size(); ++i) {
+            if (raw[i] == '~' && i + 1 < raw.size() && (raw[i + 1] == '0' || raw[i + 1] == '1')) {
+                segment += raw[i + 1] == '0' ? '~' : '/';
+                ++i;
+            } else if (raw[i] == '~') {
+                throw invalidPath(expression, "bad escape in segment '" + std::string(raw) + "'");
+            } else {
+                segment += raw[i];
+            }
+        }
+
+        if (segment == "*") {
+            Step step;
+            step.kind = Step::Kind::Wildcard;
+            steps.push_back(std::move(step));
+            continue;
+        }
+
+        Step step = makeKeyStep(segment);
+        int64_t index = 0;
+        if (!segment.empty() && segment[0] != '+' && parseInteger(segment, index)) {
+            step.kind = Step::Kind::Index;
+            step.index = index;
+        } else {
+            parseSlice(segment, step);
+        }
+        steps.push_back(std::move(step));
+    }
+    return steps;
+}
+
+// ---------------------
+// JSONPath subset
+// ---------------------
+
+class JsonPathCompiler {
+public:
+    explicit JsonPathCompiler(std::string_view expression) : expression_(expression) {}
+
+    std::vector<Step> compile() {
+        if (peek() == '$') {
+            ++pos_;
+        } else if (!atEnd() && peek() != '.' && peek() != '[') {
+            // Relative form: "a.b[0]"
+            steps_.push_back(makeKeyStep(readName()));
+        }
+
+        while (!atEnd()) {
+            const char c = expression_[pos_++];
+            if (c == '.') {
+                if (peek() == '.') {
+                    throw error("recursive descent is not supported");
+                }
+                if (peek() == '*') {
+                    ++pos_;
+                    Step step;
+                    step.kind = Step::Kind::Wildcard;
+                    steps_.push_back(std::move(step));
+                } else {
+                    steps_.push_back(makeKeyStep(readName()));
+                }
+            } else if (c == '[') {
+                steps_.push_back(readSelector());
+                expect(']');
+            } else {
+                throw error(std::string("unexpected '") + c + "'");
+            }
+        }
+        return std::move(steps_);
+    }
+
+private:
+    bool atEnd() const { return pos_ >= expression_.size(); }
+    char peek() const { return atEnd() ? '\0' : expression_[pos_]; }
+
+    std::runtime_error error(const std::string& reason) const {
+        return invalidPath(expression_, reason + " at offset " + std::to_string(pos_));
+    }
+
+    void skipSpaces() {
+        while (!atEnd() && std::isspace(static_cast<unsigned char>(peek()))) {
+            ++pos_;
+        }
+    }
+
+    void expect(char c) {
+        skipSpaces();
+        if (peek() != c) {
+            throw error(std::string("expected '") + c + "'");
+        }
+        ++pos_;
+    }
+
+    std::string readName() {
+        const size_t begin = pos_;
+        while (!atEnd() && peek() != '.' && peek() != '[' && peek() != ']' &&
+               !std::isspace(static_cast<unsigned char>(peek())) &&
+               peek() != '=' && peek() != '!' && peek() != '<' && peek() != '>' && peek() != ')') {
+            ++pos_;
+        }
+        if (pos_ == begin) {
+            throw error("expected a member name");
+        }
+        return std::string(expression_.substr(begin, pos_ - begin));
+    }
+
+    std::string readQuoted() {
+        const char quote = expression_[pos_++];
+        std::string text;
+        while (!atEnd() && peek() != quote) {
+            char c = expression_[pos_++];
+            if (c == '\\' && !atEnd()) {
+                c = expression_[pos_++];
+            }
+            text += c;
+        }
+        if (atEnd()) {
+            throw error("unterminated string");
+        }
+        ++pos_;
+        return text;
+    }
+
+    Step readSelector() {
+        skipSpaces();
+        if (peek() == '*') {
+            ++pos_;
+            Step step;
+            step.kind = Step::Kind::Wildcard;
+            return step;
+        }
+        if (peek() == '\'' || peek() == '"') {
+            return makeKeyStep(readQuoted());
+        }
+        if (peek() == '?') {
+            ++pos_;
+            return readFilter();
+        }
+
+        const size_t begin = pos_;
+        while (!atEnd() && peek() != ']') {
+            ++pos_;
+        }
+        std::string_view text = expression_.substr(begin, pos_ - begin);
+        while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) {
+            text.remove_suffix(1);
+        }
+
+        Step step;
+        if (parseInteger(text, step.index)) {
+            step.kind = Step::Kind::Index;
+            return step;
+        }
+        if (parseSlice(text, step)) {
+            return step;
+        }
+        throw error("invalid selector '" + std::string(text) + "'");
+    }
+
+    // ?(@.a.b op literal) or ?@.a.b op literal
+    Step readFilter() {
+        Step step;
+        step.kind = Step::Kind::Filter;
+
+        skipSpaces();
+        const bool parenthesized = peek() == '(';
+        if (parenthesized) {
+            ++pos_;
+        }
+        expect('@');
+        while (peek() == '.' || peek() == '[') {
+            std::string key;
+            if (expression_[pos_++] == '.') {
+                key = readName();
+            } else {
+                skipSpaces();
+                if (peek() != '\'' && peek() != '"') {
+                    throw error("filters only support member names");
+                }
+                key = readQuoted();
+                expect(']');
+            }
+            const size_t hash = hashKey(key);
+            step.filterKeys.emplace_back(std::move(key), hash);
+        }
+
+        skipSpaces();
+        step.op = readOperator();
+        if (step.op != FilterOp::Exists) {
+            skipSpaces();
+            step.literal = readLiteral();
+        }
+        if (parenthesized) {
+            expect(')');
+        }
+        return step;
+    }
+
+    FilterOp readOperator() {
+        const std::string_view rest = expression_.substr(pos_);
+        static const std::pair<std::string_view, FilterOp> operators[] = {
+            {"==", FilterOp::Equal}, {"!=", FilterOp::NotEqual},
+            {"<=", FilterOp::LessEqual}, {">=", FilterOp::GreaterEqual},
+            {"<", FilterOp::Less}, {">", FilterOp::Greater},
+        };
+        for (const auto& [text, op] : operators) {
+            if (rest.substr(0, text.size()) == text) {
+                pos_ += text.size();
+                return op;
+            }
+        }
+        return FilterOp::Exists;
+    }
+
+    Primitive readLiteral() {
+        if (peek() == '\'' || peek() == '"') {
+            return Primitive(readQuoted());
+        }
+        const size_t begin = pos_;
+        while (!atEnd() && peek() != ')' && peek() != ']' && !std::isspace(static_cast<unsigned char>(peek()))) {
+            ++pos_;
+        }
+        const std::string_view text = expression_.substr(begin, pos_ - begin);
+        if (text == "true") return Primitive(true);
+        if (text == "false") return Primitive(false);
+        if (text == "null") return Primitive(nullptr);
+
+        int64_t integer = 0;
+        if (parseInteger(text, integer)) {
+            return Primitive(integer);
+        }
+        double number = 0;
+        const auto result = std::from_chars(text.data(), text.data() + text.size(), number);
+        if (!text.empty() && result.ec == std::errc() && result.ptr == text.data() + text.size()) {
+            return Primitive(number);
+        }
+        throw error("invalid literal '" + std::string(text) + "'");
+    }
+
+    std::string_view expression_;
+    size_t pos_ = 0;
+    std::vector<Step> steps_;
+};
+
+// ---------------------
+// Evaluation
+// ---------------------
+
+const Value* findMember(const Value& node, const std::string& key, size_t hash) {
+    if (!node.isObject()) {
+        return nullptr;
+    }
+    const Object& obj = node.asObject();
+    const auto it = obj.find(key, hash);
+    return it == obj.end() ? nullptr : &it->second;
+}
+
+bool resolveIndex(int64_t index, size_t size, size_t& position) {
+    const int64_t length = static_cast<int64_t>(size);
+    if (index < 0) {
+        index += length;
+    }
+    if (index < 0 || index >= length) {
+        return false;
+    }
+    position = static_cast<size_t>(index);
+    return true;
+}
+
+int compareNumbers(double left, double right) {
+    return left < right ? -1 : (left > right ? 1 : 0);
+}
+
+bool matchesFilter(const Step& step, const Value& candidate) {
+    const Value* target = &candidate;
+    for (const auto& [key, hash] : step.filterKeys) {
+        target = findMember(*target, key, hash);
+        if (!target) {
+            return false;
+        }
+    }
+    if (step.op == FilterOp::Exists) {
+        return true;
+    }
+    if (!target->isPrimitive()) {
+        return false;
+    }
+
+    return detail::compareFilter(target->asPrimitive(), step.op, step.literal);
+}
+
+void applySlice(const Step& step, const Array& array, std::vector<const Value*>& out) {
+    const int64_t length = static_cast<int64_t>(array.size());
+    auto clamp = [length](int64_t value, int64_t low, int64_t high) {
+        if (value < 0) value += length;
+        return value < low ? low : (value > high ? high : value);
+    };
+
+    if (step.step > 0) {
+        const int64_t begin = step.start ? clamp(*step.start, 0, length) : 0;
+        const int64_t end = step.end ? clamp(*step.end, 0, length) : length;
+        // Compare the stride with the distance left instead of adding it
+        // first: `i + step` can overflow for steps near INT64_MAX.
+        for (int64_t i = begin; i < end; i += step.step) {
+            out.push_back(&array[static_cast<size_t>(i)]);
+            if (step.step >= end - i) {
+                break;
+            }
+        }
+    } else {
+        const int64_t begin = step.start ? clamp(*step.start, -1, length - 1) : length - 1;
+        const int64_t end = step.end ? clamp(*step.end, -1, length - 1) : -1;
+        for (int64_t i = begin; i > end; i += step.step) {
+            out.push_back(&array[static_cast<size_t>(i)]);
+            if (step.step <= end - i) {
+                break;
+            }
+        }
+    }
+}
+
+// Child selected by a Key or Index step, or nullptr.
+const Value* selectOne(const Step& step, const Value& node) {
+    if (step.kind == Step::Kind::Index && node.isArray()) {
+        size_t position = 0;
+        return resolveIndex(step.index, node.asArray().size(), position) ? &node.asArray()[position] : nullptr;
+    }
+    return step.key.empty() && step.kind != Step::Kind::Key ? nullptr : findMember(node, step.key, step.hash);
+}
+
+void applyStep(const Step& step, const Value& node, std::vector<const Value*>& out) {
+    switch (step.kind) {
+        case Step::Kind::Key:
+        case Step::Kind::Index:
+            if (const Value* child = selectOne(step, node)) {
+                out.push_back(child);
+            }
+            return;
+        case Step::Kind::Slice:
+            if (node.isArray()) {
+                applySlice(step, node.asArray(), out);
+            } else if (const Value* member = step.key.empty() ? nullptr : findMember(node, step.key, step.hash)) {
+                out.push_back(member);
+            }
+            return;
+        case Step::Kind::Wildcard:
+        case Step::Kind::Filter:
+            if (node.isArray()) {
+                for (const Value& item : node.asArray()) {
+                    if (step.kind == Step::Kind::Wildcard || matchesFilter(step, item)) {
+                        out.push_back(&item);
+                    }
+                }
+            } else if (node.isObject()) {
+                for (const auto& [key, item] : node.asObject()) {
+                    if (step.kind == Step::Kind::Wildcard || matchesFilter(step, item)) {
+                        out.push_back(&item);
+                    }
+                }
+            }
+            return;
+    }
+}
+
+} // namespace
+
+namespace detail {
+
+bool compareFilter(const Primitive& value, FilterOp op, const Primitive& literal) {
+    int order = 0;
+    if (value.isNumber() && literal.isNumber()) {
+        if (value.isInt() && literal.isInt()) {
+            order = value.getInt() < literal.getInt() ? -1 : (value.getInt() > literal.getInt() ? 1 : 0);
+        } else {
+            order = compareNumbers(value.getNumber(), literal.getNumber());
+        }
+    } else if (value.isString() && literal.isString()) {
+        order = value.getString().compare(literal.getString());
+        order = order < 0 ? -1 : (order > 0 ? 1 : 0);
+    } else if (op == FilterOp::Equal || op == FilterOp::NotEqual) {
+        const bool equal = static_cast<const Primitive::Base&>(value) == static_cast<const Primitive::Base&>(literal);
+        return equal == (op == FilterOp::Equal);
+    } else {
+        return false;
+    }
+    return orderSatisfies(order, op);
+}
+
+bool orderSatisfies(int order, FilterOp op) {
+    switch (op) {
+        case FilterOp::Equal: return order == 0;
+        case FilterOp::NotEqual: return order != 0;
+        case FilterOp::Less: return order < 0;
+        case FilterOp::LessEqual: return order <= 0;
+        case FilterOp::Greater: return order > 0;
+        case FilterOp::GreaterEqual: return order >= 0;
+        default: return false;
+    }
+}
+
+} // namespace detail
+
+Path::Path(std::string_view expression) : expression_(expression) {
+    if (expression.empty() || expression.front() == '/') {
+        steps_ = compilePointer(expression);
+    } else {
+        steps_ = JsonPathCompiler(expression).compile();
+    }
+}
+
+bool Path::isSingular() const {
+    for (const Step& step : steps_) {
+        if (step.kind != Step::Kind::Key && step.kind != Step::Kind::Index) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<const Value*> Path::evaluate(const Value& root) const {
+    std::vector<const Value*> current{&root};
+    std::vector<const Value*> next;
+    for (const Step& step : steps_) {
+        next.clear();
+        for (const Value* node : current) {
+            applyStep(step, *node, next);
+        }
+        current.swap(next);
+        if (current.empty()) {
+            break;
+        }
+    }
+    return current;
+}
+
+std::vector<Value*> Path::evaluate(Value& root) const {
+    const auto matches = evaluate(static_cast<const Value&>(root));
+    std::vector<Value*> result;
+    result.reserve(matches.size());
+    for (const Value* match : matches) {
+        result.push_back(const_cast<Value*>(match));
+    }
+    return result;
+}
+
+const Value* Path::find(const Value& root) const {
+    if (!isSingular()) {
+        const auto matches = evaluate(root);
+        return matches.empty() ? nullptr : matches.front();
+    }
+
+    // Key and index steps select at most one child: walk without buffers
+    const Value* node = &root;
+    for (const Step& step : steps_) {
+        node = selectOne(step, *node);
+        if (!node) {
+            return nullptr;
+        }
+    }
+    return node;
+}
+
+Value* Path::find(Value& root) const {
+    return const_cast<Value*>(find(static_cast<const Value&>(root)));
+}
+
+} // namespace serin
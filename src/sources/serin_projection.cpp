@@ -0,0 +1,258 @@
+#include "serin.h"
+#include "serin_internal.h"
+#include "utils.h"
+
+#include <deque>
+#include <stdexcept>
+
+namespace serin {
+
+namespace {
+
+using Step = Path::Step;
+
+bool sameStep(const Step& left, const Step& right) {
+    return left.kind == right.kind && left.key == right.key && left.index == right.index &&
+           left.start == right.start && left.end == right.end && left.step == right.step;
+}
+
+bool sliceContains(const Step& step, size_t index, size_t length) {
+    const int64_t position = static_cast<int64_t>(index);
+    const int64_t size = static_cast<int64_t>(length);
+    auto clamp = [size](int64_t value, int64_t low, int64_t high) {
+        if (value < 0) value += size;
+        return value < low ? low : (value > high ? high : value);
+    };
+
+    if (step.step > 0) {
+        const int64_t begin = step.start ? clamp(*step.start, 0, size) : 0;
+        const int64_t end = step.end ? clamp(*step.end, 0, size) : size;
+        return position >= begin && position < end && (position - begin) % step.step == 0;
+    }
+    const int64_t begin = step.start ? clamp(*step.start, -1, size - 1) : size - 1;
+    const int64_t end = step.end ? clamp(*step.end, -1, size - 1) : -1;
+    return position <= begin && position > end && (begin - position) % (-step.step) == 0;
+}
+
+// Adds `child` to `out`; returns true when it keeps the whole subtree.
+bool collect(const detail::ProjectionNode& child, detail::ProjectionSet& out) {
+    if (child.keep) {
+        return true;
+    }
+    out.push_back(&child);
+    return false;
+}
+
+} // namespace
+
+namespace detail {
+
+bool matchMember(const ProjectionSet& nodes, std::string_view key, ProjectionSet& out) {
+    out.clear();
+    for (const ProjectionNode* node : nodes) {
+        for (const auto& [step, child] : node->children) {
+            bool matches = false;
+            switch (step.kind) {
+                case Step::Kind::Wildcard:
+                    matches = true;
+                    break;
+                case Step::Kind::Key:
+                case Step::Kind::Index:
+                case Step::Kind::Slice:
+                    // Index and slice steps from JSON Pointer segments also name members
+                    matches = (step.kind == Step::Kind::Key || !step.key.empty()) && step.key == key;
+                    break;
+                case Step::Kind::Filter:
+                    break;
+            }
+            if (matches && collect(*child, out)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool matchItem(const ProjectionSet& nodes, size_t index, size_t length, ProjectionSet& out) {
+    out.clear();
+    for (const ProjectionNode* node : nodes) {
+        for (const auto& [step, child] : node->children) {
+            bool matches = false;
+            switch (step.kind) {
+                case Step::Kind::Wildcard:
+                    matches = true;
+                    break;
+                case Step::Kind::Index: {
+                    const int64_t position = step.index < 0 ? step.index + static_cast<int64_t>(length) : step.index;
+                    matches = position == static_cast<int64_t>(index);
+                    break;
+                }
+                case Step::Kind::Slice:
+                    matches = sliceContains(step, index, length);
+                    break;
+                case Step::Kind::Key:
+                case Step::Kind::Filter:
+                    break;
+            }
+            if (matches && collect(*child, out)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool needsLength(const ProjectionSet& nodes) {
+    for (const ProjectionNode* node : nodes) {
+        for (const auto& [step, child] : node->children) {
+            if (step.kind == Step::Kind::Index && step.index < 0) {
+                return true;
+            }
+            if (step.kind == Step::Kind::Slice &&
+                (step.step < 0 || (step.start && *step.start < 0) || (step.end && *step.end < 0))) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+} // namespace detail
+
+// =====================
+// Projection
+// =====================
+
+Projection::Projection() : root_(std::make_shared<detail::ProjectionNode>()) {}
+
+Projection::Projection(std::initializer_list<std::string_view> paths) : Projection() {
+    for (std::string_view path : paths) {
+        add(path);
+    }
+}
+
+void Projection::add(std::string_view path) {
+    add(Path(path));
+}
+
+void Projection::add(const Path& path) {
+    detail::ProjectionNode* node = root_.get();
+    for (const Step& step : path.steps()) {
+        if (step.kind == Step::Kind::Filter) {
+            throw std::runtime_error("Projection paths cannot contain filters: " + path.expression());
+        }
+        detail::ProjectionNode* next = nullptr;
+        for (auto& [existing, child] : node->children) {
+            if (sameStep(existing, step)) {
+                next = child.get();
+                break;
+            }
+        }
+        if (!next) {
+            node->children.emplace_back(step, std::make_unique<detail::ProjectionNode>());
+            next = node->children.back().second.get();
+        }
+        node = next;
+    }
+    node->keep = true;
+}
+
+// =====================
+// Projected loading
+// =====================
+
+Value project(const Value& value, const Projection& projection) {
+    const detail::ProjectionNode& root = projection.root();
+    if (root.keep) {
+        return value;
+    }
+
+    struct Frame {
+        const Value* source;
+        Value* target;
+        const detail::ProjectionSet* nodes;
+        size_t index;
+    };
+
+    const size_t maxDepth = getMaxDepth();
+    std::deque<detail::ProjectionSet> sets{{&root}};
+    std::vector<Frame> stack;
+    detail::ProjectionSet matched;
+
+    Value result;
+    auto open = [&](const Value& source, Value& target, detail::ProjectionSet&& nodes) {
+        checkDepth(stack.size() + 1, maxDepth);
+        target = source.isArray() ? Value(Array{}) : Value(Object{});
+        sets.push_back(std::move(nodes));
+        stack.push_back(Frame{&source, &target, &sets.back(), 0});
+    };
+    if (!value.isPrimitive()) {
+        open(value, result, detail::ProjectionSet{&root});
+    }
+
+    while (!stack.empty()) {
+        Frame& frame = stack.back();
+        const size_t index = frame.index++;
+        const Value& source = *frame.source;
+        Value& target = *frame.target;
+
+        if (source.isArray()) {
+            const Array& items = source.asArray();
+            if (index == items.size()) {
+                stack.pop_back();
+                continue;
+            }
+            if (detail::matchItem(*frame.nodes, index, items.size(), matched)) {
+                target.asArray().push_back(items[index]);
+            } else if (!matched.empty() && !items[index].isPrimitive()) {
+                Value& slot = target.asArray().emplace_back();
+                open(items[index], slot, std::move(matched));
+            }
+            continue;
+        }
+
+        const Object& members = source.asObject();
+        if (index == members.size()) {
+            stack.pop_back();
+            continue;
+        }
+        const auto& [key, child] = members.values_container()[index];
+        if (detail::matchMember(*frame.nodes, key, matched)) {
+            target.asObject()[key] = child;
+        } else if (!matched.empty() && !child.isPrimitive()) {
+            Value& slot = target.asObject()[key];
+            open(child, slot, std::move(matched));
+        }
+    }
+
+    return result;
+}
+
+Value loads(const std::string& content, Type format, const Projection& projection) {
+    switch (format) {
+        case Type::JSON:
+            return detail::parseJson(content, nullptr, getMaxDepth(), &projection.root());
+        case Type::YAML: {
+            std::vector<detail::YamlLine> lines;
+            return detail::parseYaml(content, lines, getMaxDepth(), &projection.root());
+        }
+        case Type::TOON:
+            // The TOON decoder does not build nested structure, so filter afterwards
+            return project(loadsToon(content), projection);
+        case Type::SERIN_BIN:
+            return project(loadsBinary(content), projection);
+        default:
+            throw std::runtime_error("Unsupported format type");
+    }
+}
+
+Value load(const std::string& filename, const Projection& projection) {
+    const Type format = detail::typeFromFilename(filename);
+    if (format == Type::UNKOWN) {
+        // Let the generic loader report the unsupported extension
+        return project(load(filename), projection);
+    }
+    return loads(readStringFromFile(filename), format, projection);
+}
+
+} // namespace serin
@@ -0,0 +1,541 @@
+#include "serin.h"
+#include "serin_internal.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace serin {
+
+namespace {
+
+constexpr size_t DEFAULT_JSON_CAPACITY = 64 * 1024;
+
+bool isBlank(std::string_view text) {
+    for (char c : text) {
+        if (c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+std::runtime_error jsonError(size_t offset, const std::string& message) {
+    return std::runtime_error("Invalid JSON at offset " + std::to_string(offset) + ": " + message);
+}
+
+// Incremental JSON reader. A root array or object is cut into its items or
+// members by scanning for the end of each one, as convertStream's JsonSource
+// does, and each is parsed on its own as soon as its last byte arrives; only
+// the unfinished entry stays buffered. The scan resumes where the previous
+// chunk stopped. A scalar root may continue in the next chunk ("12" then
+// "3"), so it is only parsed once the input is complete.
+class JsonStream {
+public:
+    enum class Shape { Unknown, Array, Object, Scalar };
+
+    JsonStream(size_t sizeHint, size_t maxDepth) : maxDepth_(maxDepth) {
+        buffer_.reserve(std::min(sizeHint, DEFAULT_JSON_CAPACITY));
+    }
+
+    Shape shape() const { return shape_; }
+
+    // Calls `emit(key, value)` for every entry the data completes.
+    template <typename Emit>
+    void feed(const char* data, size_t size, Emit&& emit) {
+        buffer_.append(data, size);
+        if (shape_ != Shape::Scalar) {
+            scan(emit);
+        }
+        compact();
+    }
+
+    // The root value of a scalar document; checks that a container was closed.
+    Value finish() {
+        if (shape_ == Shape::Scalar || shape_ == Shape::Unknown) {
+            return parse(0, buffer_.size(), maxDepth_);
+        }
+        if (state_ != State::Done) {
+            throw jsonError(base_ + buffer_.size(), "unexpected end of data");
+        }
+        return Value();
+    }
+
+    void reset() {
+        buffer_.clear();
+        base_ = pos_ = 0;
+        shape_ = Shape::Unknown;
+        state_ = State::Start;
+        valueStart_ = NONE;
+    }
+
+private:
+    static constexpr size_t NONE = static_cast<size_t>(-1);
+
+    // Where the scan stands between tokens of the root container.
+    enum class State { Start, First, Next, Key, Colon, Value, Done };
+
+    template <typename Emit>
+    void scan(Emit& emit) {
+        for (;;) {
+            if (valueStart_ == NONE && !token()) {
+                return;
+            }
+            if (valueStart_ == NONE) {
+                continue;
+            }
+            size_t end = 0;
+            if (!valueEnd(end)) {
+                return;
+            }
+            emit(std::move(key_), parse(valueStart_, end, maxDepth_ - 1));
+            key_.clear();
+            pos_ = end;
+            valueStart_ = NONE;
+            state_ = State::Next;
+        }
+    }
+
+    // Consumes one structural token. False when more data is needed.
+    bool token() {
+        while (pos_ < buffer_.size() && isSpace(buffer_[pos_])) {
+            ++pos_;
+        }
+        if (pos_ == buffer_.size()) {
+            return false;
+        }
+        const char c = buffer_[pos_];
+        switch (state_) {
+            case State::Start:
+                if (c != '[' && c != '{') {
+                    shape_ = Shape::Scalar;
+                    return false;
+                }
+                checkDepth(1, maxDepth_);
+                shape_ = c == '[' ? Shape::Array : Shape::Object;
+                state_ = State::First;
+                ++pos_;
+                return true;
+            case State::First:
+            case State::Next: {
+                const State entry = shape_ == Shape::Array ? State::Value : State::Key;
+                if (c == (shape_ == Shape::Array ? ']' : '}')) {
+                    state_ = State::Done;
+                    ++pos_;
+                } else if (state_ == State::First) {
+                    state_ = entry;
+                } else if (c == ',') {
+                    state_ = entry;
+                    ++pos_;
+                } else {
+                    throw unexpected(c);
+                }
+                return true;
+            }
+            case State::Key: {
+                if (c != '"') {
+                    throw unexpected(c);
+                }
+                const size_t end = stringEnd(pos_);
+                if (end == NONE) {
+                    return false;
+                }
+                const std::string_view name(buffer_.data() + pos_ + 1, end - pos_ - 2);
+                if (name.find('\\') == std::string_view::npos) {
+                    key_.assign(name);
+                } else {
+                    key_ = parse(pos_, end, 0).asPrimitive().getString();
+                }
+                pos_ = end;
+                state_ = State::Colon;
+                return true;
+            }
+            case State::Colon:
+                if (c != ':') {
+                    throw unexpected(c);
+                }
+                ++pos_;
+                state_ = State::Value;
+                return true;
+            case State::Value:
+                valueStart_ = pos_;
+                depth_ = 0;
+                inString_ = escaped_ = false;
+                return true;
+            case State::Done:
+                throw jsonError(base_ + pos_, "unexpected content after document");
+        }
+        return false;
+    }
+
+    // Scans the value that starts at valueStart_ from where the last call
+    // stopped. True with `end` set once the value is complete.
+    bool valueEnd(size_t& end) {
+        for (; pos_ < buffer_.size(); ++pos_) {
+            const char c = buffer_[pos_];
+            if (inString_) {
+                if (escaped_) {
+                    escaped_ = false;
+                } else if (c == '\\') {
+                    escaped_ = true;
+                } else if (c == '"') {
+                    inString_ = false;
+                    if (depth_ == 0) {
+                        end = pos_ + 1;
+                        return true;
+                    }
+                }
+                continue;
+            }
+            switch (c) {
+                case '"':
+                    inString_ = true;
+                    break;
+                case '[':
+                case '{':
+                    ++depth_;
+                    break;
+                case ']':
+                case '}':
+                    if (depth_ == 0) {
+                        end = pos_; // a bare scalar closed by the root's bracket
+                        return true;
+                    }
+                    if (--depth_ == 0) {
+                        end = pos_ + 1;
+                        return true;
+                    }
+                    break;
+                case ',':
+                    if (depth_ == 0) {
+                        end = pos_;
+                        return true;
+                    }
+                    break;
+                default:
+                    if (depth_ == 0 && isSpace(c)) {
+                        end = pos_;
+                        return true;
+                    }
+                    break;
+            }
+        }
+        return false;
+    }
+
+    // Position just past the string starting at `pos`, or NONE if it has not
+    // arrived yet.
+    size_t stringEnd(size_t pos) const {
+        for (size_t i = pos + 1; i < buffer_.size(); ++i) {
+            if (buffer_[i] == '\\') {
+                ++i;
+            } else if (buffer_[i] == '"') {
+                return i + 1;
+            }
+        }
+        return NONE;
+    }
+
+    Value parse(size_t begin, size_t end, size_t maxDepth) {
+        yyjson_read_err err;
+        yyjson_doc* doc = nullptr;
+        {
+            detail::PhaseScope phase(Phase::Parse, end - begin);
+            doc = yyjson_read_opts(buffer_.data() + begin, end - begin, 0, detail::trackedAllocator(nullptr), &err);
+        }
+        if (!doc) {
+            throw jsonError(base_ + begin + err.pos, err.msg);
+        }
+        std::unique_ptr<yyjson_doc, decltype(&yyjson_doc_free)> guard(doc, &yyjson_doc_free);
+        return detail::convertJson(yyjson_doc_get_root(doc), maxDepth);
+    }
+
+    std::runtime_error unexpected(char c) const {
+        return jsonError(base_ + pos_, std::string("unexpected character '") + c + "'");
+    }
+
+    // Drops the bytes before the unfinished entry.
+    void compact() {
+        const size_t keep = valueStart_ != NONE ? valueStart_ : shape_ == Shape::Scalar ? 0 : pos_;
+        if (keep > 0 && keep >= buffer_.size() / 2) {
+            buffer_.erase(0, keep);
+            base_ += keep;
+            pos_ -= keep;
+            if (valueStart_ != NONE) {
+                valueStart_ -= keep;
+            }
+        }
+    }
+
+    size_t maxDepth_;
+    std::string buffer_;
+    size_t base_ = 0; // document offset of buffer_[0]
+    size_t pos_ = 0;
+    Shape shape_ = Shape::Unknown;
+    State state_ = State::Start;
+    std::string key_;
+    // The value being scanned
+    size_t valueStart_ = NONE;
+    size_t depth_ = 0;
+    bool inString_ = false;
+    bool escaped_ = false;
+};
+
+} // namespace
+
+struct PushParser::Impl {
+    enum class Root { Unknown, Mapping, Sequence, Scalar };
+
+    Impl(Type format, Callback callback, size_t sizeHint)
+        : format(format), callback(std::move(callback)), json(sizeHint, maxDepth) {
+        if (format != Type::JSON && format != Type::YAML && format != Type::TOON) {
+            throw std::runtime_error("Unsupported format type");
+        }
+    }
+
+    void emit(std::string key, Value&& value) {
+        if (callback) {
+            entry.key = std::move(key);
+            entry.index = emitted++;
+            entry.value = std::move(value);
+            callback(entry);
+            return;
+        }
+        ++emitted;
+        if (root.isObject()) {
+            // Duplicate keys follow the loaders: loadsJson keeps the last
+            // value, loadsYaml the first
+            if (format == Type::JSON) {
+                root.asObject()[std::move(key)] = std::move(value);
+            } else {
+                root.asObject().emplace(std::move(key), std::move(value));
+            }
+        } else {
+            root.asArray().push_back(std::move(value));
+        }
+    }
+
+    // Emits the members or items of a finished container.
+    void emitChildren(Value&& value) {
+        if (value.isObject()) {
+            Object& members = value.asObject();
+            for (auto it = members.begin(); it != members.end(); ++it) {
+                emit(it->first, std::move(it.value()));
+            }
+        } else if (value.isArray()) {
+            for (Value& child : value.asArray()) {
+                emit(std::string(), std::move(child));
+            }
+        }
+    }
+
+    // ---------------------
+    // JSON
+    // ---------------------
+
+    void feedJson(const char* data, size_t size) {
+        json.feed(data, size, [this](std::string key, Value value) {
+            if (emitted == 0) {
+                root = json.shape() == JsonStream::Shape::Object ? Value(Object{}) : Value(Array{});
+            }
+            emit(std::move(key), std::move(value));
+        });
+    }
+
+    void finishJson() {
+        Value scalar = json.finish();
+        if (json.shape() == JsonStream::Shape::Object || json.shape() == JsonStream::Shape::Array) {
+            if (emitted == 0) {
+                root = json.shape() == JsonStream::Shape::Object ? Value(Object{}) : Value(Array{});
+            }
+        } else {
+            root = std::move(scalar);
+        }
+    }
+
+    // ---------------------
+    // YAML
+    // ---------------------
+
+    // Handles one complete line. A line at the root indent that starts a new
+    // member (or item) closes the entry buffered so far.
+    void yamlLine(std::string_view line) {
+        if (rootEnded) {
+            return;
+        }
+        size_t indent = 0;
+        while (indent < line.size() && line[indent] == ' ') {
+            ++indent;
+        }
+        const std::string_view text = line.substr(indent);
+        if (isBlank(text) || text.front() == '#') {
+            if (!pending.empty()) {
+                appendLine(line);
+            }
+            return;
+        }
+
+        // Same rule as the YAML loader: any line starting with '-' is a list item
+        const bool isItem = text.front() == '-';
+        if (rootKind == Root::Unknown) {
+            rootIndent = indent;
+            if (isItem) {
+                rootKind = Root::Sequence;
+                root = Value(Array{});
+            } else if (text.find(':') != std::string_view::npos) {
+                rootKind = Root::Mapping;
+                root = Value(Object{});
+            } else {
+                rootKind = Root::Scalar;
+            }
+        } else if (indent == rootIndent && !pending.empty()) {
+            const bool startsEntry = rootKind == Root::Sequence
+                                         ? isItem
+                                         : rootKind == Root::Mapping && !isItem &&
+                                               text.find(':') != std::string_view::npos;
+            if (startsEntry) {
+                flushYaml();
+                if (rootEnded) {
+                    return;
+                }
+            }
+        }
+        appendLine(line);
+    }
+
+    void appendLine(std::string_view line) {
+        pending.append(line);
+        pending += '\n';
+    }
+
+    void flushYaml() {
+        if (pending.empty()) {
+            return;
+        }
+        // A line at the root indent that starts no entry (or one indented
+        // less) ends the root block, as in loadsYaml: the entry parsed so far
+        // is kept and the rest of the document ignored.
+        bool complete = true;
+        Value parsed = detail::parseYaml(pending, lines, maxDepth, nullptr, &complete);
+        pending.clear();
+        rootEnded = !complete;
+        if (rootKind == Root::Scalar) {
+            root = std::move(parsed);
+        } else {
+            emitChildren(std::move(parsed));
+        }
+    }
+
+    void feedYaml(const char* data, size_t size) {
+        std::string_view chunk(data, size);
+        size_t newline = chunk.find('\n');
+        if (newline == std::string_view::npos) {
+            tail.append(chunk);
+            return;
+        }
+        // The first line may continue the tail left by the previous chunk
+        tail.append(chunk.substr(0, newline));
+        yamlLine(tail);
+        tail.clear();
+        chunk.remove_prefix(newline + 1);
+        while ((newline = chunk.find('\n')) != std::string_view::npos) {
+            yamlLine(chunk.substr(0, newline));
+            chunk.remove_prefix(newline + 1);
+        }
+        tail.assign(chunk);
+    }
+
+    // Parses what is still buffered into `root`.
+    void finishDocument() {
+        switch (format) {
+            case Type::JSON:
+                finishJson();
+                break;
+            case Type::YAML:
+                if (!tail.empty()) {
+                    yamlLine(tail);
+                    tail.clear();
+                }
+                flushYaml();
+                if (rootKind == Root::Unknown) {
+                    // Matches loadsYaml for empty input
+                    root = Value(nullptr);
+                }
+                break;
+            default:
+                root = detail::parseToon(pending, true);
+                break;
+        }
+    }
+
+    void reset() {
+        rootKind = Root::Unknown;
+        rootIndent = 0;
+        rootEnded = false;
+        root = Value();
+        pending.clear();
+        tail.clear();
+        emitted = 0;
+        json.reset();
+    }
+
+    Type format;
+    Callback callback;
+    size_t maxDepth = getMaxDepth();
+
+    Value root;
+    Entry entry;
+    size_t emitted = 0;
+
+    // YAML and TOON
+    Root rootKind = Root::Unknown;
+    size_t rootIndent = 0;
+    bool rootEnded = false;
+    std::string pending; // lines of the unfinished top-level entry (all input for TOON)
+    std::string tail;    // partial line at the end of the last chunk
+    std::vector<detail::YamlLine> lines;
+
+    // JSON
+    JsonStream json;
+};
+
+PushParser::PushParser(Type format, Callback callback, size_t sizeHint)
+    : impl_(std::make_unique<Impl>(format, std::move(callback), sizeHint)) {}
+
+PushParser::~PushParser() = default;
+PushParser::PushParser(PushParser&&) noexcept = default;
+PushParser& PushParser::operator=(PushParser&&) noexcept = default;
+
+void PushParser::feed(const char* data, size_t size) {
+    switch (impl_->format) {
+        case Type::JSON:
+            impl_->feedJson(data, size);
+            break;
+        case Type::YAML:
+            impl_->feedYaml(data, size);
+            break;
+        default:
+            impl_->pending.append(data, size);
+            break;
+    }
+}
+
+Value PushParser::finish() {
+    Impl& impl = *impl_;
+    try {
+        impl.finishDocument();
+    } catch (...) {
+        // The next document starts from a clean state either way
+        impl.reset();
+        throw;
+    }
+    Value result = std::move(impl.root);
+    impl.reset();
+    return result;
+}
+
+} // namespace serin
@@ -0,0 +1,409 @@
+#include "serin.h"
+#include "serin_internal.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace serin {
+
+namespace {
+
+using Scalar = detail::StructureSink::Scalar;
+
+// Output sizes of a node in each format.
+struct Cost {
+    size_t json = 0;
+    size_t yaml = 0;
+    size_t toon = 0;
+};
+
+size_t digits(size_t value) {
+    size_t count = 1;
+    while (value >= 10) {
+        value /= 10;
+        ++count;
+    }
+    return count;
+}
+
+// Builds DocumentStats from structure events. Output sizes are estimated
+// bottom-up: each container adds up its children with the indentation and
+// punctuation the writers put around them, and an array's TOON size depends
+// on the form (inline, table or list) its items turn out to allow.
+class StatsCollector : public detail::StructureSink {
+public:
+    explicit StatsCollector(DocumentStats& stats) : stats_(stats) {}
+
+    void beginObject() override { open(false); }
+    void beginArray() override { open(true); }
+
+    void key(std::string_view name) override {
+        ++keys_[name];
+        Frame& frame = frames_[depth_ - 1];
+        frame.key = name;
+        frame.keys.push_back(name);
+    }
+
+    void scalar(Scalar kind, std::string_view text) override {
+        switch (kind) {
+            case Scalar::Null: ++stats_.nulls; break;
+            case Scalar::Bool: ++stats_.booleans; break;
+            case Scalar::Int: ++stats_.integers; break;
+            case Scalar::Double: ++stats_.doubles; break;
+            case Scalar::String: {
+                ++stats_.strings;
+                size_t bucket = 0;
+                for (size_t length = text.size(); length > 0 && bucket + 1 < stats_.stringLengths.size();
+                     length >>= 1) {
+                    ++bucket;
+                }
+                ++stats_.stringLengths[bucket];
+                break;
+            }
+        }
+        // Null text from the tokenisers is written as `null`
+        const size_t length = kind == Scalar::Null ? 4 : text.size();
+        const Cost cost{length + (kind == Scalar::String ? 2 : 0), length, length};
+        if (depth_ == 0) {
+            setRoot(cost);
+            return;
+        }
+        Frame& parent = frames_[depth_ - 1];
+        if (parent.array) {
+            parent.objects = false;
+            parent.inlineText += length + 1;
+        } else {
+            parent.cellText += length;
+        }
+        addChild(parent, cost, false);
+    }
+
+    void end() override {
+        Frame& frame = frames_[--depth_];
+        Cost cost;
+        const size_t closeIndent = 2 * frame.depth - 2;
+        if (frame.array) {
+            ++stats_.arrays;
+            const bool tabular = frame.items > 0 && frame.objects && frame.uniform && frame.flat;
+            stats_.tabularArrays += tabular;
+            const size_t header = digits(frame.items) + 3; // `[N]:`
+            if (frame.items == 0) {
+                cost = Cost{2, 2, 6};
+            } else {
+                cost.json = frame.cost.json + 2 + closeIndent;
+                cost.yaml = frame.cost.yaml;
+                if (frame.primitives) {
+                    cost.toon = header + frame.inlineText;
+                } else if (tabular) {
+                    size_t fields = 0;
+                    for (std::string_view field : frame.fields) {
+                        fields += field.size() + 1;
+                    }
+                    cost.toon = header + fields + 2 + frame.rowText + frame.items * (closeIndent + 3);
+                } else {
+                    cost.toon = header + 1 + frame.cost.toon;
+                }
+            }
+        } else {
+            ++stats_.objects;
+            cost = frame.keys.empty() ? Cost{2, 2, 0}
+                                      : Cost{frame.cost.json + 2 + closeIndent, frame.cost.yaml, frame.cost.toon};
+        }
+
+        if (depth_ == 0) {
+            setRoot(cost);
+            return;
+        }
+        Frame& parent = frames_[depth_ - 1];
+        if (parent.array) {
+            parent.primitives = false;
+            if (frame.array) {
+                parent.objects = false;
+            } else {
+                addRow(parent, frame);
+            }
+        } else {
+            parent.flat = false;
+        }
+        addChild(parent, cost, true);
+    }
+
+    void finish() {
+        stats_.keyFrequency.reserve(keys_.size());
+        for (const auto& [name, count] : keys_) {
+            stats_.keyFrequency.emplace_back(std::string(name), count);
+        }
+        std::sort(stats_.keyFrequency.begin(), stats_.keyFrequency.end(), [](const auto& left, const auto& right) {
+            return left.second != right.second ? left.second > right.second : left.first < right.first;
+        });
+    }
+
+private:
+    struct Frame {
+        bool array = false;
+        size_t depth = 0;
+        size_t items = 0;
+        Cost cost;
+        std::string_view key; // name of the member being added
+        // Objects
+        std::vector<std::string_view> keys;
+        bool flat = true;     // only primitive members
+        size_t cellText = 0;  // text of the members, as a table row
+        // Arrays
+        bool primitives = true;
+        bool objects = true;
+        bool uniform = true;
+        std::vector<std::string_view> fields; // sorted keys of the first item
+        size_t inlineText = 0;                // primitives joined by delimiters
+        size_t rowText = 0;                   // rows joined by delimiters
+    };
+
+    void open(bool array) {
+        if (frames_.size() == depth_) {
+            frames_.emplace_back();
+        }
+        Frame& frame = frames_[depth_++];
+        // Reset everything but the capacity of the vectors
+        std::vector<std::string_view> keys = std::move(frame.keys);
+        std::vector<std::string_view> fields = std::move(frame.fields);
+        frame = Frame{};
+        frame.keys = std::move(keys);
+        frame.keys.clear();
+        frame.fields = std::move(fields);
+        frame.fields.clear();
+        frame.array = array;
+        frame.depth = depth_;
+        stats_.maxDepth = std::max(stats_.maxDepth, depth_);
+    }
+
+    // Records an object item of `array` for the table check.
+    void addRow(Frame& array, Frame& item) {
+        if (!item.flat) {
+            array.flat = false;
+        }
+        std::sort(item.keys.begin(), item.keys.end());
+        if (array.items == 0) {
+            array.fields = item.keys;
+        } else if (array.uniform && array.fields != item.keys) {
+            array.uniform = false;
+        }
+        array.rowText += item.cellText + (item.keys.empty() ? 0 : item.keys.size() - 1);
+    }
+
+    // Adds a finished child to `parent`. Containers already end their
+    // last line and indent their own lines.
+    void addChild(Frame& parent, const Cost& child, bool container) {
+        const size_t jsonIndent = 2 * parent.depth;
+        const size_t indent = jsonIndent - 2;
+        const size_t newline = container ? 0 : 1;
+        parent.cost.json += jsonIndent + child.json + 2;
+        if (parent.array) {
+            ++parent.items;
+            // A container item starts on the dash line in place of its first indent
+            parent.cost.yaml += (container ? 0 : indent + 2) + child.yaml + newline;
+            parent.cost.toon += (container ? 2 : indent + 4) + child.toon + newline;
+        } else {
+            const size_t key = parent.key.size() + 2; // `key: ` or `key:` and a newline
+            parent.cost.json += key + 2;
+            parent.cost.yaml += indent + key + child.yaml + newline;
+            parent.cost.toon += indent + key + child.toon + newline;
+        }
+    }
+
+    void setRoot(const Cost& cost) {
+        stats_.jsonBytes = cost.json;
+        stats_.yamlBytes = cost.yaml;
+        stats_.toonBytes = cost.toon;
+    }
+
+    DocumentStats& stats_;
+    std::vector<Frame> frames_;
+    size_t depth_ = 0;
+    std::unordered_map<std::string_view, size_t> keys_;
+};
+
+// Reports a non-string primitive with its written form.
+void emitPrimitive(StatsCollector& collector, const Primitive& primitive) {
+    if (primitive.isString()) {
+        collector.scalar(Scalar::String, primitive.getString());
+        return;
+    }
+    char buffer[Primitive::MAX_SCALAR_LENGTH];
+    const size_t length = primitive.writeTo(buffer, sizeof(buffer));
+    const Scalar kind = primitive.isNull()   ? Scalar::Null
+                        : primitive.isBool() ? Scalar::Bool
+                        : primitive.isInt()  ? Scalar::Int
+                                             : Scalar::Double;
+    collector.scalar(kind, std::string_view(buffer, std::min(length, sizeof(buffer))));
+}
+
+void walkValue(const Value& root, StatsCollector& collector) {
+    struct Frame {
+        const Value* container;
+        size_t index;
+    };
+    if (root.isPrimitive()) {
+        emitPrimitive(collector, root.asPrimitive());
+        return;
+    }
+    std::vector<Frame> stack;
+    auto open = [&](const Value& value) {
+        checkDepth(stack.size() + 1, getMaxDepth());
+        value.isArray() ? collector.beginArray() : collector.beginObject();
+        stack.push_back(Frame{&value, 0});
+    };
+    open(root);
+    while (!stack.empty()) {
+        Frame& frame = stack.back();
+        const Value* child = nullptr;
+        if (frame.container->isArray()) {
+            const Array& items = frame.container->asArray();
+            if (frame.index < items.size()) {
+                child = &items[frame.index++];
+            }
+        } else {
+            const Object& members = frame.container->asObject();
+            if (frame.index < members.size()) {
+                const auto& [key, value] = members.values_container()[frame.index++];
+                collector.key(key);
+                child = &value;
+            }
+        }
+        if (!child) {
+            collector.end();
+            stack.pop_back();
+        } else if (child->isPrimitive()) {
+            emitPrimitive(collector, child->asPrimitive());
+        } else {
+            open(*child);
+        }
+    }
+}
+
+void emitJsonScalar(StatsCollector& collector, yyjson_val* val) {
+    switch (yyjson_get_type(val)) {
+        case YYJSON_TYPE_STR:
+            collector.scalar(Scalar::String, std::string_view(yyjson_get_str(val), yyjson_get_len(val)));
+            return;
+        case YYJSON_TYPE_NUM:
+            if (yyjson_is_real(val)) {
+                emitPrimitive(collector, Primitive(yyjson_get_real(val)));
+            } else if (yyjson_is_sint(val)) {
+                emitPrimitive(collector, Primitive(yyjson_get_sint(val)));
+            } else {
+                emitPrimitive(collector, Primitive(static_cast<int64_t>(yyjson_get_uint(val))));
+            }
+            return;
+        case YYJSON_TYPE_BOOL:
+            collector.scalar(Scalar::Bool, yyjson_get_bool(val) ? "true" : "false");
+            return;
+        default:
+            collector.scalar(Scalar::Null, "null");
+            return;
+    }
+}
+
+void walkJson(yyjson_val* root, StatsCollector& collector) {
+    struct Frame {
+        yyjson_val* container;
+        size_t index;
+        size_t size;
+        yyjson_val* next; // next item, or next key of an object
+    };
+    if (!yyjson_is_ctn(root)) {
+        emitJsonScalar(collector, root);
+        return;
+    }
+    std::vector<Frame> stack;
+    auto open = [&](yyjson_val* val) {
+        checkDepth(stack.size() + 1, getMaxDepth());
+        yyjson_is_arr(val) ? collector.beginArray() : collector.beginObject();
+        // Children are laid out right after their container
+        stack.push_back(Frame{val, 0, yyjson_get_len(val), val + 1});
+    };
+    open(root);
+    while (!stack.empty()) {
+        Frame& frame = stack.back();
+        if (frame.index == frame.size) {
+            collector.end();
+            stack.pop_back();
+            continue;
+        }
+        ++frame.index;
+        yyjson_val* child = frame.next;
+        if (yyjson_is_obj(frame.container)) {
+            collector.key(std::string_view(yyjson_get_str(child), yyjson_get_len(child)));
+            ++child;
+        }
+        frame.next = unsafe_yyjson_get_next(child);
+        if (yyjson_is_ctn(child)) {
+            open(child);
+        } else {
+            emitJsonScalar(collector, child);
+        }
+    }
+}
+
+} // namespace
+
+DocumentStats stats(const Value& value) {
+    DocumentStats result;
+    StatsCollector collector(result);
+    walkValue(value, collector);
+    collector.finish();
+    return result;
+}
+
+DocumentStats stats(std::string_view content, Type format) {
+    DocumentStats result;
+    StatsCollector collector(result);
+    const size_t maxDepth = getMaxDepth();
+    // Key names are views into the document until finish() copies them
+    std::unique_ptr<yyjson_doc, decltype(&yyjson_doc_free)> doc(nullptr, &yyjson_doc_free);
+    switch (format) {
+        case Type::JSON: {
+            yyjson_read_err err;
+            doc.reset(yyjson_read_opts(const_cast<char*>(content.data()), content.size(), 0, nullptr, &err));
+            if (!doc) {
+                throw std::runtime_error("Invalid JSON at offset " + std::to_string(err.pos) + ": " + err.msg);
+            }
+            walkJson(yyjson_doc_get_root(doc.get()), collector);
+            break;
+        }
+        // The tokenisers are stricter than the loaders; what they reject is
+        // profiled as the loader reads it
+        case Type::YAML:
+            if (!detail::scanYaml(content, maxDepth, &collector)) {
+                return stats(loads(std::string(content), format));
+            }
+            break;
+        case Type::TOON:
+            if (!detail::scanToon(content, maxDepth, &collector)) {
+                return stats(loads(std::string(content), format));
+            }
+            break;
+        case Type::SERIN_BIN:
+            if (const ValidationResult scan = detail::scanBinary(content, maxDepth, &collector); !scan) {
+                throw std::runtime_error("Invalid serin binary document at offset " + std::to_string(scan.offset) +
+                                         ": " + scan.message);
+            }
+            break;
+        default:
+            throw std::runtime_error("Unsupported format type");
+    }
+    collector.finish();
+    return result;
+}
+
+DocumentStats statsFile(const std::string& filename) {
+    const Type format = detail::typeFromFilename(filename);
+    if (format == Type::UNKOWN) {
+        throw detail::unsupportedExtension(filename);
+    }
+    MappedFile file(filename);
+    return stats(file.view(), format);
+}
+
+} // namespace serin
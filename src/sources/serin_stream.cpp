@@ -0,0 +1,832 @@
+#include "serin.h"
+#include "serin_internal.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <deque>
+#include <filesystem>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace serin {
+
+namespace {
+
+using detail::EntrySource;
+using Entry = EntrySource::Entry;
+
+constexpr size_t FEED_CHUNK = 64 * 1024;
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool isNdjsonName(const std::string& filename) {
+    const std::string extension = toLower(std::filesystem::path(filename).extension().string());
+    return extension == ".ndjson" || extension == ".jsonl";
+}
+
+std::runtime_error streamError(const std::string& filename, size_t offset, const std::string& message) {
+    return std::runtime_error(filename + ": " + message + " at offset " + std::to_string(offset));
+}
+
+// Splits a top-level JSON array or object by scanning for the end of each
+// entry, then parses just that slice.
+class JsonSource : public EntrySource {
+public:
+    explicit JsonSource(const std::string& filename)
+        : filename_(filename), file_(filename), text_(file_.view()), alc_(yyjson_alc_dyn_new()) {
+        if (!alc_) {
+            throw std::runtime_error("Failed to create yyjson allocator");
+        }
+        skipSpace();
+        if (text_.substr(pos_, 3) == "\xEF\xBB\xBF") {
+            pos_ += 3;
+            skipSpace();
+        }
+        if (pos_ >= text_.size() || (text_[pos_] != '[' && text_[pos_] != '{')) {
+            throw streamError(filename_, pos_, "streaming needs a top-level JSON array or object");
+        }
+        mapping_ = text_[pos_] == '{';
+        start_ = ++pos_;
+        if (mapping_) {
+            findDuplicates();
+        }
+    }
+
+    ~JsonSource() override { yyjson_alc_dyn_free(alc_); }
+
+    bool mapping() const override { return mapping_; }
+
+    bool next(Entry& entry) override {
+        size_t begin = 0;
+        size_t end = 0;
+        while (nextSpan(entry.key, begin, end)) {
+            if (const auto found = duplicates_.find(entry.key); found != duplicates_.end()) {
+                if (found->second.written) {
+                    continue;
+                }
+                found->second.written = true;
+                begin = found->second.begin;
+                end = found->second.end;
+            }
+            entry.value = parse(text_.substr(begin, end - begin), begin);
+            return true;
+        }
+        return false;
+    }
+
+    void rewind() override {
+        pos_ = start_;
+        first_ = true;
+        done_ = false;
+        for (auto& [key, span] : duplicates_) {
+            span.written = false;
+        }
+    }
+
+private:
+    // Where the value of a repeated member name was last seen.
+    struct Span {
+        size_t begin = 0;
+        size_t end = 0;
+        bool repeated = false;
+        bool written = false;
+    };
+
+    // Reads the name (for a mapping) and the bounds of the next entry's value.
+    bool nextSpan(std::string& key, size_t& begin, size_t& end) {
+        if (done_) {
+            return false;
+        }
+        skipSpace();
+        if (pos_ < text_.size() && text_[pos_] == (mapping_ ? '}' : ']')) {
+            ++pos_;
+            skipSpace();
+            if (pos_ != text_.size()) {
+                throw streamError(filename_, pos_, "unexpected content after document");
+            }
+            done_ = true;
+            return false;
+        }
+        if (!first_) {
+            expect(',');
+            skipSpace();
+        }
+        first_ = false;
+
+        if (mapping_) {
+            if (pos_ >= text_.size() || text_[pos_] != '"') {
+                throw streamError(filename_, pos_, "expected a member name");
+            }
+            const size_t nameEnd = scanString(pos_);
+            const std::string_view name = text_.substr(pos_, nameEnd - pos_);
+            if (name.find('\\') == std::string_view::npos) {
+                key.assign(name.substr(1, name.size() - 2));
+            } else {
+                key = std::get<std::string>(parse(name, pos_).asPrimitive());
+            }
+            pos_ = nameEnd;
+            skipSpace();
+            expect(':');
+            skipSpace();
+        }
+
+        begin = pos_;
+        end = scanValue(pos_);
+        pos_ = end;
+        return true;
+    }
+
+    // loadsJson() keeps a repeated member at its first position with its
+    // last value. A pass over the member names finds the repeated ones, so
+    // the first occurrence can be written with the last value.
+    void findDuplicates() {
+        std::unordered_map<std::string, Span> seen;
+        std::string key;
+        size_t begin = 0;
+        size_t end = 0;
+        while (nextSpan(key, begin, end)) {
+            const auto [it, inserted] = seen.try_emplace(key, Span{begin, end});
+            if (!inserted) {
+                it->second = Span{begin, end, true};
+            }
+        }
+        for (auto& [name, span] : seen) {
+            if (span.repeated) {
+                duplicates_.emplace(name, span);
+            }
+        }
+        rewind();
+    }
+
+    Value parse(std::string_view slice, size_t offset) {
+        yyjson_read_err err;
+        yyjson_doc* doc = nullptr;
+        {
+            detail::PhaseScope phase(Phase::Parse, slice.size());
+            doc = yyjson_read_opts(const_cast<char*>(slice.data()), slice.size(), 0, alc_, &err);
+        }
+        if (!doc) {
+            throw streamError(filename_, offset + err.pos, std::string("invalid JSON: ") + err.msg);
+        }
+        std::unique_ptr<yyjson_doc, decltype(&yyjson_doc_free)> guard(doc, &yyjson_doc_free);
+        const size_t maxDepth = getMaxDepth();
+        checkDepth(1, maxDepth);
+        return detail::convertJson(yyjson_doc_get_root(doc), maxDepth - 1);
+    }
+
+    void skipSpace() {
+        while (pos_ < text_.size() && isSpace(text_[pos_])) {
+            ++pos_;
+        }
+    }
+
+    void expect(char c) {
+        if (pos_ >= text_.size() || text_[pos_] != c) {
+            throw streamError(filename_, pos_, std::string("expected '") + c + "'");
+        }
+        ++pos_;
+    }
+
+    // Position just past the string starting at `pos`.
+    size_t scanString(size_t pos) const {
+        for (size_t i = pos + 1; i < text_.size(); ++i) {
+            if (text_[i] == '\\') {
+                ++i;
+            } else if (text_[i] == '"') {
+                return i + 1;
+            }
+        }
+        throw streamError(filename_, pos, "unterminated string");
+    }
+
+    // Position just past the value starting at `pos`.
+    size_t scanValue(size_t pos) const {
+        if (pos >= text_.size()) {
+            throw streamError(filename_, pos, "unexpected end of input");
+        }
+        const char c = text_[pos];
+        if (c == '"') {
+            return scanString(pos);
+        }
+        if (c == '{' || c == '[') {
+            size_t depth = 0;
+            for (size_t i = pos; i < text_.size(); ++i) {
+                switch (text_[i]) {
+                    case '"':
+                        i = scanString(i) - 1;
+                        break;
+                    case '{':
+                    case '[':
+                        ++depth;
+                        break;
+                    case '}':
+                    case ']':
+                        if (--depth == 0) {
+                            return i + 1;
+                        }
+                        break;
+                    default:
+                        break;
+                }
+            }
+            throw streamError(filename_, pos, "unterminated container");
+        }
+        size_t end = pos;
+        while (end < text_.size() && !isSpace(text_[end]) && text_[end] != ',' && text_[end] != ']' &&
+               text_[end] != '}') {
+            ++end;
+        }
+        return end;
+    }
+
+    std::string filename_;
+    MappedFile file_;
+    std::string_view text_;
+    yyjson_alc* alc_;
+    size_t pos_ = 0;
+    size_t start_ = 0;
+    bool mapping_ = false;
+    bool first_ = true;
+    bool done_ = false;
+    std::unordered_map<std::string, Span> duplicates_;
+};
+
+// One JSON document per non-blank line.
+class NdjsonSource : public EntrySource {
+public:
+    explicit NdjsonSource(const std::string& filename) : filename_(filename), file_(filename), text_(file_.view()) {}
+
+    bool mapping() const override { return false; }
+
+    bool next(Entry& entry) override {
+        while (pos_ < text_.size()) {
+            size_t end = text_.find('\n', pos_);
+            if (end == std::string_view::npos) {
+                end = text_.size();
+            }
+            const std::string_view line = text_.substr(pos_, end - pos_);
+            const size_t offset = pos_;
+            pos_ = end + 1;
+            if (std::all_of(line.begin(), line.end(), isSpace)) {
+                continue;
+            }
+            try {
+                entry.value = detail::parseJson(line, nullptr, getMaxDepth());
+            } catch (const std::exception& error) {
+                throw streamError(filename_, offset, error.what());
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void rewind() override { pos_ = 0; }
+
+private:
+    std::string filename_;
+    MappedFile file_;
+    std::string_view text_;
+    size_t pos_ = 0;
+};
+
+// Feeds the mapped YAML to a PushParser and hands out its top-level entries.
+class YamlSource : public EntrySource {
+public:
+    explicit YamlSource(const std::string& filename) : filename_(filename), file_(filename), text_(file_.view()) {
+        size_t pos = 0;
+        while (pos < text_.size()) {
+            size_t end = std::min(text_.find('\n', pos), text_.size());
+            const std::string_view line = text_.substr(pos, end - pos);
+            const size_t first = line.find_first_not_of(" \t\r");
+            if (first != std::string_view::npos && line[first] != '#') {
+                if (line[first] != '-' && line.find(':') == std::string_view::npos) {
+                    throw std::runtime_error(filename_ + ": streaming needs a top-level YAML sequence or mapping");
+                }
+                mapping_ = line[first] != '-';
+                break;
+            }
+            pos = end + 1;
+        }
+        rewind();
+    }
+
+    bool mapping() const override { return mapping_; }
+
+    bool next(Entry& entry) override {
+        do {
+            while (queue_.empty() && !finished_) {
+                if (pos_ < text_.size()) {
+                    const size_t size = std::min(FEED_CHUNK, text_.size() - pos_);
+                    parser_->feed(text_.data() + pos_, size);
+                    pos_ += size;
+                } else {
+                    parser_->finish();
+                    finished_ = true;
+                }
+            }
+            if (queue_.empty()) {
+                return false;
+            }
+            entry.key = std::move(queue_.front().key);
+            entry.value = std::move(queue_.front().value);
+            queue_.pop_front();
+            // loadsYaml() keeps the first of repeated keys
+        } while (mapping_ && !keys_.insert(entry.key).second);
+        return true;
+    }
+
+    void rewind() override {
+        keys_.clear();
+        queue_.clear();
+        pos_ = 0;
+        finished_ = false;
+        parser_ = std::make_unique<PushParser>(Type::YAML, [this](Entry& entry) {
+            queue_.push_back(std::move(entry));
+        });
+    }
+
+private:
+    std::string filename_;
+    MappedFile file_;
+    std::string_view text_;
+    std::unique_ptr<PushParser> parser_;
+    std::deque<Entry> queue_;
+    std::unordered_set<std::string> keys_; // written so far
+    size_t pos_ = 0;
+    bool mapping_ = false;
+    bool finished_ = false;
+};
+
+// Rows of a TOON tabular array, as objects.
+class ToonSource : public EntrySource {
+public:
+    explicit ToonSource(const std::string& filename) : reader_(filename) {}
+
+    bool mapping() const override { return false; }
+    const std::string* wrapper() const override { return reader_.key().empty() ? nullptr : &reader_.key(); }
+
+    bool next(Entry& entry) override {
+        if (!reader_.next(row_)) {
+            return false;
+        }
+        Object object;
+        object.reserve(row_.size());
+        const auto& columns = reader_.columns();
+        for (size_t i = 0; i < row_.size(); ++i) {
+            object.emplace(columns[i], Value(row_.value(i)));
+        }
+        entry.value = Value(std::move(object));
+        return true;
+    }
+
+    void rewind() override { reader_.rewind(); }
+
+private:
+    ToonTableReader reader_;
+    ToonTableReader::Row row_;
+};
+
+// Items or members of a mapped .serinb document, each built on its own.
+class BinarySource : public EntrySource {
+public:
+    explicit BinarySource(const std::string& filename) : document_(filename), root_(document_.root()) {
+        if (!root_.isArray() && !root_.isObject()) {
+            throw streamError(filename, 0, "streaming needs a top-level array or object");
+        }
+    }
+
+    bool mapping() const override { return root_.isObject(); }
+
+    bool next(Entry& entry) override {
+        if (index_ == root_.size()) {
+            return false;
+        }
+        if (root_.isObject()) {
+            entry.key.assign(root_.key(index_));
+        }
+        entry.value = root_[index_++].toValue();
+        return true;
+    }
+
+    void rewind() override { index_ = 0; }
+
+private:
+    BinaryDocument document_;
+    BinaryView root_;
+    size_t index_ = 0;
+};
+
+std::unique_ptr<EntrySource> openSource(const std::string& filename) {
+    if (isNdjsonName(filename)) {
+        return std::make_unique<NdjsonSource>(filename);
+    }
+    switch (detail::typeFromFilename(filename)) {
+        case Type::JSON:
+            return std::make_unique<JsonSource>(filename);
+        case Type::YAML:
+            return std::make_unique<YamlSource>(filename);
+        case Type::TOON:
+            return std::make_unique<ToonSource>(filename);
+        case Type::SERIN_BIN:
+            return std::make_unique<BinarySource>(filename);
+        default:
+            throw std::runtime_error("Unsupported file extension for streaming: " + filename);
+    }
+}
+
+// ---------------------
+// Writers
+// ---------------------
+
+// Writes entries as they come, producing the text the matching dumps*()
+// function would write for the whole document.
+class EntryWriter {
+public:
+    virtual ~EntryWriter() = default;
+    virtual void begin(bool mapping, const std::string* wrapper) = 0;
+    // A member of a root object; items are written with addItem().
+    virtual void add(Entry& entry) = 0;
+    virtual void addItem(const Value& item) = 0;
+    virtual void end() = 0;
+};
+
+class JsonWriter : public EntryWriter {
+public:
+    JsonWriter(std::string& out, int indent) : out_(out), indent_(indent > 0 ? indent : 0) {}
+
+    void begin(bool mapping, const std::string* wrapper) override {
+        mapping_ = mapping;
+        wrapper_ = wrapper;
+    }
+
+    void add(Entry& entry) override {
+        next();
+        appendKey(entry.key);
+        appendValue(entry.value);
+    }
+
+    void addItem(const Value& item) override {
+        next();
+        appendValue(item);
+    }
+
+    void end() override {
+        if (count_ == 0) {
+            // Same text as the whole (empty) document
+            Value empty = mapping_ ? Value(Object{}) : Value(Array{});
+            if (wrapper_) {
+                Object root;
+                root.emplace(*wrapper_, std::move(empty));
+                empty = Value(std::move(root));
+            }
+            detail::writeJson(empty, indent_, nullptr, getMaxDepth(), out_);
+            return;
+        }
+        newline(level_ - 1);
+        out_ += mapping_ ? '}' : ']';
+        if (wrapper_) {
+            newline(0);
+            out_ += '}';
+        }
+    }
+
+private:
+    void next() {
+        if (count_++ == 0) {
+            open();
+        } else {
+            out_ += ',';
+        }
+        newline(level_);
+    }
+
+    void appendValue(const Value& value) {
+        scratch_.clear();
+        detail::writeJson(value, indent_, nullptr, getMaxDepth(), scratch_);
+        appendIndented(scratch_, level_);
+    }
+
+    void open() {
+        if (wrapper_) {
+            out_ += '{';
+            newline(1);
+            appendKey(*wrapper_);
+            out_ += '[';
+            level_ = 2;
+        } else {
+            out_ += mapping_ ? '{' : '[';
+            level_ = 1;
+        }
+    }
+
+    void newline(size_t level) {
+        if (indent_ > 0) {
+            out_ += '\n';
+            out_.append(level * static_cast<size_t>(indent_), ' ');
+        }
+    }
+
+    void appendKey(const std::string& key) {
+        detail::writeJson(Value(key), 0, nullptr, getMaxDepth(), out_);
+        out_ += indent_ > 0 ? ": " : ":";
+    }
+
+    // Appends `text` with every line after the first indented to `level`.
+    void appendIndented(const std::string& text, size_t level) {
+        if (indent_ == 0) {
+            out_ += text;
+            return;
+        }
+        size_t start = 0;
+        size_t newline;
+        while ((newline = text.find('\n', start)) != std::string::npos) {
+            out_.append(text, start, newline - start + 1);
+            out_.append(level * static_cast<size_t>(indent_), ' ');
+            start = newline + 1;
+        }
+        out_.append(text, start, std::string::npos);
+    }
+
+    std::string& out_;
+    int indent_;
+    bool mapping_ = false;
+    const std::string* wrapper_ = nullptr;
+    size_t level_ = 1;
+    size_t count_ = 0;
+    std::string scratch_;
+};
+
+class NdjsonWriter : public EntryWriter {
+public:
+    explicit NdjsonWriter(std::string& out) : out_(out) {}
+
+    void begin(bool, const std::string*) override {}
+
+    void add(Entry& entry) override {
+        Object member;
+        member.emplace(std::move(entry.key), std::move(entry.value));
+        addItem(Value(std::move(member)));
+    }
+
+    void addItem(const Value& item) override {
+        detail::writeJson(item, 0, nullptr, getMaxDepth(), out_);
+        out_ += '\n';
+    }
+
+    void end() override {}
+
+private:
+    std::string& out_;
+};
+
+class YamlWriter : public EntryWriter {
+public:
+    YamlWriter(std::string& out, int indent) : out_(out), indent_(indent) {}
+
+    void begin(bool mapping, const std::string* wrapper) override {
+        mapping_ = mapping;
+        wrapper_ = wrapper;
+    }
+
+    // Each member is dumped on its own inside a one-member root.
+    void add(Entry& entry) override {
+        Object member;
+        member.emplace(std::move(entry.key), std::move(entry.value));
+        scratch_.clear();
+        detail::writeYaml(Value(std::move(member)), indent_, getMaxDepth(), scratch_);
+        append();
+    }
+
+    // Items are written at the indent of the array, under a `key:` line
+    // ahead of the first when wrapped.
+    void addItem(const Value& item) override {
+        scratch_.clear();
+        if (wrapper_ && count_ == 0) {
+            scratch_ += *wrapper_;
+            scratch_ += ":\n";
+        }
+        detail::writeYamlItem(item, indent_, wrapper_ ? 1 : 0, getMaxDepth(), scratch_);
+        scratch_.pop_back();
+        append();
+    }
+
+    void end() override {
+        if (count_ == 0) {
+            Entry empty;
+            Value root = mapping_ ? Value(Object{}) : wrapEmpty();
+            detail::writeYaml(root, indent_, getMaxDepth(), out_);
+        }
+    }
+
+private:
+    void append() {
+        if (count_++ > 0) {
+            out_ += '\n';
+        }
+        out_ += scratch_;
+    }
+
+    Value wrapEmpty() {
+        if (!wrapper_) {
+            return Value(Array{});
+        }
+        Object member;
+        member.emplace(*wrapper_, Value(Array{}));
+        return Value(std::move(member));
+    }
+
+    std::string& out_;
+    int indent_;
+    bool mapping_ = false;
+    const std::string* wrapper_ = nullptr;
+    size_t count_ = 0;
+    std::string scratch_;
+};
+
+// TOON members are written one by one; arrays use a layout from a first pass.
+class ToonWriter : public EntryWriter {
+public:
+    ToonWriter(std::string& out, int indent, EntrySource& source)
+        : out_(out), options_(indent), source_(source) {}
+
+    void begin(bool mapping, const std::string* wrapper) override {
+        mapping_ = mapping;
+        if (mapping_) {
+            return;
+        }
+        Entry entry;
+        while (source_.next(entry)) {
+            layout_.add(entry.value);
+        }
+        source_.rewind();
+        static const std::string noKey;
+        array_ = std::make_unique<detail::ToonArrayWriter>(wrapper ? *wrapper : noKey, layout_, options_,
+                                                           getMaxDepth());
+        array_->begin(out_);
+    }
+
+    void add(Entry& entry) override {
+        if (count_++ > 0) {
+            out_ += '\n';
+        }
+        Object member;
+        member.emplace(std::move(entry.key), std::move(entry.value));
+        detail::writeToon(Value(std::move(member)), options_, getMaxDepth(), out_);
+    }
+
+    void addItem(const Value& item) override { array_->add(item, out_); }
+
+    void end() override {
+        if (array_) {
+            array_->end(out_);
+        }
+    }
+
+private:
+    std::string& out_;
+    EncoderOptions options_;
+    EntrySource& source_;
+    bool mapping_ = false;
+    size_t count_ = 0;
+    detail::ToonArrayLayout layout_;
+    std::unique_ptr<detail::ToonArrayWriter> array_;
+};
+
+// Gathers every entry into the document they make up.
+size_t collectEntries(detail::EntrySource& source, Value& document) {
+    Object members;
+    Array items;
+    Entry entry;
+    size_t count = 0;
+    while (source.next(entry)) {
+        if (source.mapping()) {
+            members.emplace(std::move(entry.key), std::move(entry.value));
+        } else {
+            items.push_back(std::move(entry.value));
+        }
+        ++count;
+    }
+    if (source.mapping()) {
+        document.value = std::move(members);
+    } else if (const std::string* wrapper = source.wrapper()) {
+        Object root;
+        root.emplace(*wrapper, Value()).first.value().value = std::move(items);
+        document.value = std::move(root);
+    } else {
+        document.value = std::move(items);
+    }
+    return count;
+}
+
+} // namespace
+
+size_t detail::writeEntries(EntrySource& source, const std::string& outputPath, const StreamOptions& options) {
+    Type outputType = options.outputType;
+    bool ndjson = options.ndjson;
+    if (!outputPath.empty()) {
+        ndjson = isNdjsonName(outputPath);
+        outputType = ndjson ? Type::JSON : detail::typeFromFilename(outputPath);
+    }
+
+    // Phases repeat for every entry; report their totals instead
+    detail::TraceBatch batch;
+    FileWriter output(outputPath);
+    std::string& out = output.buffer();
+
+    if (outputType == Type::SERIN_BIN && !ndjson) {
+        // Offsets may point anywhere in the file, so the binary form is built
+        // from the whole document rather than entry by entry
+        Value document;
+        const size_t count = collectEntries(source, document);
+        detail::writeBinary(document, getMaxDepth(), out);
+        output.close();
+        return count;
+    }
+
+    std::unique_ptr<EntryWriter> writer;
+    switch (outputType) {
+        case Type::JSON:
+            writer = ndjson ? std::unique_ptr<EntryWriter>(std::make_unique<NdjsonWriter>(out))
+                            : std::make_unique<JsonWriter>(out, options.indent);
+            break;
+        case Type::YAML:
+            writer = std::make_unique<YamlWriter>(out, options.indent);
+            break;
+        case Type::TOON:
+            writer = std::make_unique<ToonWriter>(out, options.indent, source);
+            break;
+        default:
+            throw std::runtime_error("Unsupported output format for streaming: " + outputPath);
+    }
+
+    size_t count = 0;
+    Entry entry;
+    const bool mapping = source.mapping();
+    writer->begin(mapping, source.wrapper());
+    while (source.next(entry)) {
+        if (mapping) {
+            writer->add(entry);
+        } else {
+            writer->addItem(entry.value);
+        }
+        output.flushIfFull();
+        ++count;
+    }
+    writer->end();
+    if (outputPath.empty() && !ndjson) {
+        // Like the CLI, end terminal output with a newline
+        out += '\n';
+    }
+    output.close();
+    return count;
+}
+
+void detail::writeItems(const Value* first, const Value* last, const std::string* wrapper, Type format, int indent,
+                        std::string& out) {
+    out.clear();
+    if (format == Type::SERIN_BIN) {
+        detail::writeBinaryItems(first, last, wrapper, getMaxDepth(), out);
+        return;
+    }
+    if (format == Type::TOON) {
+        detail::ToonArrayLayout layout;
+        for (const Value* item = first; item != last; ++item) {
+            layout.add(*item);
+        }
+        static const std::string noKey;
+        detail::ToonArrayWriter writer(wrapper ? *wrapper : noKey, layout, EncoderOptions(indent), getMaxDepth());
+        writer.begin(out);
+        for (const Value* item = first; item != last; ++item) {
+            writer.add(*item, out);
+        }
+        writer.end(out);
+        return;
+    }
+
+    std::unique_ptr<EntryWriter> writer;
+    switch (format) {
+        case Type::JSON:
+            writer = std::make_unique<JsonWriter>(out, indent);
+            break;
+        case Type::YAML:
+            writer = std::make_unique<YamlWriter>(out, indent);
+            break;
+        default:
+            throw std::runtime_error("Unsupported format type");
+    }
+    writer->begin(false, wrapper);
+    for (const Value* item = first; item != last; ++item) {
+        writer->addItem(*item);
+    }
+    writer->end();
+}
+
+size_t convertStream(const std::string& inputPath, const std::string& outputPath, const StreamOptions& options) {
+    std::unique_ptr<EntrySource> source = openSource(inputPath);
+    return detail::writeEntries(*source, outputPath, options);
+}
+
+} // namespace serin
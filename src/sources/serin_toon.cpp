@@ -1,10 +1,11 @@
 #include "serin.h"
+#include "serin_internal.h"
 #include "utils.h"
 
 #include <algorithm>
 #include <cctype>
+#include <charconv>
 #include <fstream>
-#include <sstream>
 #include <stdexcept>
 
 namespace serin {
@@ -25,58 +26,53 @@ constexpr const char* NULL_LITERAL = "null";
 constexpr const char* TRUE_LITERAL = "true";
 constexpr const char* FALSE_LITERAL = "false";
 
-std::string encodePrimitive(const Primitive& primitive, Delimiter delimiter) {
-    // Use Primitive::asString() which already uses yyjson for number serialization
-    std::string result = primitive.asString();
-    
-    // For strings, we still need to handle TOON-specific quoting
-    if (primitive.isString()) {
-        bool needsQuoting = result.empty() || result.front() == SPACE || result.back() == SPACE ||
-                             result == TRUE_LITERAL || result == FALSE_LITERAL || result == NULL_LITERAL;
-
-        const char activeDelimiter = static_cast<char>(delimiter);
-        if (!needsQuoting) {
-            needsQuoting = result.find(activeDelimiter) != std::string::npos ||
-                           result.find(COLON) != std::string::npos ||
-                           result.find(DOUBLE_QUOTE) != std::string::npos ||
-                           result.find(BACKSLASH) != std::string::npos;
-        }
-
-        if (!needsQuoting) {
-            return result;
-        }
+bool needsQuoting(const std::string& value, Delimiter delimiter) {
+    if (value.empty() || value.front() == SPACE || value.back() == SPACE ||
+        value == TRUE_LITERAL || value == FALSE_LITERAL || value == NULL_LITERAL) {
+        return true;
+    }
 
-        std::string escaped;
-        escaped += DOUBLE_QUOTE;
-        for (char c : result) {
-            if (c == DOUBLE_QUOTE || c == BACKSLASH) {
-                escaped += BACKSLASH;
-            }
-            escaped += c;
+    const char activeDelimiter = static_cast<char>(delimiter);
+    for (char c : value) {
+        if (c == activeDelimiter || c == COLON || c == DOUBLE_QUOTE || c == BACKSLASH) {
+            return true;
         }
-        escaped += DOUBLE_QUOTE;
-        return escaped;
     }
-    
-    return result;
+    return false;
 }
 
-std::string encodeAndJoinPrimitives(const std::vector<Primitive>& primitives, Delimiter delimiter) {
-    std::vector<std::string> encoded;
-    encoded.reserve(primitives.size());
-    for (const auto& primitive : primitives) {
-        encoded.push_back(encodePrimitive(primitive, delimiter));
+void appendPrimitive(std::string& out, const Primitive& primitive, Delimiter delimiter) {
+    if (!primitive.isString()) {
+        primitive.appendTo(out);
+        return;
     }
 
-    std::ostringstream oss;
-    const char delimChar = static_cast<char>(delimiter);
-    for (size_t i = 0; i < encoded.size(); ++i) {
-        if (i > 0) {
-            oss << delimChar;
+    // For strings, we still need to handle TOON-specific quoting
+    const std::string& text = std::get<std::string>(primitive);
+    if (!needsQuoting(text, delimiter)) {
+        out += text;
+        return;
+    }
+
+    out += DOUBLE_QUOTE;
+    for (char c : text) {
+        if (c == DOUBLE_QUOTE || c == BACKSLASH) {
+            out += BACKSLASH;
         }
-        oss << encoded[i];
+        out += c;
     }
-    return oss.str();
+    out += DOUBLE_QUOTE;
+}
+
+void appendIndent(std::string& out, int depth, const EncoderOptions& options) {
+    out.append(static_cast<size_t>(depth * options.indent), SPACE);
+}
+
+void appendLength(std::string& out, size_t length) {
+    char buffer[24];
+    out += OPEN_BRACKET;
+    out.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), length).ptr);
+    out += CLOSE_BRACKET;
 }
 
 bool isArrayOfPrimitives(const Array& array) {
@@ -91,7 +87,7 @@ bool isArrayOfObjects(const Array& array) {
     });
 }
 
-bool collectUniformObjectFields(const Array& array, std::vector<std::string>& fields) {
+bool collectUniformObjectFields(const Array& array, std::vector<const std::string*>& fields) {
     if (array.empty()) {
         return true;
     }
@@ -99,7 +95,7 @@ bool collectUniformObjectFields(const Array& array, std::vector<std::string>& fi
     const Object& firstObj = array.front().asObject();
     fields.reserve(firstObj.size());
     for (const auto& [field, _] : firstObj) {
-        fields.push_back(field);
+        fields.push_back(&field);
     }
 
     for (size_t i = 1; i < array.size(); ++i) {
@@ -108,8 +104,8 @@ bool collectUniformObjectFields(const Array& array, std::vector<std::string>& fi
             return false;
         }
 
-        for (const auto& field : fields) {
-            if (obj.find(field) == obj.end()) {
+        for (const auto* field : fields) {
+            if (obj.find(*field) == obj.end()) {
                 return false;
             }
         }
@@ -118,201 +114,271 @@ bool collectUniformObjectFields(const Array& array, std::vector<std::string>& fi
     return true;
 }
 
-std::string encodeValue(const std::string& key, const Value& value, const EncoderOptions& options, int depth);
-
-std::string encodeNonUniformArrayOfObjects(const std::string& key,
-                                           const Array& array,
-                                           const EncoderOptions& options,
-                                           int depth) {
-    std::ostringstream oss;
-    oss << key << OPEN_BRACKET << array.size() << CLOSE_BRACKET << COLON << NEWLINE;
-
-    const std::string itemIndent((depth + 1) * options.indent, SPACE);
-    const std::string fieldIndent = itemIndent + std::string(options.indent, SPACE);
-
-    for (size_t index = 0; index < array.size(); ++index) {
-        const auto& item = array[index];
-        oss << itemIndent << "-";
-
-        if (item.isObject()) {
-            const Object& obj = item.asObject();
-            bool firstField = true;
-            for (const auto& [field, fieldValue] : obj) {
-                if (firstField) {
-                    if (fieldValue.isPrimitive()) {
-                        oss << SPACE << field << COLON << SPACE
-                            << encodePrimitive(fieldValue.asPrimitive(), options.delimiter);
-                    } else {
-                        oss << NEWLINE;
-                        oss << fieldIndent
-                            << encodeValue(field, fieldValue, options, depth + 1);
-                    }
-                    firstField = false;
-                    continue;
-                }
-
-                oss << NEWLINE;
-                oss << fieldIndent
-                    << encodeValue(field, fieldValue, options, depth + 1);
-            }
-
-            if (firstField) {
-                oss << NEWLINE;
-            }
-        }
+void encodeArrayOfPrimitives(std::string& out, const std::string& key, const Array& array, const EncoderOptions& options) {
+    out += key;
+    appendLength(out, array.size());
+    out += COLON;
+    out += SPACE;
 
-        if (index + 1 < array.size()) {
-            oss << NEWLINE;
+    const char delimChar = static_cast<char>(options.delimiter);
+    for (size_t i = 0; i < array.size(); ++i) {
+        if (i > 0) {
+            out += delimChar;
         }
+        appendPrimitive(out, array[i].asPrimitive(), options.delimiter);
     }
-
-    return oss.str();
 }
 
-std::string encodeArrayOfPrimitives(const std::string& key, const Array& array, const EncoderOptions& options) {
-    std::ostringstream oss;
-    oss << key << OPEN_BRACKET << array.size() << CLOSE_BRACKET << COLON;
-
-    std::vector<Primitive> primitives;
-    primitives.reserve(array.size());
-    for (const auto& value : array) {
-        primitives.push_back(value.asPrimitive());
+void encodeTabularRow(std::string& out,
+                      const Object& obj,
+                      const std::vector<const std::string*>& fields,
+                      const EncoderOptions& options,
+                      int depth) {
+    const char delimChar = static_cast<char>(options.delimiter);
+    const Primitive nullPrimitive(nullptr);
+    // Ensure all array items are indented with proper depth
+    appendIndent(out, depth + 1, options);
+    for (size_t i = 0; i < fields.size(); ++i) {
+        if (i > 0) {
+            out += delimChar;
+        }
+        const auto it = obj.find(*fields[i]);
+        const bool primitive = it != obj.end() && it->second.isPrimitive();
+        appendPrimitive(out, primitive ? it->second.asPrimitive() : nullPrimitive, options.delimiter);
     }
-
-    oss << SPACE << encodeAndJoinPrimitives(primitives, options.delimiter);
-    return oss.str();
 }
 
-std::string encodeArrayOfObjects(const std::string& key, const Array& array, const EncoderOptions& options, int depth);
-std::string encodeObject(const Object& obj, const EncoderOptions& options, int depth);
-
-std::string encodeValue(const std::string& key, const Value& value, const EncoderOptions& options, int depth) {
-    if (value.isPrimitive()) {
-        return key + COLON + SPACE + encodePrimitive(value.asPrimitive(), options.delimiter);
+void encodeTabularArray(std::string& out,
+                        const std::string& key,
+                        const Array& array,
+                        const std::vector<const std::string*>& fields,
+                        const EncoderOptions& options,
+                        int depth) {
+    const char delimChar = static_cast<char>(options.delimiter);
+    out += key;
+    appendLength(out, array.size());
+    out += OPEN_BRACE;
+    for (size_t i = 0; i < fields.size(); ++i) {
+        if (i > 0) {
+            out += delimChar;
+        }
+        out += *fields[i];
     }
+    out += CLOSE_BRACE;
+    out += COLON;
+    out += NEWLINE;
 
-    if (value.isArray()) {
-        const Array& array = value.asArray();
-        if (array.empty()) {
-            return key + "[0]{}:";
+    bool first = true;
+    for (const auto& item : array) {
+        if (!first) {
+            out += NEWLINE;
         }
+        first = false;
+        encodeTabularRow(out, item.asObject(), fields, options, depth);
+    }
+}
 
-        if (isArrayOfPrimitives(array)) {
-            return encodeArrayOfPrimitives(key, array, options);
-        }
+const std::string NO_KEY;
 
-        if (isArrayOfObjects(array)) {
-            return encodeArrayOfObjects(key, array, options, depth);
-        }
+// Writes TOON without recursion: nested containers are kept on an explicit
+// stack so document depth is bounded by maxDepth rather than the call stack.
+class ToonEncoder {
+public:
+    ToonEncoder(std::string& out, const EncoderOptions& options, size_t maxDepth)
+        : out_(out), options_(options), maxDepth_(maxDepth) {}
 
-        std::ostringstream oss;
-        oss << key << OPEN_BRACKET << array.size() << CLOSE_BRACKET << COLON << NEWLINE;
-        for (const auto& item : array) {
-            oss << std::string((depth + 1) * options.indent, SPACE)
-                << encodeValue("", item, options, depth + 1) << NEWLINE;
+    void encode(const Value& value) {
+        if (value.isPrimitive()) {
+            appendPrimitive(out_, value.asPrimitive(), options_.delimiter);
+            return;
         }
-        return oss.str();
-    }
 
-    if (value.isObject()) {
-        const Object& obj = value.asObject();
-        if (obj.empty()) {
-            return key + COLON;
+        if (value.isArray()) {
+            encodeValue(NO_KEY, value, 0);
+        } else {
+            push(Frame::Kind::Fields, value, 0);
         }
-
-        std::ostringstream oss;
-        oss << key << COLON << NEWLINE;
-        oss << encodeObject(obj, options, depth + 1);
-        return oss.str();
+        run();
     }
 
-    return key + COLON + SPACE + NULL_LITERAL;
-}
-
-std::string encodeArrayOfObjects(const std::string& key, const Array& array, const EncoderOptions& options, int depth) {
-    if (array.empty()) {
-        return key + "[0]{}:\n";
+    // One `- ` item of a non-uniform array of objects at `depth`.
+    void encodeListItem(const Value& item, int depth) {
+        appendIndent(out_, depth + 1, options_);
+        out_ += '-';
+        push(Frame::Kind::ListFields, item, depth);
+        run();
     }
 
-    std::vector<std::string> fields;
-    if (!collectUniformObjectFields(array, fields)) {
-        return encodeNonUniformArrayOfObjects(key, array, options, depth);
+    // One item of an array mixing primitives and containers at `depth`.
+    void encodeItem(const Value& item, int depth) {
+        appendIndent(out_, depth + 1, options_);
+        encodeValue(NO_KEY, item, depth + 1);
+        run();
     }
 
-    std::ostringstream oss;
-    oss << key << OPEN_BRACKET << array.size() << CLOSE_BRACKET << OPEN_BRACE;
-    for (size_t i = 0; i < fields.size(); ++i) {
-        if (i > 0) {
-            oss << static_cast<char>(options.delimiter);
-        }
-        oss << fields[i];
+private:
+    struct Frame {
+        enum class Kind {
+            Fields,     // `key: value` lines of an object
+            Items,      // items of an array mixing primitives and containers
+            ListItems,  // `- ` items of a non-uniform array of objects
+            ListFields  // fields of one `- ` item
+        };
+        Kind kind;
+        const Value* container;
+        size_t index;
+        int depth;
+    };
+
+    void push(Frame::Kind kind, const Value& container, int depth) {
+        checkDepth(stack_.size() + 1, maxDepth_);
+        stack_.push_back(Frame{kind, &container, 0, depth});
     }
-    oss << CLOSE_BRACE << COLON << NEWLINE;
 
-    bool first = true;
-    for (const auto& item : array) {
-        if (!item.isObject()) {
-            continue;
+    // Writes `key` followed by `value`; nested containers are pushed on the stack.
+    void encodeValue(const std::string& key, const Value& value, int depth) {
+        if (value.isPrimitive()) {
+            out_ += key;
+            out_ += COLON;
+            out_ += SPACE;
+            appendPrimitive(out_, value.asPrimitive(), options_.delimiter);
+            return;
         }
 
-        const Object& obj = item.asObject();
-        std::vector<Primitive> values;
-        values.reserve(fields.size());
-        for (const auto& field : fields) {
-            const auto it = obj.find(field);
-            if (it != obj.end() && it->second.isPrimitive()) {
-                values.push_back(it->second.asPrimitive());
-            } else {
-                values.push_back(nullptr);
+        if (value.isObject()) {
+            out_ += key;
+            out_ += COLON;
+            if (!value.asObject().empty()) {
+                out_ += NEWLINE;
+                push(Frame::Kind::Fields, value, depth + 1);
             }
+            return;
         }
-        if (!first) {
-            oss << NEWLINE;
+
+        const Array& array = value.asArray();
+        if (array.empty()) {
+            out_ += key;
+            out_ += "[0]{}:";
+            return;
         }
-        first = false;
-        // Ensure all array items are indented with proper depth
-        oss << std::string((depth + 1) * options.indent, SPACE) << encodeAndJoinPrimitives(values, options.delimiter);
-    }
 
-    return oss.str();
-}
+        if (isArrayOfPrimitives(array)) {
+            encodeArrayOfPrimitives(out_, key, array, options_);
+            return;
+        }
 
-std::string encodeObject(const Object& obj, const EncoderOptions& options, int depth) {
-    std::ostringstream oss;
-    const std::string indent(depth * options.indent, SPACE);
+        if (isArrayOfObjects(array)) {
+            fields_.clear();
+            if (collectUniformObjectFields(array, fields_)) {
+                checkDepth(stack_.size() + 2, maxDepth_);
+                encodeTabularArray(out_, key, array, fields_, options_, depth);
+                return;
+            }
+        }
 
-    // The ordered_map preserves insertion order, so we can just iterate normally
-    bool first = true;
-    for (const auto& [key, value] : obj) {
-        if (!first) {
-            oss << NEWLINE;
+        out_ += key;
+        appendLength(out_, array.size());
+        out_ += COLON;
+        out_ += NEWLINE;
+        push(isArrayOfObjects(array) ? Frame::Kind::ListItems : Frame::Kind::Items, value, depth);
+    }
+
+    void run() {
+        while (!stack_.empty()) {
+            Frame& frame = stack_.back();
+            const size_t index = frame.index++;
+            const int depth = frame.depth;
+
+            switch (frame.kind) {
+            case Frame::Kind::Fields: {
+                const Object& obj = frame.container->asObject();
+                if (index == obj.size()) {
+                    stack_.pop_back();
+                    break;
+                }
+                // The ordered_map preserves insertion order, so we can just iterate normally
+                const auto& [key, value] = obj.values_container()[index];
+                if (index > 0) {
+                    out_ += NEWLINE;
+                }
+                appendIndent(out_, depth, options_);
+                encodeValue(key, value, depth);
+                break;
+            }
+            case Frame::Kind::Items: {
+                const Array& array = frame.container->asArray();
+                // Every item is followed by a newline, written once its subtree is done
+                if (index > 0) {
+                    out_ += NEWLINE;
+                }
+                if (index == array.size()) {
+                    stack_.pop_back();
+                    break;
+                }
+                appendIndent(out_, depth + 1, options_);
+                encodeValue(NO_KEY, array[index], depth + 1);
+                break;
+            }
+            case Frame::Kind::ListItems: {
+                const Array& array = frame.container->asArray();
+                if (index == array.size()) {
+                    stack_.pop_back();
+                    break;
+                }
+                if (index > 0) {
+                    out_ += NEWLINE;
+                }
+                appendIndent(out_, depth + 1, options_);
+                out_ += '-';
+                push(Frame::Kind::ListFields, array[index], depth);
+                break;
+            }
+            case Frame::Kind::ListFields: {
+                const Object& obj = frame.container->asObject();
+                if (index == obj.size()) {
+                    if (obj.empty()) {
+                        out_ += NEWLINE;
+                    }
+                    stack_.pop_back();
+                    break;
+                }
+                const auto& [field, fieldValue] = obj.values_container()[index];
+                if (index == 0 && fieldValue.isPrimitive()) {
+                    out_ += SPACE;
+                    out_ += field;
+                    out_ += COLON;
+                    out_ += SPACE;
+                    appendPrimitive(out_, fieldValue.asPrimitive(), options_.delimiter);
+                } else {
+                    out_ += NEWLINE;
+                    appendIndent(out_, depth + 2, options_);
+                    encodeValue(field, fieldValue, depth + 1);
+                }
+                break;
+            }
+            }
         }
-        oss << indent << encodeValue(key, value, options, depth);
-        first = false;
     }
 
-    return oss.str();
-}
+    std::string& out_;
+    const EncoderOptions& options_;
+    size_t maxDepth_;
+    std::vector<Frame> stack_;
+    std::vector<const std::string*> fields_;
+};
 
 } // namespace
 
 std::string encode(const Value& value, const EncoderOptions& options) {
-    if (value.isPrimitive()) {
-        return encodePrimitive(value.asPrimitive(), options.delimiter);
-    }
-
-    if (value.isArray()) {
-        return encodeValue("", value, options, 0);
-    }
-
-    if (value.isObject()) {
-        return encodeObject(value.asObject(), options, 0);
-    }
-
-    return NULL_LITERAL;
+    detail::PhaseScope phase(Phase::Emit);
+    std::string out;
+    ToonEncoder(out, options, getMaxDepth()).encode(value);
+    phase.setBytes(out.size());
+    return out;
 }
 
-Value decode(const std::string& input, bool strict) {
+Value decode(std::string input, bool strict [[maybe_unused]]) {
+    detail::PhaseScope phase(Phase::Parse, input.size());
     if (input.empty()) {
         return Object{};
     }
@@ -336,9 +402,115 @@ Value decode(const std::string& input, bool strict) {
     } catch (...) {
     }
 
-    return Value(input);
+    return Value(std::move(input));
 }
 
+namespace detail {
+
+Value parseToon(std::string_view toon, bool strict) {
+    return decode(std::string(toon), strict);
+}
+
+void writeToon(const Value& value, const EncoderOptions& options, size_t maxDepth, std::string& out) {
+    PhaseScope phase(Phase::Emit);
+    const size_t start = out.size();
+    ToonEncoder(out, options, maxDepth).encode(value);
+    phase.setBytes(out.size() - start);
+}
+
+void ToonArrayLayout::add(const Value& item) {
+    if (length++ == 0 && item.isObject()) {
+        for (const auto& [field, _] : item.asObject()) {
+            fields.push_back(field);
+        }
+    }
+    primitives = primitives && item.isPrimitive();
+    objects = objects && item.isObject();
+    if (objects && uniform && length > 1) {
+        const Object& obj = item.asObject();
+        uniform = obj.size() == fields.size() &&
+                  std::all_of(fields.begin(), fields.end(), [&](const std::string& field) {
+                      return obj.find(field) != obj.end();
+                  });
+    }
+}
+
+ToonArrayWriter::ToonArrayWriter(const std::string& key, const ToonArrayLayout& layout,
+                                 const EncoderOptions& options, size_t maxDepth)
+    : layout_(layout), options_(options), maxDepth_(maxDepth) {
+    for (const std::string& field : layout_.fields) {
+        fieldRefs_.push_back(&field);
+    }
+    // Mirrors the choices ToonEncoder makes for a whole array
+    if (layout_.length == 0) {
+        header_ = key + "[0]{}:";
+    } else if (layout_.primitives) {
+        header_ = key;
+        appendLength(header_, layout_.length);
+        header_ += COLON;
+        header_ += SPACE;
+    } else if (layout_.objects && layout_.uniform) {
+        header_ = key;
+        appendLength(header_, layout_.length);
+        header_ += OPEN_BRACE;
+        for (size_t i = 0; i < fieldRefs_.size(); ++i) {
+            if (i > 0) {
+                header_ += static_cast<char>(options_.delimiter);
+            }
+            header_ += *fieldRefs_[i];
+        }
+        header_ += CLOSE_BRACE;
+        header_ += COLON;
+        header_ += NEWLINE;
+    } else {
+        header_ = key;
+        appendLength(header_, layout_.length);
+        header_ += COLON;
+        header_ += NEWLINE;
+    }
+}
+
+void ToonArrayWriter::begin(std::string& out) {
+    out += header_;
+}
+
+void ToonArrayWriter::add(const Value& item, std::string& out) {
+    PhaseScope phase(Phase::Emit);
+    const size_t start = out.size();
+    const bool first = written_++ == 0;
+    if (layout_.primitives) {
+        if (!first) {
+            out += static_cast<char>(options_.delimiter);
+        }
+        appendPrimitive(out, item.asPrimitive(), options_.delimiter);
+    } else {
+        if (!first) {
+            out += NEWLINE;
+        }
+        if (layout_.objects && layout_.uniform) {
+            encodeTabularRow(out, item.asObject(), fieldRefs_, options_, 0);
+        } else if (layout_.objects) {
+            ToonEncoder(out, options_, maxDepth_).encodeListItem(item, 0);
+        } else {
+            ToonEncoder(out, options_, maxDepth_).encodeItem(item, 0);
+        }
+    }
+    phase.setBytes(out.size() - start);
+}
+
+void ToonArrayWriter::end(std::string& out) {
+    if (written_ != layout_.length) {
+        throw std::runtime_error("TOON array changed between passes: expected " + std::to_string(layout_.length) +
+                                 " items, wrote " + std::to_string(written_));
+    }
+    if (written_ > 0 && !layout_.primitives && !layout_.objects) {
+        // Mixed arrays end every item with a newline, as ToonEncoder does
+        out += NEWLINE;
+    }
+}
+
+} // namespace detail
+
 void encodeToFile(const Value& value, const std::string& outputFile, const EncoderOptions& options) {
     writeStringToFile(encode(value, options), outputFile);
 }
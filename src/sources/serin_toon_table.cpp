@@ -0,0 +1,446 @@
+#include "serin.h"
+#include "serin_internal.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+
+namespace serin {
+
+namespace {
+
+using FilterOp = Path::FilterOp;
+
+constexpr char DOUBLE_QUOTE = '"';
+constexpr char BACKSLASH = '\\';
+constexpr char NEWLINE = '\n';
+
+std::runtime_error tableError(size_t line, const std::string& message) {
+    return std::runtime_error("TOON table error at line " + std::to_string(line) + ": " + message);
+}
+
+bool isQuoted(std::string_view cell) {
+    return cell.size() >= 2 && cell.front() == DOUBLE_QUOTE && cell.back() == DOUBLE_QUOTE;
+}
+
+// Unescapes the inside of a quoted cell into `out`.
+void unescape(std::string_view inner, std::string& out) {
+    out.clear();
+    out.reserve(inner.size());
+    for (size_t i = 0; i < inner.size(); ++i) {
+        char c = inner[i];
+        if (c == BACKSLASH && i + 1 < inner.size()) {
+            c = inner[++i];
+            switch (c) {
+                case 'n': c = '\n'; break;
+                case 't': c = '\t'; break;
+                case 'r': c = '\r'; break;
+                default: break;
+            }
+        }
+        out += c;
+    }
+}
+
+// Decodes an unquoted, non-string cell. Returns false for plain text.
+bool decodeLiteral(std::string_view cell, Primitive& out) {
+    if (cell == "true") { out = Primitive(true); return true; }
+    if (cell == "false") { out = Primitive(false); return true; }
+    if (cell == "null") { out = Primitive(nullptr); return true; }
+    if (cell.empty()) {
+        return false;
+    }
+
+    const char* end = cell.data() + cell.size();
+    int64_t integer = 0;
+    auto result = std::from_chars(cell.data(), end, integer);
+    if (result.ec == std::errc() && result.ptr == end) {
+        out = Primitive(integer);
+        return true;
+    }
+    double number = 0;
+    result = std::from_chars(cell.data(), end, number);
+    if (result.ec == std::errc() && result.ptr == end) {
+        out = Primitive(number);
+        return true;
+    }
+    return false;
+}
+
+bool compareText(std::string_view text, FilterOp op, const Primitive& literal) {
+    if (!literal.isString()) {
+        // Mixed kinds are never equal
+        return op == FilterOp::NotEqual;
+    }
+    const int order = text.compare(literal.getString());
+    return detail::orderSatisfies(order < 0 ? -1 : (order > 0 ? 1 : 0), op);
+}
+
+// Splits a header field list on `delimiter`, unquoting quoted names.
+std::vector<std::string> splitFields(std::string_view list, char delimiter) {
+    std::vector<std::string> fields;
+    std::string field;
+    size_t pos = 0;
+    while (pos <= list.size()) {
+        size_t end = pos;
+        if (end < list.size() && list[end] == DOUBLE_QUOTE) {
+            ++end;
+            while (end < list.size() && list[end] != DOUBLE_QUOTE) {
+                end += list[end] == BACKSLASH ? 2 : 1;
+            }
+            end = std::min(end + 1, list.size());
+        }
+        end = std::min(list.find(delimiter, end), list.size());
+        const std::string name = trim(list.substr(pos, end - pos));
+        if (isQuoted(name)) {
+            unescape(std::string_view(name).substr(1, name.size() - 2), field);
+            fields.push_back(field);
+        } else {
+            fields.push_back(name);
+        }
+        pos = end + 1;
+    }
+    return fields;
+}
+
+} // namespace
+
+namespace detail {
+
+StructureSink::Scalar toonScalarKind(std::string_view token) {
+    using Scalar = StructureSink::Scalar;
+    Primitive literal;
+    if (!decodeLiteral(token, literal)) {
+        return Scalar::String;
+    }
+    if (literal.isInt()) {
+        return Scalar::Int;
+    }
+    if (literal.isDouble()) {
+        return Scalar::Double;
+    }
+    return literal.isBool() ? Scalar::Bool : Scalar::Null;
+}
+
+} // namespace detail
+
+// =====================
+// Row
+// =====================
+
+Primitive ToonTableReader::Row::value(size_t column) const {
+    const std::string_view cell = cells_.at(column);
+    if (isQuoted(cell)) {
+        std::string text;
+        unescape(cell.substr(1, cell.size() - 2), text);
+        return Primitive(std::move(text));
+    }
+    Primitive literal;
+    if (decodeLiteral(cell, literal)) {
+        return literal;
+    }
+    return Primitive(std::string(cell));
+}
+
+// =====================
+// Reader
+// =====================
+
+struct ToonTableReader::Impl {
+    struct Predicate {
+        size_t field;
+        FilterOp op;
+        Primitive literal;
+    };
+
+    explicit Impl(const std::string& filename) : file(filename), input(file.view()) {}
+
+    // Finds the header of table `wanted` (any table when empty).
+    void readHeader(std::string_view wanted) {
+        size_t pos = 0;
+        size_t line = 0;
+        while (pos < input.size()) {
+            size_t end = input.find(NEWLINE, pos);
+            if (end == std::string_view::npos) {
+                end = input.size();
+            }
+            ++line;
+            if (parseHeader(input.substr(pos, end - pos), wanted)) {
+                firstRow = std::min(end + 1, input.size());
+                firstLine = line + 1;
+                columns = fields;
+                slots.resize(fields.size());
+                for (size_t i = 0; i < fields.size(); ++i) {
+                    slots[i] = static_cast<int>(i);
+                }
+                rewind();
+                return;
+            }
+            pos = end + 1;
+        }
+        throw std::runtime_error(wanted.empty() ? std::string("No tabular array found")
+                                                : "No tabular array named '" + std::string(wanted) + "'");
+    }
+
+    // Parses `key[N]{f1,f2,...}:` (optionally after a list dash).
+    bool parseHeader(std::string_view text, std::string_view wanted) {
+        if (!text.empty() && text.back() == '\r') {
+            text.remove_suffix(1);
+        }
+        size_t indent = 0;
+        while (indent < text.size() && text[indent] == ' ') {
+            ++indent;
+        }
+        std::string_view rest = text.substr(indent);
+        if (rest.size() >= 2 && rest[0] == '-' && rest[1] == ' ') {
+            rest.remove_prefix(2);
+        }
+        while (!rest.empty() && rest.back() == ' ') {
+            rest.remove_suffix(1);
+        }
+        if (rest.size() < 2 || rest.substr(rest.size() - 2) != "}:") {
+            return false;
+        }
+
+        const size_t open = rest.find('[');
+        const size_t close = rest.find(']', open);
+        const size_t brace = rest.find('{', close);
+        if (open == std::string_view::npos || close == std::string_view::npos ||
+            brace != close + 1) {
+            return false;
+        }
+
+        std::string name = trim(rest.substr(0, open));
+        if (isQuoted(name)) {
+            std::string unquoted;
+            unescape(std::string_view(name).substr(1, name.size() - 2), unquoted);
+            name = std::move(unquoted);
+        }
+        if (!wanted.empty() && name != wanted) {
+            return false;
+        }
+
+        std::string_view length = rest.substr(open + 1, close - open - 1);
+        char marker = '\0';
+        if (!length.empty() && (length.back() == '|' || length.back() == '\t' || length.back() == ',')) {
+            marker = length.back();
+            length.remove_suffix(1);
+        }
+        size_t count = 0;
+        const auto result = std::from_chars(length.data(), length.data() + length.size(), count);
+        if (length.empty() || result.ec != std::errc() || result.ptr != length.data() + length.size()) {
+            return false;
+        }
+
+        const std::string_view list = rest.substr(brace + 1, rest.size() - brace - 3);
+        if (marker == '\0') {
+            // Without a marker the delimiter is whichever one separates the field names
+            marker = list.find('\t') != std::string_view::npos ? '\t'
+                   : list.find('|') != std::string_view::npos ? '|'
+                   : ',';
+        }
+
+        key = std::move(name);
+        declared = count;
+        delimiter = marker;
+        headerIndent = indent;
+        fields = splitFields(list, delimiter);
+        return true;
+    }
+
+    void rewind() {
+        pos = firstRow;
+        line = firstLine;
+        scanned = 0;
+    }
+
+    size_t fieldIndex(std::string_view field) const {
+        const auto it = std::find(fields.begin(), fields.end(), field);
+        if (it == fields.end()) {
+            throw std::runtime_error("Table '" + key + "' has no field '" + std::string(field) + "'");
+        }
+        return static_cast<size_t>(it - fields.begin());
+    }
+
+    bool accepts(size_t field, std::string_view cell) {
+        for (const Predicate& predicate : predicates) {
+            if (predicate.field != field) {
+                continue;
+            }
+            bool ok = false;
+            if (isQuoted(cell)) {
+                std::string_view inner = cell.substr(1, cell.size() - 2);
+                if (inner.find(BACKSLASH) != std::string_view::npos) {
+                    unescape(inner, scratch);
+                    inner = scratch;
+                }
+                ok = compareText(inner, predicate.op, predicate.literal);
+            } else if (decodeLiteral(cell, literal)) {
+                ok = detail::compareFilter(literal, predicate.op, predicate.literal);
+            } else {
+                ok = compareText(cell, predicate.op, predicate.literal);
+            }
+            if (!ok) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Tokenises the row at `pos`. Returns false when the row is rejected; the
+    // cursor is left at the start of the next line either way.
+    bool readRow(Row& row) {
+        const size_t lineEnd = std::min(input.find(NEWLINE, pos), input.size());
+        size_t cursor = pos;
+        size_t field = 0;
+        row.cells_.assign(columns.size(), std::string_view());
+        row.line_ = line;
+
+        auto finish = [&](bool accepted) {
+            pos = std::min(lineEnd + 1, input.size());
+            ++line;
+            return accepted;
+        };
+
+        for (;;) {
+            while (cursor < lineEnd && input[cursor] == ' ') {
+                ++cursor;
+            }
+            const size_t start = cursor;
+            if (cursor < lineEnd && input[cursor] == DOUBLE_QUOTE) {
+                ++cursor;
+                while (cursor < lineEnd && input[cursor] != DOUBLE_QUOTE) {
+                    cursor += input[cursor] == BACKSLASH ? 2 : 1;
+                }
+                cursor = std::min(cursor + 1, lineEnd);
+            }
+            while (cursor < lineEnd && input[cursor] != delimiter) {
+                ++cursor;
+            }
+            size_t end = cursor;
+            while (end > start && (input[end - 1] == ' ' || input[end - 1] == '\r')) {
+                --end;
+            }
+            const std::string_view cell = input.substr(start, end - start);
+
+            if (field >= fields.size()) {
+                throw tableError(line, "row has more than " + std::to_string(fields.size()) + " values");
+            }
+            if (!predicates.empty() && !accepts(field, cell)) {
+                return finish(false);
+            }
+            if (slots[field] >= 0) {
+                row.cells_[static_cast<size_t>(slots[field])] = cell;
+            }
+            ++field;
+            if (cursor >= lineEnd) {
+                break;
+            }
+            ++cursor; // delimiter
+        }
+
+        if (field != fields.size()) {
+            throw tableError(line, "row has " + std::to_string(field) + " values, expected " +
+                                       std::to_string(fields.size()));
+        }
+        return finish(true);
+    }
+
+    bool next(Row& row) {
+        while (scanned < declared) {
+            size_t indent = 0;
+            while (pos + indent < input.size() && input[pos + indent] == ' ') {
+                ++indent;
+            }
+            const size_t rowStart = pos + indent;
+            if (rowStart >= input.size() || input[rowStart] == NEWLINE || indent <= headerIndent) {
+                throw tableError(line, "table '" + key + "' declares " + std::to_string(declared) +
+                                           " rows but has " + std::to_string(scanned));
+            }
+            ++scanned;
+            if (readRow(row)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    MappedFile file;
+    std::string_view input;
+
+    std::string key;
+    size_t declared = 0;
+    char delimiter = ',';
+    size_t headerIndent = 0;
+    std::vector<std::string> fields;
+    std::vector<std::string> columns;
+    std::vector<int> slots; // output column for each field, or -1
+    std::vector<Predicate> predicates;
+
+    size_t firstRow = 0;
+    size_t firstLine = 0;
+    size_t pos = 0;
+    size_t line = 0;
+    size_t scanned = 0;
+
+    Primitive literal;
+    std::string scratch;
+};
+
+ToonTableReader::ToonTableReader(const std::string& filename, std::string_view key)
+    : impl_(std::make_unique<Impl>(filename)) {
+    impl_->readHeader(key);
+}
+
+ToonTableReader::~ToonTableReader() = default;
+ToonTableReader::ToonTableReader(ToonTableReader&&) noexcept = default;
+ToonTableReader& ToonTableReader::operator=(ToonTableReader&&) noexcept = default;
+
+const std::string& ToonTableReader::key() const { return impl_->key; }
+size_t ToonTableReader::declaredRows() const { return impl_->declared; }
+char ToonTableReader::delimiter() const { return impl_->delimiter; }
+const std::vector<std::string>& ToonTableReader::fields() const { return impl_->fields; }
+const std::vector<std::string>& ToonTableReader::columns() const { return impl_->columns; }
+size_t ToonTableReader::rowsScanned() const { return impl_->scanned; }
+
+void ToonTableReader::select(const std::vector<std::string>& columns) {
+    std::vector<int> slots(impl_->fields.size(), -1);
+    for (size_t i = 0; i < columns.size(); ++i) {
+        int& slot = slots[impl_->fieldIndex(columns[i])];
+        if (slot >= 0) {
+            throw std::runtime_error("Column '" + columns[i] + "' is selected twice");
+        }
+        slot = static_cast<int>(i);
+    }
+    impl_->slots = std::move(slots);
+    impl_->columns = columns;
+}
+
+void ToonTableReader::where(const std::string& field, Path::FilterOp op, Primitive literal) {
+    if (op == Path::FilterOp::Exists) {
+        throw std::runtime_error("Table predicates need a comparison operator");
+    }
+    impl_->predicates.push_back(Impl::Predicate{impl_->fieldIndex(field), op, std::move(literal)});
+}
+
+void ToonTableReader::where(std::string_view expression) {
+    // Reuse the JSONPath filter grammar: `field op literal` is `?@.field op literal`
+    const Path filter("$[?@." + std::string(expression) + "]");
+    const auto& steps = filter.steps();
+    if (steps.size() != 1 || steps.front().filterKeys.size() != 1) {
+        throw std::runtime_error("Invalid table predicate: " + std::string(expression));
+    }
+    const Path::Step& step = steps.front();
+    where(step.filterKeys.front().first, step.op, step.literal);
+}
+
+bool ToonTableReader::next(Row& row) {
+    return impl_->next(row);
+}
+
+void ToonTableReader::rewind() {
+    impl_->rewind();
+}
+
+} // namespace serin
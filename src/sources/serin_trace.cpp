@@ -0,0 +1,222 @@
+#include "serin.h"
+#include "serin_internal.h"
+#include "utils.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+namespace serin {
+
+namespace {
+
+std::atomic<bool> tracingOn{false};
+std::mutex callbackMutex;
+std::shared_ptr<const TraceCallback> installedCallback;
+
+thread_local detail::TraceBatch* currentBatch = nullptr;
+
+uint32_t threadNumber() {
+    static std::atomic<uint32_t> next{1};
+    thread_local const uint32_t number = next.fetch_add(1, std::memory_order_relaxed);
+    return number;
+}
+
+void deliver(const TraceEvent& event) {
+    std::shared_ptr<const TraceCallback> callback;
+    {
+        std::lock_guard<std::mutex> lock(callbackMutex);
+        callback = installedCallback;
+    }
+    if (callback) {
+        (*callback)(event);
+    }
+}
+
+void install(TraceCallback callback) {
+    std::shared_ptr<const TraceCallback> installed;
+    if (callback) {
+        installed = std::make_shared<const TraceCallback>(std::move(callback));
+    }
+    std::lock_guard<std::mutex> lock(callbackMutex);
+    installedCallback = std::move(installed);
+    tracingOn.store(tracingAvailable() && installedCallback != nullptr, std::memory_order_relaxed);
+}
+
+} // namespace
+
+namespace detail {
+
+bool tracing() {
+#ifdef SERIN_TRACING
+    return tracingOn.load(std::memory_order_relaxed);
+#else
+    return false;
+#endif
+}
+
+uint64_t traceClock() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+void traceEvent(Phase phase, uint64_t start, size_t bytes) {
+    const uint64_t duration = traceClock() - start;
+    if (currentBatch) {
+        currentBatch->add(phase, duration, bytes);
+        return;
+    }
+    deliver(TraceEvent{phase, start, duration, bytes, threadNumber()});
+}
+
+TraceBatch::TraceBatch() : outer_(currentBatch) {
+    if (tracing()) {
+        start_ = traceClock();
+        currentBatch = this;
+    }
+}
+
+TraceBatch::~TraceBatch() {
+    if (currentBatch != this) {
+        return;
+    }
+    currentBatch = outer_;
+    uint64_t start = start_;
+    for (size_t i = 0; i < PHASE_COUNT; ++i) {
+        const Total& total = totals_[i];
+        if (total.count == 0) {
+            continue;
+        }
+        const TraceEvent event{static_cast<Phase>(i), start, total.durationNs, total.bytes, threadNumber()};
+        if (outer_) {
+            outer_->add(event.phase, event.durationNs, event.bytes);
+        } else {
+            deliver(event);
+        }
+        start += total.durationNs;
+    }
+}
+
+void TraceBatch::add(Phase phase, uint64_t duration, size_t bytes) {
+    Total& total = totals_[static_cast<size_t>(phase)];
+    total.durationNs += duration;
+    total.bytes += bytes;
+    ++total.count;
+}
+
+} // namespace detail
+
+void setTraceCallback(TraceCallback callback) {
+    install(std::move(callback));
+}
+
+bool tracingAvailable() {
+#ifdef SERIN_TRACING
+    return true;
+#else
+    return false;
+#endif
+}
+
+struct TraceRecorder::Impl {
+    mutable std::mutex mutex;
+    std::vector<TraceEvent> events;
+    uint64_t origin = 0;
+    bool recording = false;
+};
+
+TraceRecorder::TraceRecorder() : impl_(std::make_shared<Impl>()) {}
+
+TraceRecorder::~TraceRecorder() {
+    stop();
+}
+
+void TraceRecorder::start() {
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        if (impl_->origin == 0) {
+            impl_->origin = detail::traceClock();
+        }
+        impl_->recording = true;
+    }
+    std::weak_ptr<Impl> weak = impl_;
+    install([weak](const TraceEvent& event) {
+        if (auto impl = weak.lock()) {
+            std::lock_guard<std::mutex> lock(impl->mutex);
+            if (impl->recording) {
+                impl->events.push_back(event);
+            }
+        }
+    });
+}
+
+void TraceRecorder::stop() {
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        if (!impl_->recording) {
+            return;
+        }
+        impl_->recording = false;
+    }
+    install(nullptr);
+}
+
+void TraceRecorder::clear() {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->events.clear();
+    impl_->origin = impl_->recording ? detail::traceClock() : 0;
+}
+
+std::vector<TraceEvent> TraceRecorder::events() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->events;
+}
+
+std::array<TraceRecorder::Totals, PHASE_COUNT> TraceRecorder::totals() const {
+    std::array<Totals, PHASE_COUNT> totals{};
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    for (const auto& event : impl_->events) {
+        Totals& total = totals[static_cast<size_t>(event.phase)];
+        ++total.count;
+        total.durationNs += event.durationNs;
+        total.bytes += event.bytes;
+    }
+    return totals;
+}
+
+std::string TraceRecorder::chromeTrace() const {
+    uint64_t origin = 0;
+    const std::vector<TraceEvent> recorded = [&] {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        origin = impl_->origin;
+        return impl_->events;
+    }();
+
+    Array traceEvents;
+    traceEvents.reserve(recorded.size());
+    for (const auto& event : recorded) {
+        Object args;
+        args.emplace("bytes", Value(Primitive(static_cast<int64_t>(event.bytes))));
+        Object entry;
+        entry.emplace("name", Value(phaseName(event.phase)));
+        entry.emplace("cat", Value("serin"));
+        entry.emplace("ph", Value("X"));
+        entry.emplace("ts", Value(static_cast<double>(event.startNs - std::min(origin, event.startNs)) / 1000.0));
+        entry.emplace("dur", Value(static_cast<double>(event.durationNs) / 1000.0));
+        entry.emplace("pid", Value(Primitive(int64_t{1})));
+        entry.emplace("tid", Value(Primitive(static_cast<int64_t>(event.thread))));
+        entry.emplace("args", Value(std::move(args)));
+        traceEvents.push_back(Value(std::move(entry)));
+    }
+    Object root;
+    root.emplace("traceEvents", Value(std::move(traceEvents)));
+    root.emplace("displayTimeUnit", Value("ms"));
+    return dumpsJson(Value(std::move(root)), 0);
+}
+
+void TraceRecorder::writeChromeTrace(const std::string& filename) const {
+    writeStringToFile(chromeTrace(), filename);
+}
+
+} // namespace serin
@@ -0,0 +1,834 @@
+#include "serin.h"
+#include "serin_internal.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace serin {
+
+namespace {
+
+constexpr size_t NONE = std::string_view::npos;
+
+ValidationResult failure(std::string_view content, size_t offset, std::string message) {
+    ValidationResult result;
+    result.valid = false;
+    result.offset = std::min(offset, content.size());
+    result.line = 1 + static_cast<size_t>(std::count(content.begin(), content.begin() + result.offset, '\n'));
+    const size_t lineStart = content.substr(0, result.offset).rfind('\n');
+    result.column = result.offset - (lineStart == NONE ? 0 : lineStart + 1) + 1;
+    result.message = std::move(message);
+    return result;
+}
+
+std::string_view trimView(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+std::string depthMessage(size_t maxDepth) {
+    return "nesting exceeds the maximum depth of " + std::to_string(maxDepth);
+}
+
+// Splits the content into lines, without their line breaks.
+class LineCursor {
+public:
+    explicit LineCursor(std::string_view content) : content_(content) {}
+
+    bool next(size_t& offset, std::string_view& text) {
+        if (pos_ >= content_.size()) {
+            return false;
+        }
+        size_t end = content_.find('\n', pos_);
+        if (end == NONE) {
+            end = content_.size();
+        }
+        offset = pos_;
+        text = content_.substr(pos_, end - pos_);
+        if (!text.empty() && text.back() == '\r') {
+            text.remove_suffix(1);
+        }
+        pos_ = end + 1;
+        return true;
+    }
+
+private:
+    std::string_view content_;
+    size_t pos_ = 0;
+};
+
+// Base for the line tokenisers: keeps the first error and reports the
+// structure found to an optional sink.
+class Checker {
+protected:
+    using Scalar = detail::StructureSink::Scalar;
+
+    Checker(std::string_view content, size_t maxDepth, detail::StructureSink* sink)
+        : content_(content), maxDepth_(maxDepth), sink_(sink) {}
+
+    bool fail(size_t offset, std::string message) {
+        result_ = failure(content_, offset, std::move(message));
+        return false;
+    }
+
+    std::string_view content_;
+    size_t maxDepth_;
+    detail::StructureSink* sink_;
+    ValidationResult result_;
+};
+
+// =====================
+// JSON
+// =====================
+
+// Offset of the first bracket nested deeper than `maxDepth`.
+size_t findTooDeep(std::string_view content, size_t maxDepth) {
+    size_t depth = 0;
+    for (size_t i = 0; i < content.size(); ++i) {
+        switch (content[i]) {
+            case '"':
+                while (++i < content.size() && content[i] != '"') {
+                    i += content[i] == '\\';
+                }
+                break;
+            case '[':
+            case '{':
+                if (++depth > maxDepth) {
+                    return i;
+                }
+                break;
+            case ']':
+            case '}':
+                --depth;
+                break;
+            default:
+                break;
+        }
+    }
+    return 0;
+}
+
+ValidationResult validateJson(std::string_view content, size_t maxDepth) {
+    yyjson_read_err err;
+    yyjson_doc* doc = yyjson_read_opts(const_cast<char*>(content.data()), content.size(), 0, nullptr, &err);
+    if (!doc) {
+        return failure(content, err.pos, err.msg);
+    }
+    std::unique_ptr<yyjson_doc, decltype(&yyjson_doc_free)> guard(doc, &yyjson_doc_free);
+
+    // Values are stored in document order with each container directly
+    // followed by its children, so one pass with the end of every open
+    // container gives the nesting depth.
+    std::vector<yyjson_val*> open;
+    yyjson_val* val = yyjson_doc_get_root(doc);
+    yyjson_val* const end = val + yyjson_doc_get_val_count(doc);
+    for (; val < end; ++val) {
+        while (!open.empty() && val >= open.back()) {
+            open.pop_back();
+        }
+        if (yyjson_is_ctn(val)) {
+            open.push_back(unsafe_yyjson_get_next(val));
+            if (open.size() > maxDepth) {
+                return failure(content, findTooDeep(content, maxDepth), depthMessage(maxDepth));
+            }
+        }
+    }
+    return {};
+}
+
+// =====================
+// YAML
+// =====================
+
+// Follows the block rules of the YAML loader and reports input it would
+// misread or silently drop.
+class YamlChecker : public Checker {
+public:
+    YamlChecker(std::string_view content, size_t maxDepth, detail::StructureSink* sink)
+        : Checker(content, maxDepth, sink) {}
+
+    ValidationResult run() {
+        LineCursor cursor(content_);
+        size_t offset;
+        std::string_view text;
+        while (cursor.next(offset, text)) {
+            text = stripComment(text);
+            size_t indent = 0;
+            while (indent < text.size() && text[indent] == ' ') {
+                ++indent;
+            }
+            const std::string_view content = trimView(text.substr(indent));
+            if (content.empty()) {
+                continue;
+            }
+            if (text[indent] == '\t') {
+                return failure(content_, offset + indent, "tabs are not allowed in indentation");
+            }
+            if (!line(static_cast<int>(indent), content, offset + indent)) {
+                return result_;
+            }
+        }
+        if (pending_ && sink_) {
+            sink_->scalar(Scalar::Null, {});
+        }
+        while (!blocks_.empty()) {
+            pop();
+        }
+        return {};
+    }
+
+private:
+    struct Block {
+        enum class Kind { Mapping, Sequence, Scalar };
+        Kind kind;
+        int indent;
+    };
+
+    // Same comment rule as the loader: '#' outside quotes.
+    static std::string_view stripComment(std::string_view text) {
+        char quote = '\0';
+        for (size_t i = 0; i < text.size(); ++i) {
+            const char c = text[i];
+            if ((c == '"' || c == '\'') && (i == 0 || text[i - 1] != '\\')) {
+                if (quote == '\0') {
+                    quote = c;
+                } else if (quote == c) {
+                    quote = '\0';
+                }
+            }
+            if (quote == '\0' && c == '#') {
+                return text.substr(0, i);
+            }
+        }
+        return text;
+    }
+
+    bool line(int indent, std::string_view text, size_t offset) {
+        if (!started_) {
+            started_ = true;
+            return open(indent, text, offset);
+        }
+
+        if (pending_) {
+            pending_ = false;
+            // A key's sequence may sit at the key's own indent
+            if (indent > pendingIndent_ || (pendingKey_ && indent == pendingIndent_ && text.front() == '-')) {
+                return open(indent, text, offset);
+            }
+            // A key or item with nothing nested below it is null
+            if (sink_) {
+                sink_->scalar(Scalar::Null, {});
+            }
+        }
+
+        bool dedented = false;
+        while (!blocks_.empty() && blocks_.back().indent > indent) {
+            pop();
+            dedented = true;
+        }
+        if (blocks_.empty() || (dedented && blocks_.back().indent < indent)) {
+            return fail(offset, "indentation does not match any enclosing block");
+        }
+        if (text.front() != '-' && blocks_.size() > 1 && blocks_.back().kind == Block::Kind::Sequence &&
+            blocks_[blocks_.size() - 2].indent == indent) {
+            // The end of a sequence written at its key's indent
+            pop();
+        }
+        const Block& block = blocks_.back();
+        if (block.indent < indent) {
+            return fail(offset, "unexpected indentation");
+        }
+        switch (block.kind) {
+            case Block::Kind::Sequence:
+                if (text.front() != '-') {
+                    return fail(offset, "expected a '-' sequence item");
+                }
+                return item(indent, text, offset);
+            case Block::Kind::Mapping:
+                if (text.front() == '-') {
+                    return fail(offset, "sequence items must be indented below their key");
+                }
+                if (text.find(':') == NONE) {
+                    return fail(offset, "expected 'key: value'");
+                }
+                return member(indent, text, offset);
+            case Block::Kind::Scalar:
+                break;
+        }
+        return fail(offset, "multi-line scalars are not supported");
+    }
+
+    // Starts the block whose first line is `text`.
+    bool open(int indent, std::string_view text, size_t offset) {
+        if (text.front() == '-') {
+            if (!push(Block::Kind::Sequence, indent, offset)) {
+                return false;
+            }
+            return item(indent, text, offset);
+        }
+        if (text.find(':') != NONE) {
+            if (!push(Block::Kind::Mapping, indent, offset)) {
+                return false;
+            }
+            return member(indent, text, offset);
+        }
+        blocks_.push_back(Block{Block::Kind::Scalar, indent});
+        return scalar(text, offset);
+    }
+
+    bool item(int indent, std::string_view text, size_t offset) {
+        const std::string_view rest = trimView(text.substr(1));
+        if (rest.empty()) {
+            pending_ = true;
+            pendingKey_ = false;
+            pendingIndent_ = indent;
+            return true;
+        }
+        // The loader reads inline content as a line just inside the item
+        return open(indent + 2, rest, offset + static_cast<size_t>(rest.data() - text.data()));
+    }
+
+    bool member(int indent, std::string_view text, size_t offset) {
+        const size_t colon = text.find(':');
+        const std::string_view key = trimView(text.substr(0, colon));
+        if (key.empty()) {
+            return fail(offset, "empty mapping key");
+        }
+        if (!keys_[containers_ - 1].insert(key).second) {
+            return fail(offset, "duplicate key '" + std::string(key) + "'");
+        }
+        if (sink_) {
+            sink_->key(key);
+        }
+        const std::string_view rest = trimView(text.substr(colon + 1));
+        if (rest.empty()) {
+            pending_ = true;
+            pendingKey_ = true;
+            pendingIndent_ = indent;
+            return true;
+        }
+        return scalar(rest, offset + static_cast<size_t>(rest.data() - text.data()));
+    }
+
+    bool scalar(std::string_view token, size_t offset) {
+        const char quote = token.front();
+        if (quote != '"' && quote != '\'') {
+            if (sink_) {
+                sink_->scalar(detail::yamlScalarKind(token), token);
+            }
+            return true;
+        }
+        for (size_t i = 1; i < token.size(); ++i) {
+            if (quote == '"' && token[i] == '\\') {
+                ++i;
+            } else if (token[i] == quote) {
+                if (quote == '\'' && i + 1 < token.size() && token[i + 1] == '\'') {
+                    ++i;
+                    continue;
+                }
+                if (i + 1 != token.size()) {
+                    return fail(offset + i + 1, "unexpected text after a quoted scalar");
+                }
+                if (sink_) {
+                    sink_->scalar(Scalar::String, token.substr(1, i - 1));
+                }
+                return true;
+            }
+        }
+        return fail(offset, "unterminated quoted scalar");
+    }
+
+    bool push(Block::Kind kind, int indent, size_t offset) {
+        if (++containers_ > maxDepth_) {
+            return fail(offset, depthMessage(maxDepth_));
+        }
+        blocks_.push_back(Block{kind, indent});
+        if (keys_.size() < containers_) {
+            keys_.emplace_back();
+        }
+        keys_[containers_ - 1].clear();
+        if (sink_) {
+            kind == Block::Kind::Mapping ? sink_->beginObject() : sink_->beginArray();
+        }
+        return true;
+    }
+
+    void pop() {
+        if (blocks_.back().kind != Block::Kind::Scalar) {
+            --containers_;
+            if (sink_) {
+                sink_->end();
+            }
+        }
+        blocks_.pop_back();
+    }
+
+    std::vector<Block> blocks_;
+    // Keys seen by each open mapping; the sets keep their buckets between mappings
+    std::vector<std::unordered_set<std::string_view>> keys_;
+    size_t containers_ = 0;
+    bool started_ = false;
+    bool pending_ = false; // the last line may be followed by a nested block
+    bool pendingKey_ = false; // ... and it was a key rather than a '-'
+    int pendingIndent_ = 0;
+};
+
+// =====================
+// TOON
+// =====================
+
+// Strict TOON structure: indentation in whole units, well-formed quoting and
+// escapes, and `[N]` / `{fields}` consistent with what follows the header.
+class ToonChecker : public Checker {
+public:
+    ToonChecker(std::string_view content, size_t maxDepth, detail::StructureSink* sink)
+        : Checker(content, maxDepth, sink) {}
+
+    ValidationResult run() {
+        LineCursor cursor(content_);
+        size_t offset;
+        std::string_view text;
+        while (cursor.next(offset, text)) {
+            size_t indent = 0;
+            while (indent < text.size() && text[indent] == ' ') {
+                ++indent;
+            }
+            if (trimView(text.substr(indent)).empty()) {
+                if (blank_ == NONE) {
+                    blank_ = offset;
+                }
+                continue;
+            }
+            if (text[indent] == '\t') {
+                return failure(content_, offset + indent, "tabs are not allowed in indentation");
+            }
+            if (!line(indent, trimView(text.substr(indent)), offset + indent)) {
+                return result_;
+            }
+            blank_ = NONE;
+        }
+        while (!stack_.empty()) {
+            if (!close()) {
+                return result_;
+            }
+        }
+        return {};
+    }
+
+private:
+    struct Context {
+        enum class Kind { Object, Table, List };
+        Kind kind;
+        size_t depth;        // depth of the lines it holds
+        size_t header = 0;   // offset of the array header
+        size_t expected = 0; // declared length
+        size_t seen = 0;
+        size_t fields = 0;
+        char delimiter = ',';
+    };
+
+    bool line(size_t indent, std::string_view text, size_t offset) {
+        if (indent > 0 && unit_ == 0) {
+            unit_ = indent;
+        }
+        if (unit_ > 0 && indent % unit_ != 0) {
+            return fail(offset, "indentation is not a multiple of " + std::to_string(unit_) + " spaces");
+        }
+        const size_t depth = unit_ > 0 ? indent / unit_ : 0;
+
+        if (!started_) {
+            started_ = true;
+            return root(text, offset, depth);
+        }
+        if (rootPrimitive_) {
+            return fail(offset, "unexpected content after the root value");
+        }
+        while (!stack_.empty() && stack_.back().depth > depth) {
+            if (!close()) {
+                return false;
+            }
+        }
+        if (stack_.empty()) {
+            return fail(offset, "unexpected content after the root array");
+        }
+        if (stack_.back().depth < depth) {
+            return fail(offset, "unexpected indentation");
+        }
+
+        switch (stack_.back().kind) {
+            case Context::Kind::Table:
+                return row(text, offset);
+            case Context::Kind::List:
+                return item(text, offset, depth);
+            case Context::Kind::Object:
+                break;
+        }
+        return field(text, offset, depth);
+    }
+
+    bool root(std::string_view text, size_t offset, size_t depth) {
+        if (depth != 0) {
+            return fail(offset, "unexpected indentation");
+        }
+        if (text.front() == '[') {
+            return header(text, offset, 0);
+        }
+        if (isField(text)) {
+            return open(Context{Context::Kind::Object, 0}, offset) && field(text, offset, 0);
+        }
+        rootPrimitive_ = true;
+        return primitive(text, offset);
+    }
+
+    // Ends the innermost context; arrays must hold the declared number of rows or items.
+    bool close() {
+        const Context& context = stack_.back();
+        if (context.kind != Context::Kind::Object && context.seen != context.expected) {
+            const char* what = context.kind == Context::Kind::Table ? " rows" : " items";
+            return fail(context.header, "array declares " + std::to_string(context.expected) + what +
+                                            " but has " + std::to_string(context.seen));
+        }
+        stack_.pop_back();
+        if (sink_) {
+            sink_->end();
+        }
+        return true;
+    }
+
+    bool open(const Context& context, size_t offset) {
+        if (stack_.size() >= maxDepth_) {
+            return fail(offset, depthMessage(maxDepth_));
+        }
+        stack_.push_back(context);
+        if (sink_) {
+            context.kind == Context::Kind::Object ? sink_->beginObject() : sink_->beginArray();
+        }
+        return true;
+    }
+
+    bool row(std::string_view text, size_t offset) {
+        Context& table = stack_.back();
+        if (blank_ != NONE) {
+            return fail(blank_, "blank line inside a tabular array");
+        }
+        if (++table.seen > table.expected) {
+            return fail(offset, "array declares " + std::to_string(table.expected) + " rows but has more");
+        }
+        const size_t fields = table.fields;
+        size_t count = 0;
+        if (sink_) {
+            sink_->beginObject();
+        }
+        if (!values(text, table.delimiter, offset, count, Cells::Row)) {
+            return false;
+        }
+        if (sink_) {
+            sink_->end();
+        }
+        if (count != fields) {
+            return fail(offset, "row has " + std::to_string(count) + " values but the header declares " +
+                                    std::to_string(fields) + " fields");
+        }
+        return true;
+    }
+
+    bool item(std::string_view text, size_t offset, size_t depth) {
+        Context& list = stack_.back();
+        if (text.front() != '-' || (text.size() > 1 && text[1] != ' ')) {
+            return fail(offset, "expected a '- ' list item");
+        }
+        if (++list.seen > list.expected) {
+            return fail(offset, "array declares " + std::to_string(list.expected) + " items but has more");
+        }
+        const std::string_view rest = trimView(text.substr(1));
+        const size_t restOffset = offset + static_cast<size_t>(rest.data() - text.data());
+        if (rest.empty()) {
+            // An object item whose fields start on the next line
+            return open(Context{Context::Kind::Object, depth + 1}, offset);
+        }
+        if (rest.front() == '[') {
+            return header(rest, restOffset, depth);
+        }
+        if (isField(rest)) {
+            // Later fields of an object item sit one level below the dash
+            return open(Context{Context::Kind::Object, depth + 1}, offset) && field(rest, restOffset, depth + 1);
+        }
+        return primitive(rest, restOffset);
+    }
+
+    // `key: value`, `key:` or `key[N]...:` at `depth`.
+    bool field(std::string_view text, size_t offset, size_t depth) {
+        size_t pos = 0;
+        std::string_view key;
+        if (text.front() == '"') {
+            if (!quoted(text, 0, offset, pos)) {
+                return false;
+            }
+            key = text.substr(1, pos - 2);
+        } else {
+            pos = std::min(text.find_first_of(":["), text.size());
+            key = trimView(text.substr(0, pos));
+            if (key.empty()) {
+                return fail(offset, "missing key");
+            }
+        }
+        if (sink_) {
+            sink_->key(key);
+        }
+        if (pos < text.size() && text[pos] == '[') {
+            return header(text.substr(pos), offset + pos, depth);
+        }
+        if (pos >= text.size() || text[pos] != ':') {
+            return fail(offset + pos, "expected ':' after the key");
+        }
+        const std::string_view rest = trimView(text.substr(pos + 1));
+        if (rest.empty()) {
+            return open(Context{Context::Kind::Object, depth + 1}, offset);
+        }
+        return primitive(rest, offset + static_cast<size_t>(rest.data() - text.data()));
+    }
+
+    // `[N]`, `[#N|]`, ... followed by optional `{fields}` and the colon.
+    bool header(std::string_view text, size_t offset, size_t depth) {
+        size_t pos = 1;
+        if (pos < text.size() && text[pos] == '#') {
+            ++pos;
+        }
+        const size_t digits = pos;
+        size_t length = 0;
+        while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+            length = length * 10 + static_cast<size_t>(text[pos++] - '0');
+        }
+        if (pos == digits) {
+            return fail(offset + pos, "expected an array length");
+        }
+        char delimiter = ',';
+        if (pos < text.size() && (text[pos] == '|' || text[pos] == '\t')) {
+            delimiter = text[pos++];
+        }
+        if (pos >= text.size() || text[pos] != ']') {
+            return fail(offset + pos, "expected ']'");
+        }
+        ++pos;
+
+        bool tabular = false;
+        size_t fields = 0;
+        if (pos < text.size() && text[pos] == '{') {
+            size_t close = pos + 1;
+            while (close < text.size() && text[close] != '}') {
+                if (text[close] != '"') {
+                    ++close;
+                } else if (!quoted(text, close, offset, close)) {
+                    return false;
+                }
+            }
+            if (close >= text.size()) {
+                return fail(offset + pos, "unterminated field list");
+            }
+            const std::string_view list = text.substr(pos + 1, close - pos - 1);
+            fields_.clear();
+            if (!list.empty() && !values(list, delimiter, offset + pos + 1, fields, Cells::Names)) {
+                return false;
+            }
+            tabular = true;
+            pos = close + 1;
+        }
+        if (pos >= text.size() || text[pos] != ':') {
+            return fail(offset + pos, "expected ':' after the array header");
+        }
+        const std::string_view rest = trimView(text.substr(pos + 1));
+
+        if (tabular) {
+            if (!rest.empty()) {
+                return fail(offset + pos + 1, "unexpected text after a tabular header");
+            }
+            if (fields == 0 && length > 0) {
+                return fail(offset, "tabular array declares no fields");
+            }
+            return open(Context{Context::Kind::Table, depth + 1, offset, length, 0, fields, delimiter}, offset);
+        }
+        if (!rest.empty() || length == 0) {
+            if (sink_) {
+                sink_->beginArray();
+            }
+            size_t count = 0;
+            const size_t restOffset = offset + static_cast<size_t>(rest.data() - text.data());
+            if (!rest.empty() && !values(rest, delimiter, restOffset, count, Cells::Values)) {
+                return false;
+            }
+            if (count != length) {
+                return fail(offset, "array declares " + std::to_string(length) + " values but has " +
+                                        std::to_string(count));
+            }
+            if (sink_) {
+                sink_->end();
+            }
+            return true;
+        }
+        return open(Context{Context::Kind::List, depth + 1, offset, length, 0, 0, delimiter}, offset);
+    }
+
+    enum class Cells { Names, Values, Row };
+
+    // Checks the delimited field names, inline values or row cells in `list`
+    // and counts them.
+    bool values(std::string_view list, char delimiter, size_t offset, size_t& count, Cells cells) {
+        count = 0;
+        size_t pos = 0;
+        for (;;) {
+            while (pos < list.size() && list[pos] == ' ') {
+                ++pos;
+            }
+            size_t end;
+            std::string_view cell;
+            bool isString = true;
+            if (pos < list.size() && list[pos] == '"') {
+                if (!quoted(list, pos, offset, end)) {
+                    return false;
+                }
+                cell = list.substr(pos + 1, end - pos - 2);
+                pos = end;
+                while (pos < list.size() && list[pos] == ' ') {
+                    ++pos;
+                }
+                if (pos < list.size() && list[pos] != delimiter) {
+                    return fail(offset + pos, "unexpected text after a quoted value");
+                }
+            } else {
+                end = std::min(list.find(delimiter, pos), list.size());
+                cell = trimView(list.substr(pos, end - pos));
+                if (cells == Cells::Names && cell.empty()) {
+                    return fail(offset + pos, "empty field name");
+                }
+                isString = false;
+                pos = end;
+            }
+            if (sink_) {
+                if (cells == Cells::Names) {
+                    fields_.push_back(cell);
+                } else {
+                    if (cells == Cells::Row && count < fields_.size()) {
+                        sink_->key(fields_[count]);
+                    }
+                    sink_->scalar(isString ? Scalar::String : detail::toonScalarKind(cell), cell);
+                }
+            }
+            ++count;
+            if (pos >= list.size()) {
+                return true;
+            }
+            ++pos;
+        }
+    }
+
+    bool primitive(std::string_view token, size_t offset) {
+        if (token.front() != '"') {
+            if (sink_) {
+                sink_->scalar(detail::toonScalarKind(token), token);
+            }
+            return true;
+        }
+        size_t end = 0;
+        if (!quoted(token, 0, offset, end)) {
+            return false;
+        }
+        if (end != token.size()) {
+            return fail(offset + end, "unexpected text after a quoted value");
+        }
+        if (sink_) {
+            sink_->scalar(Scalar::String, token.substr(1, end - 2));
+        }
+        return true;
+    }
+
+    // Checks the quoted string starting at `start`; `end` is set past its closing quote.
+    bool quoted(std::string_view text, size_t start, size_t offset, size_t& end) {
+        for (size_t i = start + 1; i < text.size(); ++i) {
+            if (text[i] == '"') {
+                end = i + 1;
+                return true;
+            }
+            if (text[i] == '\\') {
+                const char escaped = i + 1 < text.size() ? text[i + 1] : '\0';
+                if (escaped != '\\' && escaped != '"' && escaped != 'n' && escaped != 'r' && escaped != 't') {
+                    return fail(offset + i, "invalid escape sequence");
+                }
+                ++i;
+            }
+        }
+        return fail(offset + start, "unterminated string");
+    }
+
+    // Whether `text` starts with a key: a ':' or '[' outside quotes.
+    static bool isField(std::string_view text) {
+        size_t pos = 0;
+        if (text.front() == '"') {
+            pos = 1;
+            while (pos < text.size() && text[pos] != '"') {
+                pos += text[pos] == '\\' ? 2 : 1;
+            }
+            ++pos;
+            return pos < text.size() && (text[pos] == ':' || text[pos] == '[');
+        }
+        return text.find(':') != NONE;
+    }
+
+    std::vector<Context> stack_;
+    std::vector<std::string_view> fields_; // names of the open table, for the sink
+    size_t unit_ = 0;      // spaces per level, from the first indented line
+    size_t blank_ = NONE;  // offset of the blank lines before the current line
+    bool started_ = false;
+    bool rootPrimitive_ = false;
+};
+
+} // namespace
+
+namespace detail {
+
+ValidationResult scanYaml(std::string_view content, size_t maxDepth, StructureSink* sink) {
+    return YamlChecker(content, maxDepth, sink).run();
+}
+
+ValidationResult scanToon(std::string_view content, size_t maxDepth, StructureSink* sink) {
+    return ToonChecker(content, maxDepth, sink).run();
+}
+
+} // namespace detail
+
+// =====================
+// Public API
+// =====================
+
+ValidationResult validate(std::string_view content, Type format) {
+    const size_t maxDepth = getMaxDepth();
+    switch (format) {
+        case Type::JSON:
+            return validateJson(content, maxDepth);
+        case Type::YAML:
+            return detail::scanYaml(content, maxDepth, nullptr);
+        case Type::TOON:
+            return detail::scanToon(content, maxDepth, nullptr);
+        case Type::SERIN_BIN:
+            return detail::scanBinary(content, maxDepth, nullptr);
+        default:
+            throw std::runtime_error("Unsupported format type");
+    }
+}
+
+ValidationResult validateFile(const std::string& filename) {
+    const Type format = detail::typeFromFilename(filename);
+    if (format == Type::UNKOWN) {
+        throw detail::unsupportedExtension(filename);
+    }
+    MappedFile file(filename);
+    return validate(file.view(), format);
+}
+
+} // namespace serin
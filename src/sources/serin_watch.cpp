@@ -0,0 +1,215 @@
+#include "serin.h"
+#include "serin_internal.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#define SERIN_HAS_INOTIFY 1
+#endif
+
+namespace serin {
+
+namespace {
+
+// How long a burst of change events has to go quiet before the file is
+// read, so a save written in several steps is parsed once, complete. A file
+// rewritten without pause is still read once MAX_SETTLE has passed.
+constexpr auto SETTLE = std::chrono::milliseconds(20);
+constexpr auto MAX_SETTLE = std::chrono::milliseconds(250);
+constexpr auto POLL_INTERVAL = std::chrono::milliseconds(500);
+
+} // namespace
+
+struct SnapshotWatcher::Impl {
+    std::string filename;
+    Type format;
+    Snapshot<Value>& snapshot;
+    ErrorCallback onError;
+    Parser parser;
+    std::string content;
+    std::atomic<size_t> reloads{0};
+    std::thread thread;
+
+#ifdef SERIN_HAS_INOTIFY
+    int inotify = -1;
+    int stopPipe[2] = {-1, -1};
+#else
+    std::mutex mutex;
+    std::condition_variable stopped;
+    bool stopping = false;
+#endif
+
+    Impl(const std::string& name, Type type, Snapshot<Value>& target, ErrorCallback callback)
+        : filename(name), format(type), snapshot(target), onError(std::move(callback)) {
+        if (format == Type::UNKOWN) {
+            format = detail::typeFromFilename(filename);
+        }
+        if (format == Type::UNKOWN) {
+            throw detail::unsupportedExtension(filename);
+        }
+    }
+
+    Value parse() {
+        readFileInto(filename, content);
+        return parser.loads(content, format);
+    }
+
+    void reload() {
+        try {
+            snapshot.publish(parse());
+            reloads.fetch_add(1, std::memory_order_relaxed);
+        } catch (const std::exception& error) {
+            if (onError) {
+                onError(error.what());
+            }
+        }
+    }
+
+#ifdef SERIN_HAS_INOTIFY
+    // Editors save by writing in place or by renaming a new file over the
+    // old one, so watch the directory for both and filter by name.
+    void start() {
+        const std::filesystem::path path(filename);
+        const std::string directory = path.has_parent_path() ? path.parent_path().string() : ".";
+        inotify = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotify < 0 || ::inotify_add_watch(inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0 ||
+            ::pipe(stopPipe) != 0) {
+            close();
+            throw std::runtime_error("Cannot watch " + filename);
+        }
+        thread = std::thread([this, name = path.filename().string()] { watch(name); });
+    }
+
+    // True if the pending events name the watched file.
+    bool drain(const std::string& name) {
+        alignas(inotify_event) char buffer[4096];
+        bool changed = false;
+        ssize_t size;
+        while ((size = ::read(inotify, buffer, sizeof(buffer))) > 0) {
+            for (ssize_t offset = 0; offset < size;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                changed |= event->len > 0 && name == event->name;
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+            }
+        }
+        return changed;
+    }
+
+    void watch(const std::string& name) {
+        pollfd fds[2] = {{inotify, POLLIN, 0}, {stopPipe[0], POLLIN, 0}};
+        while (::poll(fds, 2, -1) >= 0 || errno == EINTR) {
+            if (fds[1].revents) {
+                return;
+            }
+            if (!(fds[0].revents & POLLIN) || !drain(name)) {
+                continue;
+            }
+            // Only events for this file restart the window; other files in
+            // the directory are drained and ignored.
+            using Clock = std::chrono::steady_clock;
+            const auto limit = Clock::now() + MAX_SETTLE;
+            auto quiet = Clock::now() + SETTLE;
+            for (auto now = Clock::now(); now < quiet; now = Clock::now()) {
+                const auto wait = std::chrono::ceil<std::chrono::milliseconds>(quiet - now);
+                if (::poll(fds, 2, static_cast<int>(wait.count())) <= 0) {
+                    continue;
+                }
+                if (fds[1].revents) {
+                    return;
+                }
+                if ((fds[0].revents & POLLIN) && drain(name)) {
+                    quiet = std::min(Clock::now() + SETTLE, limit);
+                }
+            }
+            reload();
+        }
+    }
+
+    void stop() {
+        if (thread.joinable()) {
+            const char byte = 0;
+            [[maybe_unused]] const ssize_t written = ::write(stopPipe[1], &byte, 1);
+            thread.join();
+        }
+        close();
+    }
+
+    void close() {
+        for (int fd : {inotify, stopPipe[0], stopPipe[1]}) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+        inotify = stopPipe[0] = stopPipe[1] = -1;
+    }
+#else
+    struct Stamp {
+        uintmax_t size = 0;
+        std::filesystem::file_time_type modified;
+        bool operator!=(const Stamp& other) const { return size != other.size || modified != other.modified; }
+    };
+
+    Stamp stamp() const {
+        std::error_code error;
+        Stamp result;
+        result.size = std::filesystem::file_size(filename, error);
+        result.modified = std::filesystem::last_write_time(filename, error);
+        return result;
+    }
+
+    void start() {
+        thread = std::thread([this, last = stamp()]() mutable {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stopped.wait_for(lock, POLL_INTERVAL, [this] { return stopping; })) {
+                const Stamp current = stamp();
+                if (current != last) {
+                    last = current;
+                    lock.unlock();
+                    reload();
+                    lock.lock();
+                }
+            }
+        });
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        stopped.notify_all();
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+#endif
+};
+
+SnapshotWatcher::SnapshotWatcher(const std::string& filename, Snapshot<Value>& snapshot, ErrorCallback onError,
+                                 Type format)
+    : impl_(std::make_unique<Impl>(filename, format, snapshot, std::move(onError))) {
+    snapshot.publish(impl_->parse());
+    impl_->start();
+}
+
+SnapshotWatcher::~SnapshotWatcher() {
+    impl_->stop();
+}
+
+size_t SnapshotWatcher::reloads() const {
+    return impl_->reloads.load(std::memory_order_relaxed);
+}
+
+} // namespace serin
@@ -1,13 +1,17 @@
 #include "serin.h"
+#include "serin_internal.h"
 #include "utils.h"
 
 #include <algorithm>
 #include <cctype>
 #include <cerrno>
 #include <cmath>
+#include <deque>
+#include <limits>
 #include <cstdlib>
 #include <fstream>
-#include <sstream>
+#include <memory>
+#include <set>
 #include <stdexcept>
 #include <string_view>
 #include <utility>
@@ -18,12 +22,7 @@ namespace {
 
 using serin::trim;
 
-struct Line {
-  int indent{};
-  bool isListItem{};
-  std::string
-      text; // trimmed text (for list items this still contains the leading '-')
-};
+using Line = detail::YamlLine;
 
 Primitive makePrimitiveNull() { return Primitive{std::nullptr_t{}}; }
 
@@ -131,125 +130,269 @@ Value parseScalar(const std::string &token) {
   return Value(parseScalarPrimitive(token));
 }
 
+// Line-oriented YAML parser. Nested blocks are tracked on an explicit stack so
+// document depth is bounded by maxDepth rather than the call stack. With a
+// projection, blocks off the selected paths are skipped by indentation and
+// never turned into Values.
 class YamlParser {
 public:
-  explicit YamlParser(std::vector<Line> lines) : lines_(std::move(lines)) {}
+  // Parses the first `count` entries of `lines`, which may be rewritten.
+  YamlParser(std::vector<Line> &lines, size_t count, size_t maxDepth,
+             const detail::ProjectionNode *projection = nullptr)
+      : lines_(lines), count_(count), maxDepth_(maxDepth) {
+    if (projection && !projection->keep) {
+      sets_.push_back(detail::ProjectionSet{projection});
+    }
+  }
 
   Value parse() {
-    if (lines_.empty()) {
-      return Value(makePrimitiveNull());
+    Value root(makePrimitiveNull());
+    if (count_ == 0) {
+      return root;
     }
-    return parseValue(lines_[0].indent);
+    if (sets_.empty()) {
+      openValue(root, count_, 0);
+    } else if (startsContainer(0)) {
+      openValue(root, count_, 0, &sets_.front());
+    }
+    run();
+    return root;
   }
 
+  // Whether the parse reached the last line, rather than stopping at a line
+  // that does not continue the root block.
+  bool complete() const { return index_ >= count_; }
+
 private:
-  Value parseValue(int indent) {
-    if (index_ >= lines_.size()) {
-      return Value(makePrimitiveNull());
+  struct Frame {
+    enum class Kind {
+      Sequence, // `- ` items at `indent`
+      Mapping,  // `key:` lines at `indent`
+      Item      // end of one sequence item's lines
+    };
+    Kind kind;
+    Value *target;
+    int indent;
+    size_t end; // first line index past the block
+    size_t depth;
+    const detail::ProjectionSet *nodes = nullptr; // null when the whole block is kept
+    size_t items = 0;                             // sequence items seen so far
+    size_t length = 0;                            // sequence length for projection matching
+  };
+
+  bool startsContainer(size_t index) const {
+    return lines_[index].isListItem || lines_[index].text.find(':') != std::string::npos;
+  }
+
+  // Number of items in the sequence whose first item is at `index_`.
+  size_t countItems(int indent, size_t end) const {
+    size_t count = 0;
+    for (size_t i = index_; i < end && lines_[i].indent >= indent; ++i) {
+      if (lines_[i].indent == indent) {
+        if (!lines_[i].isListItem) {
+          break;
+        }
+        ++count;
+      }
     }
+    return count;
+  }
 
-    const Line &current = lines_[index_];
-    if (current.indent > indent) {
-      return parseValue(current.indent);
+  // Whether the line at `index` belongs to the value of a key at `indent`:
+  // it is nested deeper, or is an item of a sequence written at the key's
+  // own indent ("key:\n- a\n- b").
+  bool inValue(size_t index, int indent, size_t end) const {
+    return index < end && (lines_[index].indent > indent ||
+                           (lines_[index].indent == indent && lines_[index].isListItem));
+  }
+
+  // Skips the value of a key at `indent`.
+  void skipBlock(int indent, size_t end) {
+    while (inValue(index_, indent, end)) {
+      ++index_;
+    }
+  }
+
+  // Parses the value starting at the current line into `slot`. Scalars are
+  // stored directly; sequences and mappings are pushed to be filled by run().
+  void openValue(Value &slot, size_t end, size_t depth,
+                 const detail::ProjectionSet *nodes = nullptr) {
+    if (index_ >= end) {
+      return;
     }
 
+    const Line &current = lines_[index_];
     if (current.isListItem) {
-      return parseSequence(current.indent);
+      checkDepth(depth + 1, maxDepth_);
+      slot = Value(Array{});
+      size_t length = static_cast<size_t>(std::numeric_limits<int64_t>::max());
+      if (nodes && detail::needsLength(*nodes)) {
+        length = countItems(current.indent, end);
+      }
+      stack_.push_back(Frame{Frame::Kind::Sequence, &slot, current.indent, end, depth + 1,
+                             nodes, 0, length});
+      return;
     }
 
     if (current.text.find(':') == std::string::npos) {
-      std::string scalarText = trim(current.text);
+      slot = parseScalar(trim(current.text));
       ++index_;
-      return parseScalar(scalarText);
+      return;
     }
 
-    return parseMapping(current.indent);
+    checkDepth(depth + 1, maxDepth_);
+    slot = Value(Object{});
+    stack_.push_back(Frame{Frame::Kind::Mapping, &slot, current.indent, end, depth + 1, nodes});
   }
 
-  Value parseSequence(int indent) {
-    Array result;
-    while (index_ < lines_.size()) {
-      Line line = lines_[index_];
-      if (!line.isListItem || line.indent != indent) {
+  void run() {
+    while (!stack_.empty()) {
+      const Frame frame = stack_.back();
+      switch (frame.kind) {
+      case Frame::Kind::Item:
+        // Lines of the item that its value did not consume are skipped
+        index_ = frame.end;
+        stack_.pop_back();
+        break;
+      case Frame::Kind::Sequence:
+        stepSequence(frame);
+        break;
+      case Frame::Kind::Mapping:
+        stepMapping(frame);
         break;
       }
+    }
+  }
 
-      std::string content = trim(line.text.substr(1));
-      ++index_;
+  void stepSequence(const Frame &frame) {
+    if (index_ >= frame.end || !lines_[index_].isListItem ||
+        lines_[index_].indent != frame.indent) {
+      stack_.pop_back();
+      return;
+    }
 
-      size_t nestedEnd = index_;
-      while (nestedEnd < lines_.size() && lines_[nestedEnd].indent > indent) {
-        ++nestedEnd;
-      }
+    Line &line = lines_[index_];
+    std::string content = trim(std::string_view(line.text).substr(1));
+    const size_t itemLine = index_++;
+    const size_t itemIndex = stack_.back().items++;
 
-      std::vector<Line> nestedLines;
-      if (!content.empty()) {
-        const bool nestedIsList = !content.empty() && content[0] == '-';
-        nestedLines.push_back(Line{indent + 2, nestedIsList, content});
-      }
-      nestedLines.insert(nestedLines.end(), lines_.begin() + index_,
-                         lines_.begin() + nestedEnd);
+    size_t nestedEnd = index_;
+    while (nestedEnd < frame.end && lines_[nestedEnd].indent > frame.indent) {
+      ++nestedEnd;
+    }
 
-      Value element;
-      if (!nestedLines.empty()) {
-        YamlParser nestedParser(std::move(nestedLines));
-        element = nestedParser.parse();
-      } else {
-        element = Value(makePrimitiveNull());
+    // Inline content after the dash is parsed as if it started its own line
+    // just inside the item, followed by the item's nested lines.
+    size_t start = index_;
+    if (!content.empty()) {
+      line.indent = frame.indent + 2;
+      line.isListItem = content[0] == '-';
+      line.text = std::move(content);
+      start = itemLine;
+    }
+
+    const detail::ProjectionSet *nodes = nullptr;
+    if (frame.nodes && !detail::matchItem(*frame.nodes, itemIndex, frame.length, matched_)) {
+      if (matched_.empty() || start == nestedEnd || !startsContainer(start)) {
+        index_ = nestedEnd;
+        return;
       }
+      nodes = &sets_.emplace_back(std::move(matched_));
+    }
 
-      result.push_back(element);
+    Array &result = frame.target->asArray();
+    Value &element = result.emplace_back(makePrimitiveNull());
+    if (start == nestedEnd) {
       index_ = nestedEnd;
+      return;
     }
-    return Value(result);
+
+    stack_.push_back(Frame{Frame::Kind::Item, nullptr, frame.indent, nestedEnd, frame.depth});
+    index_ = start;
+    openValue(element, nestedEnd, frame.depth, nodes);
   }
 
-  Value parseMapping(int indent) {
-    Object result;
-    while (index_ < lines_.size()) {
-      Line line = lines_[index_];
-      if (line.indent != indent || line.isListItem) {
-        break;
+  void stepMapping(const Frame &frame) {
+    const bool atEnd = index_ >= frame.end || lines_[index_].indent != frame.indent ||
+                       lines_[index_].isListItem ||
+                       lines_[index_].text.find(':') == std::string::npos;
+    if (atEnd) {
+      // Projected mappings stay objects even when none of their keys were selected
+      if (!frame.nodes && frame.target->asObject().empty()) {
+        *frame.target = Value(makePrimitiveNull());
       }
+      stack_.pop_back();
+      return;
+    }
 
-      const auto colonPos = line.text.find(':');
-      if (colonPos == std::string::npos) {
-        break;
+    const std::string_view text(lines_[index_].text);
+    const auto colonPos = text.find(':');
+    std::string key = trim(text.substr(0, colonPos));
+    std::string remainder = trim(text.substr(colonPos + 1));
+    ++index_;
+
+    const bool nested = inValue(index_, frame.indent, frame.end);
+    const detail::ProjectionSet *nodes = nullptr;
+    if (frame.nodes && !detail::matchMember(*frame.nodes, key, matched_)) {
+      if (matched_.empty() || !remainder.empty() || !nested || !startsContainer(index_)) {
+        if (remainder.empty()) {
+          skipBlock(frame.indent, frame.end);
+        }
+        if (!matched_.empty()) {
+          // A selected key whose first value is a scalar still shadows later duplicates
+          shadowed_.emplace(frame.target, std::move(key));
+        }
+        return;
       }
-
-      std::string key = trim(std::string_view(line.text).substr(0, colonPos));
-      std::string remainder =
-          trim(std::string_view(line.text).substr(colonPos + 1));
-      ++index_;
-
-      if (!remainder.empty()) {
-        result.emplace(std::move(key), parseScalar(remainder));
-        continue;
+      if (!shadowed_.empty() && shadowed_.count({frame.target, key})) {
+        skipBlock(frame.indent, frame.end);
+        return;
       }
+      nodes = &sets_.emplace_back(std::move(matched_));
+    }
 
-      if (index_ < lines_.size() && lines_[index_].indent > indent) {
-        result.emplace(std::move(key), parseValue(lines_[index_].indent));
-      } else {
-        result.emplace(std::move(key), Value(makePrimitiveNull()));
-      }
+    Object &result = frame.target->asObject();
+    if (!remainder.empty()) {
+      result.emplace(std::move(key), parseScalar(remainder));
+      return;
     }
 
-    if (result.empty()) {
-      return Value(makePrimitiveNull());
+    auto [it, inserted] = result.emplace(std::move(key), Value(makePrimitiveNull()));
+    if (nested) {
+      // Duplicate keys keep their first value; the repeated block is parsed and dropped
+      Value *slot = &it.value();
+      if (!inserted) {
+        discarded_.push_back(std::make_unique<Value>());
+        slot = discarded_.back().get();
+      }
+      openValue(*slot, frame.end, frame.depth, nodes);
     }
-    return Value(result);
   }
 
-  std::vector<Line> lines_;
+  std::vector<Line> &lines_;
+  size_t count_;
   size_t index_ = 0;
+  size_t maxDepth_;
+  std::vector<Frame> stack_;
+  std::vector<std::unique_ptr<Value>> discarded_;
+  std::deque<detail::ProjectionSet> sets_;
+  detail::ProjectionSet matched_;
+  std::set<std::pair<const Value *, std::string>> shadowed_;
 };
 
-std::vector<Line> preprocess(const std::string &yamlString) {
-  std::vector<Line> lines;
-  std::istringstream stream(yamlString);
-  std::string rawLine;
-  while (std::getline(stream, rawLine)) {
-    std::string_view view(rawLine);
+// Splits `yamlString` into non-empty lines, reusing the entries (and their
+// string capacity) already in `lines`. Returns the number of lines produced.
+size_t preprocess(std::string_view yamlString, std::vector<Line> &lines) {
+  size_t count = 0;
+  size_t lineStart = 0;
+  while (lineStart < yamlString.size()) {
+    size_t lineEnd = yamlString.find('\n', lineStart);
+    if (lineEnd == std::string_view::npos) {
+      lineEnd = yamlString.size();
+    }
+    std::string_view view = yamlString.substr(lineStart, lineEnd - lineStart);
+    lineStart = lineEnd + 1;
+
     size_t commentPos = std::string::npos;
     bool inQuotes = false;
     char quoteChar = '\0';
@@ -277,15 +420,38 @@ std::vector<Line> preprocess(const std::string &yamlString) {
       ++indent;
     }
 
-    std::string trimmed = trim(view.substr(indent));
+    std::string_view trimmed = view.substr(indent);
+    while (!trimmed.empty() && std::isspace(static_cast<unsigned char>(trimmed.front()))) {
+      trimmed.remove_prefix(1);
+    }
+    while (!trimmed.empty() && std::isspace(static_cast<unsigned char>(trimmed.back()))) {
+      trimmed.remove_suffix(1);
+    }
     if (trimmed.empty()) {
       continue;
     }
 
-    bool isList = !trimmed.empty() && trimmed[0] == '-';
-    lines.push_back(Line{static_cast<int>(indent), isList, std::move(trimmed)});
+    if (count == lines.size()) {
+      lines.emplace_back();
+    }
+    Line &line = lines[count++];
+    line.indent = static_cast<int>(indent);
+    line.isListItem = trimmed[0] == '-';
+    line.text.assign(trimmed.data(), trimmed.size());
   }
-  return lines;
+  return count;
+}
+
+bool equalsIgnoreCase(std::string_view value, std::string_view lowered) {
+  if (value.size() != lowered.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < value.size(); ++i) {
+    if (std::tolower(static_cast<unsigned char>(value[i])) != lowered[i]) {
+      return false;
+    }
+  }
+  return true;
 }
 
 bool needsQuoting(const std::string &value) {
@@ -304,14 +470,8 @@ bool needsQuoting(const std::string &value) {
     }
   }
 
-  const std::string lower = [&value]() {
-    std::string tmp = value;
-    std::transform(tmp.begin(), tmp.end(), tmp.begin(),
-                   [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
-    return tmp;
-  }();
-
-  if (lower == "null" || lower == "true" || lower == "false" || lower == "~") {
+  if (equalsIgnoreCase(value, "null") || equalsIgnoreCase(value, "true") ||
+      equalsIgnoreCase(value, "false") || value == "~") {
     return true;
   }
 
@@ -344,136 +504,172 @@ bool needsQuoting(const std::string &value) {
   return false;
 }
 
-std::string encodeScalar(const Primitive &primitive) {
-  // Use Primitive::asString() which already uses yyjson for number serialization
-  std::string result = primitive.asString();
-  
+void appendScalar(std::string &out, const Primitive &primitive) {
   // For strings, we still need to handle YAML-specific quoting
-  if (primitive.isString() && needsQuoting(result)) {
-    std::string escaped;
-    escaped.reserve(result.size() + 2);
-    escaped.push_back('"');
-    for (char c : result) {
-      switch (c) {
-      case '\n':
-        escaped += "\\n";
-        break;
-      case '\t':
-        escaped += "\\t";
-        break;
-      case '"':
-        escaped += "\\\"";
-        break;
-      case '\\':
-        escaped += "\\\\";
-        break;
-      default:
-        escaped.push_back(c);
-        break;
-      }
+  if (!primitive.isString() || !needsQuoting(std::get<std::string>(primitive))) {
+    primitive.appendTo(out);
+    return;
+  }
+
+  out.push_back('"');
+  for (char c : std::get<std::string>(primitive)) {
+    switch (c) {
+    case '\n':
+      out += "\\n";
+      break;
+    case '\t':
+      out += "\\t";
+      break;
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    default:
+      out.push_back(c);
+      break;
     }
-    escaped.push_back('"');
-    return escaped;
   }
-  
-  return result;
+  out.push_back('"');
 }
 
-void dumpValue(const Value &value, int indent, int indentStep,
-               std::string &out) {
-  auto indentString = [indent]() {
-    return std::string(static_cast<size_t>(indent), ' ');
-  };
+// Writes YAML without recursion. Each frame is a container whose entries are
+// still being written; the entries of an object nested in a list item that
+// follow its first field are a frame of their own.
+class YamlDumper {
+public:
+  YamlDumper(std::string &out, int indentStep, size_t maxDepth)
+      : out_(out), indentStep_(indentStep), maxDepth_(maxDepth) {}
 
-  if (value.isPrimitive()) {
-    out += indentString();
-    out += encodeScalar(value.asPrimitive());
-    out += '\n';
-    return;
+  void dump(const Value &value) {
+    dumpValue(value, 0, 0);
+    run();
   }
 
-  if (value.isArray()) {
-    const auto &array = value.asArray();
-    if (array.empty()) {
-      out += indentString();
-      out += "[]\n";
+  // Writes one item of an array whose items are at `indent`, as dump() would
+  // for the whole array.
+  void dumpArrayItem(const Value &item, int indent, size_t depth) {
+    dumpItem(item, indent, depth);
+    run();
+  }
+
+private:
+  struct Frame {
+    const Value *container;
+    size_t index;
+    int indent;
+    int valueIndent; // indent of nested values below object keys
+    size_t depth;
+  };
+
+  void dumpValue(const Value &value, int indent, size_t depth) {
+    const size_t indentWidth = static_cast<size_t>(indent);
+
+    if (value.isPrimitive()) {
+      out_.append(indentWidth, ' ');
+      appendScalar(out_, value.asPrimitive());
+      out_ += '\n';
       return;
     }
 
-    for (const auto &element : array) {
-      out += indentString();
-      out += "-";
-      if (element.isPrimitive()) {
-        out.push_back(' ');
-        out += encodeScalar(element.asPrimitive());
-        out += '\n';
-        continue;
-      }
+    const bool empty = value.isArray() ? value.asArray().empty() : value.asObject().empty();
+    if (empty) {
+      out_.append(indentWidth, ' ');
+      out_ += value.isArray() ? "[]\n" : "{}\n";
+      return;
+    }
+
+    push(value, 0, indent, indent + indentStep_, depth + 1);
+  }
 
-      if (element.isObject()) {
-        const auto &object = element.asObject();
-        if (object.empty()) {
-          out += " {}\n";
+  void push(const Value &container, size_t index, int indent, int valueIndent, size_t depth) {
+    checkDepth(depth, maxDepth_);
+    stack_.push_back(Frame{&container, index, indent, valueIndent, depth});
+  }
+
+  // Writes ` key: scalar` or ` key:` followed by the nested value at `valueIndent`.
+  void dumpEntry(const std::string &key, const Value &element, int valueIndent, size_t depth) {
+    out_ += key;
+    out_ += ":";
+    if (element.isPrimitive()) {
+      out_.push_back(' ');
+      appendScalar(out_, element.asPrimitive());
+      out_ += '\n';
+    } else {
+      out_ += '\n';
+      dumpValue(element, valueIndent, depth);
+    }
+  }
+
+  void run() {
+    while (!stack_.empty()) {
+      Frame &frame = stack_.back();
+      const Value &container = *frame.container;
+      const size_t index = frame.index++;
+      const int indent = frame.indent;
+      const int valueIndent = frame.valueIndent;
+      const size_t depth = frame.depth;
+
+      if (container.isObject()) {
+        const auto &object = container.asObject();
+        if (index == object.size()) {
+          stack_.pop_back();
           continue;
         }
+        const auto &[key, element] = object.values_container()[index];
+        out_.append(static_cast<size_t>(indent), ' ');
+        dumpEntry(key, element, valueIndent, depth);
+        continue;
+      }
 
-        auto it = object.begin();
-        const auto end = object.end();
-        out.push_back(' ');
-        out += it->first;
-        out += ":";
-        if (it->second.isPrimitive()) {
-          out.push_back(' ');
-          out += encodeScalar(it->second.asPrimitive());
-          out += '\n';
-        } else {
-          out += '\n';
-          dumpValue(it->second, indent + indentStep, indentStep, out);
-        }
-        ++it;
-        for (; it != end; ++it) {
-          out += std::string(static_cast<size_t>(indent + indentStep), ' ');
-          out += it->first;
-          out += ":";
-          if (it->second.isPrimitive()) {
-            out.push_back(' ');
-            out += encodeScalar(it->second.asPrimitive());
-            out += '\n';
-          } else {
-            out += '\n';
-            dumpValue(it->second, indent + indentStep, indentStep, out);
-          }
-        }
+      const auto &array = container.asArray();
+      if (index == array.size()) {
+        stack_.pop_back();
         continue;
       }
 
-      out += '\n';
-      dumpValue(element, indent + indentStep, indentStep, out);
+      dumpItem(array[index], indent, depth);
     }
-    return;
-  }
-
-  const auto &object = value.asObject();
-  if (object.empty()) {
-    out += indentString();
-    out += "{}\n";
-    return;
   }
 
-  for (const auto &[key, element] : object) {
-    out += indentString();
-    out += key;
-    out += ":";
+  // Writes `- element` at `indent`, an item of an array at `depth`.
+  void dumpItem(const Value &element, int indent, size_t depth) {
+    out_.append(static_cast<size_t>(indent), ' ');
+    out_ += "-";
     if (element.isPrimitive()) {
-      out.push_back(' ');
-      out += encodeScalar(element.asPrimitive());
-      out += '\n';
-    } else {
-      out += '\n';
-      dumpValue(element, indent + indentStep, indentStep, out);
+      out_.push_back(' ');
+      appendScalar(out_, element.asPrimitive());
+      out_ += '\n';
+      return;
+    }
+
+    if (element.isObject()) {
+      const auto &object = element.asObject();
+      if (object.empty()) {
+        out_ += " {}\n";
+        return;
+      }
+
+      // Remaining fields line up under the first one, after its value
+      if (object.size() > 1) {
+        push(element, 1, indent + indentStep_, indent + indentStep_, depth + 1);
+      }
+      const auto &[key, first] = object.values_container()[0];
+      out_.push_back(' ');
+      dumpEntry(key, first, indent + indentStep_, depth + 1);
+      return;
     }
+
+    out_ += '\n';
+    dumpValue(element, indent + indentStep_, depth);
   }
-}
+
+  std::string &out_;
+  int indentStep_;
+  size_t maxDepth_;
+  std::vector<Frame> stack_;
+};
 
 } // namespace
 
@@ -481,19 +677,78 @@ Value loadYaml(const std::string &filename) {
   return loadsYaml(readStringFromFile(filename));
 }
 
-Value loadsYaml(const std::string &yamlString) {
-  auto lines = preprocess(yamlString);
-  YamlParser parser(std::move(lines));
-  return parser.parse();
+namespace detail {
+
+Value parseYaml(std::string_view yaml, std::vector<YamlLine> &lines, size_t maxDepth,
+                const ProjectionNode *projection, bool *complete) {
+  size_t count = 0;
+  {
+    PhaseScope phase(Phase::Parse, yaml.size());
+    count = preprocess(yaml, lines);
+  }
+  PhaseScope phase(Phase::Build, yaml.size());
+  YamlParser parser(lines, count, maxDepth, projection);
+  Value root = parser.parse();
+  if (complete) {
+    *complete = parser.complete();
+  }
+  return root;
 }
 
-std::string dumpsYaml(const Value &value, int indent [[maybe_unused]]) {
-  std::string output;
+StructureSink::Scalar yamlScalarKind(std::string_view token) {
+  using Scalar = StructureSink::Scalar;
+  if (token.empty()) {
+    return Scalar::String;
+  }
+  // Same checks, in the same order, as parseScalarPrimitive
+  if (token == "null" || token == "Null" || token == "NULL" || token == "~") {
+    return Scalar::Null;
+  }
+  if (token == "true" || token == "True" || token == "TRUE" || token == "false" || token == "False" ||
+      token == "FALSE") {
+    return Scalar::Bool;
+  }
+  const std::string text(token);
+  if (looksInteger(text)) {
+    return Scalar::Int;
+  }
+  if (looksFloatingPoint(text)) {
+    return Scalar::Double;
+  }
+  return Scalar::String;
+}
+
+void writeYamlItem(const Value &item, int indent, size_t level, size_t maxDepth, std::string &out) {
+  PhaseScope phase(Phase::Emit);
+  const size_t start = out.size();
   const int indentStep = indent > 0 ? indent : 2;
-  dumpValue(value, 0, indentStep, output);
-  if (!output.empty() && output.back() == '\n') {
-    output.pop_back();
+  checkDepth(level + 1, maxDepth);
+  YamlDumper(out, indentStep, maxDepth)
+      .dumpArrayItem(item, static_cast<int>(level) * indentStep, level + 1);
+  phase.setBytes(out.size() - start);
+}
+
+void writeYaml(const Value &value, int indent, size_t maxDepth, std::string &out) {
+  PhaseScope phase(Phase::Emit);
+  const size_t start = out.size();
+  const int indentStep = indent > 0 ? indent : 2;
+  YamlDumper(out, indentStep, maxDepth).dump(value);
+  if (out.size() > start && out.back() == '\n') {
+    out.pop_back();
   }
+  phase.setBytes(out.size() - start);
+}
+
+} // namespace detail
+
+Value loadsYaml(const std::string &yamlString) {
+  std::vector<Line> lines;
+  return detail::parseYaml(yamlString, lines, getMaxDepth());
+}
+
+std::string dumpsYaml(const Value &value, int indent) {
+  std::string output;
+  detail::writeYaml(value, indent, getMaxDepth(), output);
   return output;
 }
 
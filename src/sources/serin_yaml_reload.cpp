@@ -0,0 +1,289 @@
+#include "serin.h"
+#include "serin_internal.h"
+#include "utils.h"
+
+#include <cctype>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace serin {
+
+namespace {
+
+// A run of text that starts with a line at the root indent and ends before
+// the next one; comments and deeper lines belong to the section above them.
+struct Span {
+    size_t begin = 0;
+    size_t end = 0;
+};
+
+// Splits `yaml` where the loader would start a new member of the root
+// mapping. Returns false when the root is not a mapping (or is empty), which
+// needs a whole parse.
+bool splitSections(std::string_view yaml, std::vector<Span>& spans) {
+    spans.clear();
+    int rootIndent = -1;
+    size_t lineStart = 0;
+    while (lineStart < yaml.size()) {
+        size_t lineEnd = yaml.find('\n', lineStart);
+        if (lineEnd == std::string_view::npos) {
+            lineEnd = yaml.size();
+        }
+        // Same rules as the loader: indent counts spaces, and a line that
+        // is blank or starts with a comment is skipped
+        size_t indent = lineStart;
+        while (indent < lineEnd && yaml[indent] == ' ') {
+            ++indent;
+        }
+        size_t first = indent;
+        while (first < lineEnd && std::isspace(static_cast<unsigned char>(yaml[first]))) {
+            ++first;
+        }
+        if (first < lineEnd && yaml[first] != '#') {
+            const int column = static_cast<int>(indent - lineStart);
+            if (rootIndent < 0) {
+                if (yaml[first] == '-') {
+                    return false;
+                }
+                rootIndent = column;
+                spans.push_back({0, 0});
+            } else if (column == rootIndent && yaml[first] != '-') {
+                spans.back().end = lineStart;
+                spans.push_back({lineStart, 0});
+            }
+        }
+        lineStart = lineEnd + 1;
+    }
+    if (spans.empty()) {
+        return false;
+    }
+    spans.back().end = yaml.size();
+    return true;
+}
+
+} // namespace
+
+struct YamlReloader::Impl {
+    struct Section {
+        uint64_t hash = 0;
+        size_t length = 0;
+        bool complete = false; // the root mapping continues past it
+    };
+
+    // One entry per section of the document, in order; a section that ends
+    // the root mapping without a member of its own is not kept.
+    std::vector<Section> sections;
+    std::vector<Member> entries;
+    // Only used when a key repeats: entries without the later duplicates
+    std::vector<Member> unique;
+    bool duplicates = false;
+    std::unordered_map<std::string, std::shared_ptr<const Value>> index;
+    std::shared_ptr<const Value> root; // set when the root is not a mapping
+    std::vector<detail::YamlLine> lines;
+    std::vector<Span> spans;
+    std::vector<Section> hashes; // of each span of the text being parsed
+    Stats stats;
+
+    const std::vector<Member>& members() const { return duplicates ? unique : entries; }
+
+    // Parses one section as its own document: the key line opens a mapping
+    // at the root indent, exactly as in the whole text. Returns false when
+    // the section holds no member.
+    bool parse(std::string_view text, Section& section, Member& member, Stats& counts) {
+        Value parsed = detail::parseYaml(text, lines, getMaxDepth(), nullptr, &section.complete);
+        ++counts.reparsed;
+        counts.reparsedBytes += text.size();
+        if (!parsed.isObject() || parsed.asObject().empty()) {
+            section.complete = false;
+            return false;
+        }
+        auto it = parsed.asObject().begin();
+        member.first = it->first;
+        member.second = std::make_shared<const Value>(std::move(it.value()));
+        return true;
+    }
+
+    void parseWhole(std::string_view yaml) {
+        Stats counts;
+        counts.sections = 1;
+        counts.reparsed = 1;
+        counts.reparsedBytes = yaml.size();
+        root = std::make_shared<const Value>(detail::parseYaml(yaml, lines, getMaxDepth()));
+        sections.clear();
+        entries.clear();
+        unique.clear();
+        index.clear();
+        duplicates = false;
+        stats = counts;
+    }
+
+    void rebuildIndex() {
+        index.clear();
+        unique.clear();
+        duplicates = false;
+        for (const Member& member : entries) {
+            if (!index.emplace(member.first, member.second).second) {
+                duplicates = true;
+            }
+        }
+        if (duplicates) {
+            std::unordered_set<std::string_view> seen;
+            for (const Member& member : entries) {
+                if (seen.insert(member.first).second) {
+                    unique.push_back(member);
+                }
+            }
+        }
+    }
+
+    void update(std::string_view yaml) {
+        if (!splitSections(yaml, spans)) {
+            parseWhole(yaml);
+            return;
+        }
+        hashes.resize(spans.size());
+        for (size_t i = 0; i < spans.size(); ++i) {
+            hashes[i].length = spans[i].end - spans[i].begin;
+            hashes[i].hash = hash64(yaml.substr(spans[i].begin, hashes[i].length));
+        }
+
+        // An edit usually leaves a common run of sections at both ends; only
+        // the sections between them are looked up by content, or parsed.
+        auto same = [](const Section& a, const Section& b) { return a.hash == b.hash && a.length == b.length; };
+        const size_t oldCount = sections.size();
+        const size_t newCount = hashes.size();
+        size_t prefix = 0;
+        while (prefix < oldCount && prefix < newCount && same(sections[prefix], hashes[prefix])) {
+            ++prefix;
+        }
+        size_t suffix = 0;
+        while (suffix < oldCount - prefix && suffix < newCount - prefix &&
+               same(sections[oldCount - 1 - suffix], hashes[newCount - 1 - suffix])) {
+            ++suffix;
+        }
+        std::unordered_map<uint64_t, size_t> moved;
+        for (size_t i = prefix; i < oldCount - suffix; ++i) {
+            moved.emplace(sections[i].hash, i);
+        }
+
+        // Where each section of the new text comes from: an old section, or
+        // a slot in `parsed`. The loader stops at the first line that does
+        // not continue the root mapping and ignores the rest.
+        struct Source {
+            bool fresh;
+            size_t at;
+        };
+        Stats counts;
+        counts.sections = newCount;
+        std::vector<Source> sources;
+        std::vector<Section> parsedSections;
+        std::vector<Member> parsed;
+        sources.reserve(newCount);
+        for (size_t j = 0; j < newCount; ++j) {
+            size_t source = oldCount;
+            if (j < prefix) {
+                source = j;
+            } else if (j >= newCount - suffix) {
+                source = oldCount - (newCount - j);
+            } else if (const auto found = moved.find(hashes[j].hash);
+                       found != moved.end() && same(sections[found->second], hashes[j])) {
+                source = found->second;
+                moved.erase(found);
+            }
+            if (source < oldCount) {
+                sources.push_back({false, source});
+                if (!sections[source].complete) {
+                    break;
+                }
+                continue;
+            }
+            Section section = hashes[j];
+            Member member;
+            const bool kept = parse(yaml.substr(spans[j].begin, hashes[j].length), section, member, counts);
+            if (kept) {
+                sources.push_back({true, parsed.size()});
+                parsedSections.push_back(section);
+                parsed.push_back(std::move(member));
+            } else if (j == 0) {
+                parseWhole(yaml);
+                return;
+            }
+            if (!section.complete) {
+                break;
+            }
+        }
+
+        // Nothing below throws, short of running out of memory
+        std::vector<Section> nextSections;
+        std::vector<Member> nextEntries;
+        nextSections.reserve(sources.size());
+        nextEntries.reserve(sources.size());
+        std::vector<bool> kept(oldCount, false);
+        for (const Source& source : sources) {
+            if (source.fresh) {
+                nextSections.push_back(parsedSections[source.at]);
+                nextEntries.push_back(std::move(parsed[source.at]));
+            } else {
+                kept[source.at] = true;
+                nextSections.push_back(sections[source.at]);
+                nextEntries.push_back(std::move(entries[source.at]));
+            }
+        }
+
+        // Keys of dropped sections leave the index, keys of parsed ones join
+        // it; a repeated key anywhere needs the first-wins rebuild.
+        bool rebuild = duplicates;
+        if (!rebuild) {
+            for (size_t i = 0; i < oldCount; ++i) {
+                if (!kept[i]) {
+                    index.erase(entries[i].first);
+                }
+            }
+        }
+        sections = std::move(nextSections);
+        entries = std::move(nextEntries);
+        for (size_t i = 0; i < sources.size() && !rebuild; ++i) {
+            if (sources[i].fresh) {
+                rebuild = !index.emplace(entries[i].first, entries[i].second).second;
+            }
+        }
+        if (rebuild) {
+            rebuildIndex();
+        }
+        root.reset();
+        stats = counts;
+    }
+};
+
+YamlReloader::YamlReloader() : impl_(std::make_unique<Impl>()) {}
+
+YamlReloader::~YamlReloader() = default;
+
+const YamlReloader::Stats& YamlReloader::update(std::string_view yaml) {
+    impl_->update(yaml);
+    return impl_->stats;
+}
+
+const std::vector<YamlReloader::Member>& YamlReloader::members() const {
+    return impl_->members();
+}
+
+std::shared_ptr<const Value> YamlReloader::find(const std::string& key) const {
+    const auto it = impl_->index.find(key);
+    return it == impl_->index.end() ? nullptr : it->second;
+}
+
+Value YamlReloader::value() const {
+    const std::vector<Member>& members = impl_->members();
+    if (members.empty()) {
+        return impl_->root ? *impl_->root : Value(nullptr);
+    }
+    Object object;
+    object.reserve(members.size());
+    for (const auto& [key, member] : members) {
+        object.emplace(key, *member);
+    }
+    return Value(std::move(object));
+}
+
+} // namespace serin
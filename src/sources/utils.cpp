@@ -1,4 +1,5 @@
 #include "utils.h"
+#include "serin_internal.h"
 
 #include <cctype>
 #include <fstream>
@@ -6,6 +7,14 @@
 #include <stdexcept>
 #include <algorithm>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SERIN_HAS_MMAP 1
+#endif
+
 namespace serin {
 
 std::string trim(std::string_view view) {
@@ -23,6 +32,13 @@ std::string trim(std::string_view view) {
 }
 
 std::string readStringFromFile(const std::string& filename) {
+    std::string content;
+    readFileInto(filename, content);
+    return content;
+}
+
+void readFileInto(const std::string& filename, std::string& content) {
+    detail::PhaseScope phase(Phase::Read);
     std::ifstream file(filename, std::ios::binary | std::ios::ate);
     if (!file.is_open()) {
         throw std::runtime_error("Cannot open file for reading: " + filename);
@@ -33,17 +49,99 @@ std::string readStringFromFile(const std::string& filename) {
     file.seekg(0, std::ios::beg);
     
     // Read file content directly into string
-    std::string content;
     content.resize(size);
     
-    if (!file.read(&content[0], size)) {
+    if (size > 0 && !file.read(&content[0], size)) {
         throw std::runtime_error("Error reading from file: " + filename);
     }
-    
-    return content;
+    phase.setBytes(content.size());
+}
+
+MappedFile::MappedFile(const std::string& filename, bool sequential) {
+#ifdef SERIN_HAS_MMAP
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file for reading: " + filename);
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Error reading from file: " + filename);
+    }
+    size_ = static_cast<size_t>(info.st_size);
+    if (size_ > 0) {
+        void* address = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address != MAP_FAILED) {
+            ::madvise(address, size_, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+            data_ = static_cast<const char*>(address);
+            mapped_ = true;
+        }
+    }
+    ::close(fd);
+    if (mapped_ || size_ == 0) {
+        return;
+    }
+#endif
+    // Not mappable (or no mmap on this platform): fall back to reading the file
+    readFileInto(filename, buffer_);
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+}
+
+MappedFile::~MappedFile() {
+#ifdef SERIN_HAS_MMAP
+    if (mapped_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+}
+
+FileWriter::FileWriter(const std::string& filename, size_t blockSize)
+    : blockSize_(blockSize), filename_(filename.empty() ? "<stdout>" : filename) {
+    if (filename.empty()) {
+        file_ = stdout;
+    } else {
+        file_ = std::fopen(filename.c_str(), "wb");
+        if (!file_) {
+            throw std::runtime_error("Cannot open file for writing: " + filename);
+        }
+        ownsFile_ = true;
+    }
+    buffer_.reserve(blockSize_ + blockSize_ / 4);
+}
+
+FileWriter::~FileWriter() {
+    if (ownsFile_ && file_) {
+        std::fclose(file_);
+    }
+}
+
+void FileWriter::flush() {
+    detail::PhaseScope phase(Phase::Write, buffer_.size());
+    if (!buffer_.empty() && std::fwrite(buffer_.data(), 1, buffer_.size(), file_) != buffer_.size()) {
+        throw std::runtime_error("Error writing to file: " + filename_);
+    }
+    written_ += buffer_.size();
+    buffer_.clear();
+}
+
+void FileWriter::close() {
+    if (!file_) {
+        return;
+    }
+    flush();
+    bool failed = std::fflush(file_) != 0;
+    if (ownsFile_) {
+        failed = std::fclose(file_) != 0 || failed;
+        file_ = nullptr;
+    }
+    if (failed) {
+        throw std::runtime_error("Error writing to file: " + filename_);
+    }
 }
 
 void writeStringToFile(const std::string& content, const std::string& filename) {
+    detail::PhaseScope phase(Phase::Write, content.size());
     std::ofstream file(filename);
     if (!file.is_open()) {
         throw std::runtime_error("Cannot open file for writing: " + filename);
@@ -63,4 +161,83 @@ std::string toLower(std::string value) {
     return value;
 }
 
+namespace {
+
+constexpr uint64_t PRIME64_1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t PRIME64_3 = 0x165667B19E3779F9ull;
+constexpr uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t PRIME64_5 = 0x27D4EB2F165667C5ull;
+
+uint64_t rotl64(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+uint64_t readLE64(const unsigned char* data) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+uint32_t readLE32(const unsigned char* data) {
+    return static_cast<uint32_t>(data[0]) | static_cast<uint32_t>(data[1]) << 8 |
+           static_cast<uint32_t>(data[2]) << 16 | static_cast<uint32_t>(data[3]) << 24;
+}
+
+uint64_t xxhRound(uint64_t acc, uint64_t input) {
+    return rotl64(acc + input * PRIME64_2, 31) * PRIME64_1;
+}
+
+uint64_t xxhMerge(uint64_t acc, uint64_t value) {
+    return (acc ^ xxhRound(0, value)) * PRIME64_1 + PRIME64_4;
+}
+
+} // namespace
+
+uint64_t hash64(std::string_view data, uint64_t seed) {
+    const auto* p = reinterpret_cast<const unsigned char*>(data.data());
+    const auto* const end = p + data.size();
+    uint64_t hash;
+    if (data.size() >= 32) {
+        uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+        uint64_t v2 = seed + PRIME64_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - PRIME64_1;
+        for (; end - p >= 32; p += 32) {
+            v1 = xxhRound(v1, readLE64(p));
+            v2 = xxhRound(v2, readLE64(p + 8));
+            v3 = xxhRound(v3, readLE64(p + 16));
+            v4 = xxhRound(v4, readLE64(p + 24));
+        }
+        hash = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        hash = xxhMerge(xxhMerge(xxhMerge(xxhMerge(hash, v1), v2), v3), v4);
+    } else {
+        hash = seed + PRIME64_5;
+    }
+    hash += data.size();
+    for (; end - p >= 8; p += 8) {
+        hash = rotl64(hash ^ xxhRound(0, readLE64(p)), 27) * PRIME64_1 + PRIME64_4;
+    }
+    if (end - p >= 4) {
+        hash = rotl64(hash ^ (readLE32(p) * PRIME64_1), 23) * PRIME64_2 + PRIME64_3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        hash = rotl64(hash ^ (*p * PRIME64_5), 11) * PRIME64_1;
+    }
+    hash ^= hash >> 33;
+    hash *= PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= PRIME64_3;
+    return hash ^ (hash >> 32);
+}
+
+void checkDepth(size_t depth, size_t maxDepth) {
+    if (depth > maxDepth) {
+        throw std::runtime_error("Maximum nesting depth of " + std::to_string(maxDepth) + " exceeded");
+    }
+}
+
 } // namespace serin
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <cstdio>
 #include <string>
 #include <string_view>
 
@@ -13,10 +15,71 @@ std::string trim(std::string_view view);
 // Throws std::runtime_error if the file cannot be read.
 std::string readStringFromFile(const std::string& filename);
 
+// Reads the entire content of a file into `content`, reusing its capacity.
+// Throws std::runtime_error if the file cannot be read.
+void readFileInto(const std::string& filename, std::string& content);
+
 // Writes a string to a file.
 // Throws std::runtime_error if the file cannot be written.
 void writeStringToFile(const std::string& content, const std::string& filename);
 
 std::string toLower(std::string value);
 
+// XXH64 of `data`: a fast non-cryptographic hash for detecting changed content.
+uint64_t hash64(std::string_view data, uint64_t seed = 0);
+
+// Read-only view of a whole file. Uses mmap where available so large inputs
+// are paged in on demand; elsewhere the file is read into memory. Pass
+// `sequential` = false for files read out of order, so the kernel does not
+// read ahead. Throws std::runtime_error if the file cannot be opened.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filename, bool sequential = true);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::string_view view() const { return {data_, size_}; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::string buffer_;
+};
+
+// Buffered output to a file, or to stdout when `filename` is empty. Text is
+// appended to buffer() and handed to the OS in large blocks, so memory use
+// does not grow with the output. Throws std::runtime_error on I/O errors.
+class FileWriter {
+public:
+    explicit FileWriter(const std::string& filename, size_t blockSize = 1 << 20);
+    ~FileWriter();
+    FileWriter(const FileWriter&) = delete;
+    FileWriter& operator=(const FileWriter&) = delete;
+
+    std::string& buffer() { return buffer_; }
+    // Writes the buffer out once it holds at least a block.
+    void flushIfFull() {
+        if (buffer_.size() >= blockSize_) {
+            flush();
+        }
+    }
+    void flush();
+    // Flushes and closes the file; errors are reported here rather than in the destructor.
+    void close();
+    size_t bytesWritten() const { return written_ + buffer_.size(); }
+
+private:
+    std::FILE* file_ = nullptr;
+    bool ownsFile_ = false;
+    size_t blockSize_;
+    size_t written_ = 0;
+    std::string buffer_;
+    std::string filename_;
+};
+
+// Throws std::runtime_error when `depth` nested containers exceed `maxDepth`.
+void checkDepth(size_t depth, size_t maxDepth);
+
 } // namespace serin
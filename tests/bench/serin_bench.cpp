@@ -0,0 +1,313 @@
+// Throughput benchmarks for every load/dump path and cross-format conversion.
+//
+// Corpora are tests/data/twitter.json/.toon plus serin::generate() documents
+// of each requested shape and size, so throughput can be charted against size.
+// Results are printed as JSON (or written with --output) so they can be stored
+// as a baseline; --baseline compares a run against one and reports the change.
+
+#include "serin.h"
+#include "CLI11.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Corpus {
+    std::string name;
+    serin::Value value;
+    std::map<serin::Type, std::string> text;
+    size_t nodes = 0;
+};
+
+struct Result {
+    std::string corpus;
+    std::string operation;
+    size_t bytes = 0;
+    size_t nodes = 0;
+    size_t iterations = 0;
+    double seconds = 0.0;      // best iteration
+    serin::MemoryStats memory; // of the last iteration
+
+    double mbPerSecond() const { return seconds > 0 ? bytes / seconds / 1e6 : 0.0; }
+    double nsPerNode() const { return nodes ? seconds * 1e9 / nodes : 0.0; }
+};
+
+const std::vector<serin::Type> FORMATS = {serin::Type::JSON, serin::Type::YAML, serin::Type::TOON};
+
+std::string formatName(serin::Type type) {
+    switch (type) {
+        case serin::Type::JSON: return "json";
+        case serin::Type::YAML: return "yaml";
+        case serin::Type::TOON: return "toon";
+    }
+    return "unknown";
+}
+
+std::string readFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open file: " + filename);
+    }
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+// Parses "64KB", "1MB", "2GB" or a plain byte count.
+size_t parseSize(const std::string& text) {
+    size_t end = 0;
+    const double number = std::stod(text, &end);
+    std::string unit = text.substr(end);
+    std::transform(unit.begin(), unit.end(), unit.begin(), ::toupper);
+    const double scale = unit == "KB" || unit == "K" ? 1 << 10
+                       : unit == "MB" || unit == "M" ? 1 << 20
+                       : unit == "GB" || unit == "G" ? 1 << 30
+                       : unit.empty() || unit == "B" ? 1 : -1;
+    if (scale < 0 || number < 0) {
+        throw std::runtime_error("Invalid size: " + text);
+    }
+    return static_cast<size_t>(number * scale);
+}
+
+Corpus makeCorpus(std::string name, serin::Value value) {
+    Corpus corpus;
+    corpus.name = std::move(name);
+    corpus.nodes = serin::stats(value).nodes();
+    for (const auto type : FORMATS) {
+        corpus.text[type] = serin::dumps(value, type);
+    }
+    corpus.value = std::move(value);
+    return corpus;
+}
+
+std::vector<Corpus> buildCorpora(const std::string& dataDir, const std::vector<std::string>& sizes,
+                                 const std::vector<std::string>& shapes, uint64_t seed) {
+    std::vector<Corpus> corpora;
+    Corpus twitter = makeCorpus("twitter", serin::loadJson(dataDir + "/twitter.json"));
+    // Benchmark loaders on the checked-in text rather than our own re-encoding.
+    twitter.text[serin::Type::JSON] = readFile(dataDir + "/twitter.json");
+    twitter.text[serin::Type::TOON] = readFile(dataDir + "/twitter.toon");
+    corpora.push_back(std::move(twitter));
+    for (const auto& size : sizes) {
+        for (const auto& shape : shapes) {
+            serin::GeneratorOptions options;
+            options.shape = serin::stringToShape(shape);
+            options.targetBytes = parseSize(size);
+            options.seed = seed;
+            corpora.push_back(makeCorpus(shape + "-" + size, serin::generate(options)));
+        }
+    }
+    return corpora;
+}
+
+// Runs `body` until `minSeconds` have elapsed (at least three times) and keeps
+// the fastest iteration; memory statistics come from the last one.
+template <typename Body>
+Result measure(const Corpus& corpus, std::string operation, size_t bytes, double minSeconds, Body&& body) {
+    Result result;
+    result.corpus = corpus.name;
+    result.operation = std::move(operation);
+    result.bytes = bytes;
+    result.nodes = corpus.nodes;
+    result.seconds = 1e300;
+    const auto start = Clock::now();
+    do {
+        serin::resetMemoryStats();
+        const auto begin = Clock::now();
+        body();
+        const std::chrono::duration<double> elapsed = Clock::now() - begin;
+        result.memory = serin::memoryStats();
+        result.seconds = std::min(result.seconds, elapsed.count());
+        ++result.iterations;
+    } while (result.iterations < 3 || std::chrono::duration<double>(Clock::now() - start).count() < minSeconds);
+    return result;
+}
+
+std::vector<Result> runBenchmarks(const std::vector<Corpus>& corpora, const std::string& filter, double minSeconds) {
+    std::vector<Result> results;
+    auto selected = [&](const std::string& name) {
+        return filter.empty() || name.find(filter) != std::string::npos;
+    };
+    for (const auto& corpus : corpora) {
+        for (const auto from : FORMATS) {
+            const std::string& text = corpus.text.at(from);
+            const std::string load = "loads_" + formatName(from);
+            if (selected(corpus.name + "/" + load)) {
+                results.push_back(measure(corpus, load, text.size(), minSeconds, [&] {
+                    serin::Value value = serin::loads(text, from);
+                    (void)value;
+                }));
+            }
+            const std::string dump = "dumps_" + formatName(from);
+            if (selected(corpus.name + "/" + dump)) {
+                results.push_back(measure(corpus, dump, text.size(), minSeconds, [&] {
+                    std::string output = serin::dumps(corpus.value, from);
+                    (void)output;
+                }));
+            }
+            for (const auto to : FORMATS) {
+                const std::string convert = formatName(from) + "_to_" + formatName(to);
+                if (from == to || !selected(corpus.name + "/" + convert)) {
+                    continue;
+                }
+                results.push_back(measure(corpus, convert, text.size(), minSeconds, [&] {
+                    std::string output = serin::dumps(serin::loads(text, from), to);
+                    (void)output;
+                }));
+            }
+        }
+    }
+    return results;
+}
+
+serin::Value toValue(const std::vector<Result>& results) {
+    serin::Array rows;
+    for (const auto& result : results) {
+        serin::Object row;
+        row["corpus"] = serin::Value(result.corpus);
+        row["operation"] = serin::Value(result.operation);
+        row["bytes"] = serin::Value(static_cast<int64_t>(result.bytes));
+        row["nodes"] = serin::Value(static_cast<int64_t>(result.nodes));
+        row["iterations"] = serin::Value(static_cast<int64_t>(result.iterations));
+        row["seconds"] = serin::Value(result.seconds);
+        row["mb_per_s"] = serin::Value(result.mbPerSecond());
+        row["ns_per_node"] = serin::Value(result.nsPerNode());
+        row["allocations"] = serin::Value(static_cast<int64_t>(result.memory.allocations));
+        row["allocated_bytes"] = serin::Value(static_cast<int64_t>(result.memory.bytes));
+        row["peak_bytes"] = serin::Value(static_cast<int64_t>(result.memory.peakBytes));
+        serin::Object phases;
+        for (size_t i = 0; i < serin::PHASE_COUNT; ++i) {
+            const auto phase = static_cast<serin::Phase>(i);
+            const auto& counters = result.memory.phase(phase);
+            if (counters.allocations == 0) {
+                continue;
+            }
+            serin::Object entry;
+            entry["allocations"] = serin::Value(static_cast<int64_t>(counters.allocations));
+            entry["bytes"] = serin::Value(static_cast<int64_t>(counters.bytes));
+            phases[serin::phaseName(phase)] = serin::Value(std::move(entry));
+        }
+        row["phases"] = serin::Value(std::move(phases));
+        rows.push_back(std::move(row));
+    }
+
+    const serin::NodeOverhead overhead = serin::nodeOverhead();
+    serin::Object nodes;
+    nodes["value"] = serin::Value(static_cast<int64_t>(overhead.value));
+    nodes["object_member"] = serin::Value(static_cast<int64_t>(overhead.objectMember));
+    nodes["array_item"] = serin::Value(static_cast<int64_t>(overhead.arrayItem));
+    nodes["inline_string"] = serin::Value(static_cast<int64_t>(overhead.inlineString));
+
+    serin::Object root;
+    root["memory_stats"] = serin::Value(serin::memoryStatsAvailable());
+    root["node_overhead"] = serin::Value(std::move(nodes));
+    root["results"] = serin::Value(std::move(rows));
+    return root;
+}
+
+double numberField(const serin::Object& row, const std::string& key) {
+    const auto it = row.find(key);
+    if (it == row.end() || !it->second.isPrimitive() || !it->second.asPrimitive().isNumber()) {
+        throw std::runtime_error("Baseline entry is missing numeric field '" + key + "'");
+    }
+    return it->second.asPrimitive().getNumber();
+}
+
+// Annotates each result row with the baseline throughput and relative change,
+// prints a summary to stderr and returns the worst slowdown in percent.
+double compareWithBaseline(serin::Value& report, const std::string& baselinePath) {
+    std::map<std::string, double> baseline;
+    const serin::Value stored = serin::loadJson(baselinePath);
+    if (!stored.isObject() || !stored.asObject().count("results") || !stored.asObject().at("results").isArray()) {
+        throw std::runtime_error("Baseline has no 'results' array: " + baselinePath);
+    }
+    for (const auto& entry : stored.asObject().at("results").asArray()) {
+        const auto& row = entry.asObject();
+        baseline[row.at("corpus").asPrimitive().getString() + "/" + row.at("operation").asPrimitive().getString()] =
+            numberField(row, "mb_per_s");
+    }
+
+    double worst = 0.0;
+    std::cerr << std::left << std::setw(28) << "benchmark" << std::right << std::setw(12) << "MB/s"
+              << std::setw(12) << "baseline" << std::setw(10) << "change" << "\n";
+    for (auto& entry : report.asObject().at("results").asArray()) {
+        auto& row = entry.asObject();
+        const std::string name = row.at("corpus").asPrimitive().getString() + "/" + row.at("operation").asPrimitive().getString();
+        const auto it = baseline.find(name);
+        if (it == baseline.end() || it->second <= 0) {
+            continue;
+        }
+        const double current = numberField(row, "mb_per_s");
+        const double change = (current - it->second) / it->second * 100.0;
+        row["baseline_mb_per_s"] = serin::Value(it->second);
+        row["change_percent"] = serin::Value(change);
+        worst = std::min(worst, change);
+        std::cerr << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << current << std::setw(12) << it->second << std::showpos << std::setw(9)
+                  << change << "%" << std::noshowpos << "\n";
+    }
+    return -worst;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    CLI::App app{"serin_bench - throughput benchmarks for serin"};
+
+    std::string dataDir = "tests/data";
+    std::string filter;
+    std::string baselinePath;
+    std::string outputPath;
+    std::vector<std::string> sizes = {"1MB"};
+    std::vector<std::string> shapes = {"table", "wide", "deep", "strings", "numeric", "mixed"};
+    uint64_t seed = 1;
+    double minSeconds = 0.2;
+    double maxRegression = -1.0;
+
+    app.add_option("--data", dataDir, "Directory holding twitter.json and twitter.toon")->capture_default_str();
+    app.add_option("--filter", filter, "Only run benchmarks whose corpus/operation contains this text");
+    app.add_option("--sizes", sizes, "Sizes of the generated corpora, e.g. 64KB 1MB 64MB")->delimiter(',')->capture_default_str();
+    app.add_option("--shapes", shapes, "Generated corpus shapes (see serin generate --help)")->delimiter(',')->capture_default_str();
+    app.add_option("--seed", seed, "Seed for the generated corpora")->capture_default_str();
+    app.add_option("--min-time", minSeconds, "Minimum seconds spent on each benchmark")->capture_default_str();
+    app.add_option("--baseline", baselinePath, "Compare against results stored by an earlier run");
+    app.add_option("--max-regression", maxRegression, "Exit with status 1 if any benchmark is this many percent slower than the baseline");
+    app.add_option("-o,--output", outputPath, "Write the JSON results to a file instead of stdout");
+
+    CLI11_PARSE(app, argc, argv);
+
+    try {
+        serin::enableMemoryStats();
+        const auto corpora = buildCorpora(dataDir, sizes, shapes, seed);
+        serin::Value report = toValue(runBenchmarks(corpora, filter, minSeconds));
+
+        double regression = 0.0;
+        if (!baselinePath.empty()) {
+            regression = compareWithBaseline(report, baselinePath);
+        }
+        if (outputPath.empty()) {
+            std::cout << serin::dumpsJson(report) << std::endl;
+        } else {
+            serin::dumpJson(report, outputPath);
+        }
+        if (maxRegression >= 0 && regression > maxRegression) {
+            std::cerr << "Slowest benchmark regressed by " << std::fixed << std::setprecision(1) << regression
+                      << "% (limit " << maxRegression << "%)\n";
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -2,6 +2,12 @@
 #include "doctest.h"
 #include "serin.h"
 
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
 #include <variant>
 
 namespace {
@@ -329,3 +335,1062 @@ TEST_CASE("Toon options customize formatting supports alternate delimiters") {
     CHECK(toon.find("tags[2]: red|blue") != std::string::npos);
     CHECK(toon.find("name: Alice") != std::string::npos);
 }
+
+TEST_CASE("Primitive formatting appends in place") {
+    std::string out = "value=";
+    serin::Primitive(int64_t{-42}).appendTo(out);
+    CHECK_EQ(out, "value=-42");
+
+    out.clear();
+    serin::Primitive(2.5).appendTo(out);
+    serin::Primitive(true).appendTo(out);
+    serin::Primitive(nullptr).appendTo(out);
+    serin::Primitive(std::string("text")).appendTo(out);
+    CHECK_EQ(out, "2.5truenulltext");
+
+    CHECK_EQ(serin::Primitive(int64_t{7}).asString(), "7");
+    CHECK_EQ(serin::Primitive(false).asString(), "false");
+
+    char buffer[serin::Primitive::MAX_SCALAR_LENGTH];
+    const size_t length = serin::Primitive(-7.25).writeTo(buffer, sizeof(buffer));
+    CHECK_EQ(std::string(buffer, length), "-7.25");
+
+    char small[2] = {'x', 'x'};
+    CHECK_EQ(serin::Primitive(int64_t{12345}).writeTo(small, sizeof(small)), 5);
+    CHECK_EQ(small[0], 'x');
+}
+
+TEST_CASE("Nesting depth is bounded by the configured limit") {
+    const std::string tooDeep = std::string(100000, '[') + std::string(100000, ']');
+    CHECK_THROWS_AS(serin::loadsJson(tooDeep), std::runtime_error);
+
+    const size_t depth = 900;
+    const auto nested = serin::loadsJson(std::string(depth, '[') + "1" + std::string(depth, ']'));
+    const serin::Value* cursor = &nested;
+    for (size_t i = 0; i < depth; ++i) {
+        REQUIRE_EQ(expectArray(*cursor).size(), 1);
+        cursor = &cursor->asArray().front();
+    }
+    CHECK_EQ(expectNumber(*cursor), doctest::Approx(1.0));
+
+    CHECK_NOTHROW(serin::loadsJson(serin::dumpsJson(nested)));
+    CHECK_NOTHROW(serin::dumpsToon(nested));
+    CHECK_NOTHROW(serin::loadsYaml(serin::dumpsYaml(nested)));
+
+    std::string yaml;
+    for (size_t i = 0; i < depth; ++i) {
+        yaml += std::string(2 * i, ' ') + "k:\n";
+    }
+    yaml += std::string(2 * depth, ' ') + "k: 1\n";
+    const auto mapping = serin::loadsYaml(yaml);
+    cursor = &mapping;
+    for (size_t i = 0; i < depth; ++i) {
+        cursor = &expectObject(*cursor).at("k");
+    }
+    CHECK_EQ(expectNumber(expectObject(*cursor).at("k")), doctest::Approx(1.0));
+
+    serin::setMaxDepth(16);
+    CHECK_THROWS_AS(serin::dumpsToon(nested), std::runtime_error);
+    CHECK_THROWS_AS(serin::dumpsYaml(nested), std::runtime_error);
+    CHECK_THROWS_AS(serin::dumpsJson(nested), std::runtime_error);
+    CHECK_THROWS_AS(serin::loadsYaml(yaml), std::runtime_error);
+    serin::setMaxDepth(serin::DEFAULT_MAX_DEPTH);
+}
+
+TEST_CASE("Parser and Encoder contexts can be reused across calls") {
+    serin::Parser parser;
+    serin::Encoder encoder;
+
+    for (int round = 0; round < 3; ++round) {
+        checkSample1User(parser.load("tests/data/sample1_user.json"));
+        checkSample2Users(parser.load("tests/data/sample2_users.yaml"));
+        checkSample3Nested(parser.loadsJson(serin::dumpsJson(serin::loadJson("tests/data/sample3_nested.json"))));
+
+        const auto value = parser.load("tests/data/sample3_nested.yaml");
+        CHECK_EQ(encoder.dumpsJson(value), serin::dumpsJson(value));
+        CHECK_EQ(encoder.dumpsYaml(value), serin::dumpsYaml(value));
+        CHECK_EQ(encoder.dumpsToon(value), serin::dumpsToon(value));
+        CHECK_EQ(encoder.dumps(value, serin::Type::JSON, 0), serin::dumpsJson(value, 0));
+        checkSample3Nested(parser.loadsYaml(encoder.dumpsYaml(value)));
+    }
+
+    CHECK_THROWS_AS(parser.loadsJson("{\"a\": [1, 2"), std::runtime_error);
+    checkSample1User(parser.loadsJson(serin::dumpsJson(serin::loadJson("tests/data/sample1_user.json"))));
+
+    parser.setMaxDepth(2);
+    CHECK_THROWS_AS(parser.loadsJson("[[[1]]]"), std::runtime_error);
+    CHECK_EQ(serin::getMaxDepth(), serin::DEFAULT_MAX_DEPTH);
+}
+
+TEST_CASE("Compiled paths select values by reference") {
+    const auto twitter = serin::loadJson("tests/data/twitter.json");
+    const auto& statuses = expectArray(expectObject(twitter).at("statuses"));
+
+    const serin::Path names("/statuses/*/user/screen_name");
+    CHECK_FALSE(names.isSingular());
+    const auto matches = names.evaluate(twitter);
+    REQUIRE_EQ(matches.size(), statuses.size());
+    CHECK_EQ(matches.front(), &expectObject(statuses.front()).at("user").asObject().at("screen_name"));
+
+    const serin::Path jsonPath("$.statuses[*].user.screen_name");
+    CHECK_EQ(jsonPath.evaluate(twitter), matches);
+
+    const serin::Path first("/statuses/0/id");
+    CHECK(first.isSingular());
+    CHECK_EQ(first.find(twitter), &expectObject(statuses.front()).at("id"));
+    CHECK_EQ(serin::Path("$.statuses[-1].id").find(twitter), &expectObject(statuses.back()).at("id"));
+    CHECK_EQ(serin::Path("$.missing.key").find(twitter), nullptr);
+
+    const auto slice = serin::Path("$.statuses[1:7:2].id").evaluate(twitter);
+    REQUIRE_EQ(slice.size(), 3);
+    CHECK_EQ(slice[1], &expectObject(statuses[3]).at("id"));
+
+    // Strides beyond the array stop after the first item instead of overflowing
+    const auto wide = serin::Path("$.statuses[1:5:9223372036854775807].id").evaluate(twitter);
+    REQUIRE_EQ(wide.size(), 1);
+    CHECK_EQ(wide.front(), &expectObject(statuses[1]).at("id"));
+    const auto back = serin::Path("$.statuses[-1::-9223372036854775807].id").evaluate(twitter);
+    REQUIRE_EQ(back.size(), 1);
+    CHECK_EQ(back.front(), &expectObject(statuses.back()).at("id"));
+
+    const auto users = serin::loadJson("tests/data/sample2_users.json");
+    const auto admins = serin::Path("$.users[?(@.role == 'admin')].name").evaluate(users);
+    REQUIRE_EQ(admins.size(), 1);
+    CHECK_EQ(expectString(*admins.front()), "Alice");
+    CHECK_EQ(serin::Path("$.users[?(@.id > 1)].name").evaluate(users).size(), 1);
+    CHECK_EQ(serin::Path("users[?@.id >= 1]").evaluate(users).size(), 2);
+
+    serin::Object escaped;
+    escaped["a/b"] = serin::Value(int64_t{1});
+    escaped["c d"] = serin::Value(int64_t{2});
+    serin::Value root(escaped);
+    CHECK_EQ(expectNumber(*serin::Path("/a~1b").find(root)), doctest::Approx(1.0));
+    CHECK_EQ(expectNumber(*serin::Path("$['c d']").find(root)), doctest::Approx(2.0));
+    *serin::Path("/a~1b").find(root) = serin::Value(int64_t{5});
+    CHECK_EQ(expectNumber(root.asObject().at("a/b")), doctest::Approx(5.0));
+
+    CHECK_THROWS_AS(serin::Path("$.a[?(@.b == )]"), std::runtime_error);
+    CHECK_THROWS_AS(serin::Path("$..a"), std::runtime_error);
+}
+
+TEST_CASE("Projected loading keeps only the selected subtrees") {
+    const serin::Projection projection{"/statuses/*/user/screen_name", "$.statuses[-1].id",
+                                       "/search_metadata"};
+    const auto full = serin::loadJson("tests/data/twitter.json");
+    const auto sparse = serin::load("tests/data/twitter.json", projection);
+    CHECK_EQ(serin::dumpsJson(sparse), serin::dumpsJson(serin::project(full, projection)));
+
+    const auto& statuses = expectArray(expectObject(sparse).at("statuses"));
+    REQUIRE_EQ(statuses.size(), expectArray(full.asObject().at("statuses")).size());
+    const auto& first = expectObject(statuses.front());
+    CHECK_EQ(first.size(), 1);
+    CHECK_EQ(expectObject(first.at("user")).size(), 1);
+    CHECK(expectObject(statuses.back()).contains("id"));
+    CHECK_EQ(serin::dumpsJson(sparse.asObject().at("search_metadata")),
+             serin::dumpsJson(full.asObject().at("search_metadata")));
+
+    // The YAML loader skips unselected blocks but must agree with the generic filter
+    const std::string yaml = serin::dumpsYaml(full);
+    CHECK_EQ(serin::dumpsJson(serin::loads(yaml, serin::Type::YAML, projection)),
+             serin::dumpsJson(serin::project(serin::loadsYaml(yaml), projection)));
+
+    const auto users = serin::loads(serin::dumpsYaml(serin::loadJson("tests/data/sample2_users.json")),
+                                     serin::Type::YAML, serin::Projection{"/users/1:/name"});
+    const auto& names = expectArray(expectObject(users).at("users"));
+    REQUIRE_EQ(names.size(), 1);
+    CHECK_EQ(expectString(expectObject(names.front()).at("name")), "Bob");
+
+    // Sequences written at their key's indent are skipped or kept whole
+    const std::string indentless = "a:\n- x: 1\n  y: 2\n- x: 3\nb:\n- 4\nc: 5\n";
+    for (const char* path : {"/c", "/a/*/x", "/b"}) {
+        CAPTURE(path);
+        CHECK_EQ(serin::dumpsJson(serin::loads(indentless, serin::Type::YAML, serin::Projection{path})),
+                 serin::dumpsJson(serin::project(serin::loadsYaml(indentless), serin::Projection{path})));
+    }
+
+    CHECK_THROWS_AS(serin::Projection{"$.users[?(@.id > 1)]"}, std::runtime_error);
+}
+
+TEST_CASE("TOON table reader filters rows while tokenising") {
+    serin::ToonTableReader users("tests/data/sample2_users.toon");
+    CHECK_EQ(users.key(), "users");
+    CHECK_EQ(users.declaredRows(), 2);
+    CHECK_EQ(users.fields(), std::vector<std::string>{"id", "name", "role"});
+
+    serin::ToonTableReader::Row row;
+    users.select({"role", "id"});
+    users.where("id > 1");
+    REQUIRE(users.next(row));
+    CHECK_EQ(row.text(0), "user");
+    CHECK_EQ(std::get<int64_t>(row.value(1)), 2);
+    CHECK_FALSE(users.next(row));
+    CHECK_EQ(users.rowsScanned(), 2);
+    CHECK_THROWS_AS(users.select({"missing"}), std::runtime_error);
+
+    serin::Array rows;
+    for (int i = 0; i < 50; ++i) {
+        serin::Object item;
+        item["id"] = serin::Value(int64_t{i});
+        item["city"] = serin::Value(std::string(i % 2 ? "Paris, FR" : "Oslo"));
+        item["score"] = serin::Value(i * 0.5);
+        rows.emplace_back(std::move(item));
+    }
+    serin::Object document;
+    document["rows"] = serin::Value(std::move(rows));
+    const auto path = (std::filesystem::temp_directory_path() / "serin_table_test.toon").string();
+    serin::dumpToon(serin::Value(std::move(document)), path);
+
+    serin::ToonTableReader table(path, "rows");
+    table.select({"id", "city"});
+    table.where("city == 'Paris, FR'");
+    table.where("score >= 20");
+    size_t accepted = 0;
+    while (table.next(row)) {
+        CHECK_EQ(row.text(1), "\"Paris, FR\"");
+        CHECK_EQ(std::get<std::string>(row.value(1)), "Paris, FR");
+        CHECK_GE(std::get<int64_t>(row.value(0)), 40);
+        ++accepted;
+    }
+    CHECK_EQ(accepted, 5);
+    table.rewind();
+    CHECK(table.next(row));
+
+    std::ofstream(path) << "rows[3]{a,b}:\n  1,2\n  3\n";
+    serin::ToonTableReader broken(path);
+    CHECK(broken.next(row));
+    CHECK_THROWS_AS(broken.next(row), std::runtime_error);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Push parser accepts documents in chunks") {
+    auto feedInChunks = [](serin::PushParser& parser, const std::string& text, size_t chunk) {
+        for (size_t pos = 0; pos < text.size(); pos += chunk) {
+            parser.feed(std::string_view(text).substr(pos, chunk));
+        }
+        return parser.finish();
+    };
+
+    const auto twitter = serin::loadJson("tests/data/twitter.json");
+    const std::string json = serin::dumpsJson(twitter);
+    serin::PushParser jsonParser(serin::Type::JSON);
+    CHECK_EQ(serin::dumpsJson(feedInChunks(jsonParser, json, 4093)), json);
+    // The parser resets after finish() and handles scalar roots at the end of input
+    CHECK_EQ(expectNumber(feedInChunks(jsonParser, "12.5", 1)), doctest::Approx(12.5));
+
+    const std::string yaml = serin::dumpsYaml(twitter);
+    const std::string expected = serin::dumpsJson(serin::loadsYaml(yaml));
+    serin::PushParser yamlParser(serin::Type::YAML);
+    CHECK_EQ(serin::dumpsJson(feedInChunks(yamlParser, yaml, 7)), expected);
+
+    serin::Object collected;
+    size_t entries = 0;
+    serin::PushParser streaming(serin::Type::YAML, [&](serin::PushParser::Entry& entry) {
+        CHECK_EQ(entry.index, entries++);
+        collected[entry.key] = std::move(entry.value);
+    });
+    std::ifstream input("tests/data/sample1_user.yaml", std::ios::binary);
+    char buffer[5];
+    while (input.read(buffer, sizeof(buffer)) || input.gcount() > 0) {
+        streaming.feed(buffer, static_cast<size_t>(input.gcount()));
+    }
+    const auto rest = streaming.finish();
+    CHECK(expectObject(rest).empty());
+    CHECK_EQ(entries, collected.size());
+    checkSample1User(serin::Value(std::move(collected)));
+
+    serin::PushParser broken(serin::Type::JSON);
+    CHECK_THROWS_AS(broken.feed("{\"a\": ]"), std::runtime_error);
+
+    // JSON entries are handed over as soon as their last byte arrives
+    std::string items = "[";
+    for (int i = 0; i < 1000; ++i) {
+        items += (i ? ", {\"id\": " : "{\"id\": ") + std::to_string(i) + ", \"tags\": [\"a]\", \"b\"]}";
+    }
+    size_t seen = 0;
+    serin::PushParser arrayParser(serin::Type::JSON, [&](serin::PushParser::Entry& entry) {
+        CHECK_EQ(expectNumber(expectObject(entry.value).at("id")), doctest::Approx(static_cast<double>(seen++)));
+    });
+    for (size_t pos = 0; pos < items.size(); pos += 100) {
+        arrayParser.feed(std::string_view(items).substr(pos, 100));
+    }
+    CHECK(seen >= 999);
+    arrayParser.feed("]");
+    CHECK(expectArray(arrayParser.finish()).empty());
+    CHECK_EQ(seen, 1000u);
+
+    // Duplicate keys and malformed input end up as the loaders have them
+    const std::string duplicates = "{\"a\": 1, \"b\\u0021\": 2, \"a\": 3}";
+    serin::PushParser duplicateParser(serin::Type::JSON);
+    CHECK_EQ(serin::dumpsJson(feedInChunks(duplicateParser, duplicates, 3)),
+             serin::dumpsJson(serin::loadsJson(duplicates)));
+    const std::string stray = "a: 1\nstray\nb: 2\n";
+    std::vector<std::string> keys;
+    serin::PushParser strayParser(serin::Type::YAML, [&](serin::PushParser::Entry& entry) { keys.push_back(entry.key); });
+    strayParser.feed(stray);
+    strayParser.finish();
+    CHECK_EQ(keys, std::vector<std::string>{"a"});
+    CHECK_EQ(serin::dumpsJson(feedInChunks(yamlParser, stray, 4)), serin::dumpsJson(serin::loadsYaml(stray)));
+    CHECK_THROWS_AS(feedInChunks(jsonParser, "[1, 2", 2), std::runtime_error);
+    CHECK_THROWS_AS(feedInChunks(jsonParser, "[1] 2", 2), std::runtime_error);
+}
+
+TEST_CASE("Streaming conversion writes the same text as dump") {
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::temp_directory_path();
+    auto readFile = [](const fs::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    };
+
+    for (const char* input : {"tests/data/twitter.json", "tests/data/sample2_users.json",
+                              "tests/data/sample3_nested.yaml", "tests/data/sample4_users.yaml"}) {
+        CAPTURE(input);
+        const auto value = serin::load(input);
+        for (const char* extension : {".json", ".yaml", ".toon"}) {
+            CAPTURE(extension);
+            const fs::path output = dir / (std::string("serin_stream_test") + extension);
+            serin::convertStream(input, output.string());
+            CHECK_EQ(readFile(output), serin::dumps(value, serin::stringToType(extension + 1)));
+            fs::remove(output);
+        }
+    }
+
+    // Repeated keys and a stray line resolve as the loaders resolve them
+    const fs::path repeatedJson = dir / "serin_stream_repeated.json";
+    const fs::path repeatedYaml = dir / "serin_stream_repeated.yaml";
+    std::ofstream(repeatedJson) << R"({"a": 1, "b": {"c": 2}, "a": 3, "d": 4, "a": 5})";
+    std::ofstream(repeatedYaml) << "a: 1\nb: 2\na: 3\nc: 4\nstray\nd: 5\n";
+    for (const fs::path& input : {repeatedJson, repeatedYaml}) {
+        CAPTURE(input);
+        const auto value = serin::load(input.string());
+        for (const char* extension : {".json", ".yaml"}) {
+            const fs::path output = dir / (std::string("serin_stream_repeated_out") + extension);
+            serin::convertStream(input.string(), output.string());
+            CHECK_EQ(readFile(output), serin::dumps(value, serin::stringToType(extension + 1)));
+            fs::remove(output);
+        }
+    }
+    fs::remove(repeatedJson);
+    fs::remove(repeatedYaml);
+
+    // An array of objects round-trips through NDJSON and a TOON table
+    const auto users = serin::loadsJson(R"([{"id":1,"name":"Ada"},{"id":2,"name":"Alan, T"}])");
+    const fs::path json = dir / "serin_stream_users.json";
+    const fs::path ndjson = dir / "serin_stream_users.ndjson";
+    const fs::path toon = dir / "serin_stream_users.toon";
+    serin::dump(users, json.string());
+    CHECK_EQ(serin::convertStream(json.string(), ndjson.string()), 2u);
+    CHECK_EQ(readFile(ndjson), "{\"id\":1,\"name\":\"Ada\"}\n{\"id\":2,\"name\":\"Alan, T\"}\n");
+    serin::convertStream(ndjson.string(), toon.string());
+    CHECK_EQ(readFile(toon), serin::dumpsToon(users));
+    serin::convertStream(toon.string(), json.string());
+    CHECK_EQ(readFile(json), serin::dumpsJson(users));
+    for (const auto& path : {json, ndjson, toon}) {
+        fs::remove(path);
+    }
+}
+
+TEST_CASE("Validation reports the first error without loading") {
+    CHECK(serin::validate(serin::dumpsJson(serin::loadJson("tests/data/twitter.json")), serin::Type::JSON));
+    CHECK(serin::validateFile("tests/data/sample2_users.toon"));
+    CHECK(serin::validateFile("tests/data/sample3_nested.yaml"));
+
+    const auto json = serin::validate("{\"a\": [1, 2}", serin::Type::JSON);
+    CHECK_FALSE(json.valid);
+    CHECK_EQ(json.offset, 11u);
+    CHECK_EQ(json.column, 12u);
+
+    CHECK(serin::validate("users[2]{id,name}:\n  1,Ada\n  2,\"Bob, Jr\"\n", serin::Type::TOON));
+    CHECK(serin::validate("items[2]:\n  - a: 1\n    b: [2]\n  - 3\n", serin::Type::TOON));
+    const auto shortTable = serin::validate("users[3]{id,name}:\n  1,Ada\n  2,Bob\n", serin::Type::TOON);
+    CHECK_FALSE(shortTable.valid);
+    CHECK_EQ(shortTable.line, 1u);
+    const auto badRow = serin::validate("users[2]{id,name}:\n  1,Ada\n  2\n", serin::Type::TOON);
+    CHECK_EQ(badRow.line, 3u);
+    CHECK_EQ(badRow.column, 3u);
+    CHECK_FALSE(serin::validate("tags[3]: a,b\n", serin::Type::TOON).valid);
+    CHECK_FALSE(serin::validate("a: \"bad \\q\"\n", serin::Type::TOON).valid);
+
+    CHECK(serin::validate("a: 1\nb:\n  - x\n  - 'it''s'\n", serin::Type::YAML));
+    const auto duplicate = serin::validate("a: 1\nb: 2\na: 3\n", serin::Type::YAML);
+    CHECK_EQ(duplicate.line, 3u);
+    CHECK_FALSE(serin::validate("a: 1\n  b: 2\n", serin::Type::YAML).valid);
+    CHECK_FALSE(serin::validate("a: \"open\n", serin::Type::YAML).valid);
+
+    // A key's sequence may sit at the key's own indent, as in sample4_users.yaml
+    CHECK_EQ(serin::dumpsJson(serin::loadYaml("tests/data/sample4_users.yaml")),
+             serin::dumpsJson(serin::loadJson("tests/data/sample4_users.json")));
+    CHECK(serin::validate("a:\n- x\n- y: 1\n  z: 2\nb: 3\n", serin::Type::YAML));
+    CHECK(serin::validate("- a:\n  - x\n  b: 1\n", serin::Type::YAML));
+    CHECK_FALSE(serin::validate("a: 1\n- x\n", serin::Type::YAML).valid);
+
+    // Stricter than the loaders, but never rejects what they read as written
+    for (const auto& entry : std::filesystem::directory_iterator("tests/data")) {
+        const std::string path = entry.path().string();
+        CAPTURE(path);
+        REQUIRE_NOTHROW(serin::load(path));
+        const auto result = serin::validateFile(path);
+        CHECK_MESSAGE(result.valid, result.message);
+    }
+
+    const size_t previous = serin::getMaxDepth();
+    serin::setMaxDepth(2);
+    CHECK_EQ(serin::validate("[[[1]]]", serin::Type::JSON).offset, 2u);
+    serin::setMaxDepth(previous);
+}
+
+TEST_CASE("Document statistics come from one pass without loading") {
+    const serin::Value users = serin::loadJson("tests/data/sample2_users.json");
+    const auto expected = serin::stats(users);
+    CHECK_EQ(expected.tabularArrays, 1u);
+    CHECK_FALSE(expected.keyFrequency.empty());
+    CHECK_EQ(expected.jsonBytes, serin::dumpsJson(users).size());
+    for (const auto type : {serin::Type::JSON, serin::Type::YAML, serin::Type::TOON}) {
+        const auto text = type == serin::Type::JSON ? serin::dumpsJson(users)
+                        : type == serin::Type::YAML ? serin::dumpsYaml(users)
+                                                    : serin::dumpsToon(users);
+        const auto profile = serin::stats(text, type);
+        CHECK_EQ(profile.nodes(), expected.nodes());
+        CHECK_EQ(profile.strings, expected.strings);
+        CHECK_EQ(profile.integers, expected.integers);
+        CHECK_EQ(profile.maxDepth, expected.maxDepth);
+        CHECK_EQ(profile.tabularArrays, expected.tabularArrays);
+        CHECK_EQ(profile.keyFrequency, expected.keyFrequency);
+    }
+
+    const auto twitter = serin::statsFile("tests/data/twitter.json");
+    const auto loaded = serin::stats(serin::loadJson("tests/data/twitter.json"));
+    CHECK_EQ(twitter.nodes(), loaded.nodes());
+    CHECK_EQ(twitter.stringLengths, loaded.stringLengths);
+    CHECK_EQ(twitter.keyFrequency, loaded.keyFrequency);
+
+    // Text the strict scan rejects is profiled as the loader reads it
+    const std::string lenient = "a: 1\n  b: 2\nc: 3\n";
+    CHECK_FALSE(serin::validate(lenient, serin::Type::YAML).valid);
+    CHECK_EQ(serin::stats(lenient, serin::Type::YAML).keyFrequency,
+             serin::stats(serin::loadsYaml(lenient)).keyFrequency);
+    CHECK_EQ(serin::stats("tags[3]: a,b\n", serin::Type::TOON).nodes(),
+             serin::stats(serin::loadsToon("tags[3]: a,b\n")).nodes());
+    CHECK_THROWS_AS(serin::stats("[1,", serin::Type::JSON), std::runtime_error);
+
+    // Every sample profiles; JSON and YAML match their loaded Value
+    for (const auto& entry : std::filesystem::directory_iterator("tests/data")) {
+        const std::string path = entry.path().string();
+        CAPTURE(path);
+        serin::DocumentStats profile;
+        REQUIRE_NOTHROW(profile = serin::statsFile(path));
+        if (entry.path().extension() == ".toon") {
+            continue;
+        }
+        const auto expected = serin::stats(serin::load(path));
+        CHECK_EQ(profile.nodes(), expected.nodes());
+        CHECK_EQ(profile.maxDepth, expected.maxDepth);
+        CHECK_EQ(profile.keyFrequency, expected.keyFrequency);
+    }
+}
+
+TEST_CASE("Generator builds deterministic documents of the requested shape and size") {
+    serin::GeneratorOptions options;
+    options.shape = serin::Shape::Table;
+    options.targetBytes = 64 * 1024;
+    options.seed = 7;
+    const serin::Value table = serin::generate(options);
+    const std::string json = serin::dumpsJson(table);
+    CHECK_EQ(json, serin::dumpsJson(serin::generate(options)));
+    CHECK(json.size() > options.targetBytes * 9 / 10);
+    CHECK(json.size() < options.targetBytes * 11 / 10);
+    CHECK_EQ(serin::stats(table).tabularArrays, 1u);
+    options.seed = 8;
+    CHECK_NE(json, serin::dumpsJson(serin::generate(options)));
+
+    // The streamed file is the document generate() builds
+    const serin::Value document = serin::generate(options);
+    for (const char* extension : {"json", "yaml", "toon"}) {
+        const auto path = std::filesystem::temp_directory_path() / (std::string("serin_generated.") + extension);
+        serin::generateFile(path.string(), options);
+        std::ifstream file(path, std::ios::binary);
+        const std::string written((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        CHECK_EQ(written, serin::dumps(document, serin::stringToType(extension)));
+        std::filesystem::remove(path);
+    }
+
+    options.shape = serin::Shape::Deep;
+    options.depth = 40;
+    options.targetBytes = 16 * 1024;
+    CHECK_EQ(serin::stats(serin::generate(options)).maxDepth, 43u);
+    options.shape = serin::stringToShape("wide");
+    const serin::Value wide = serin::generate(options);
+    REQUIRE(wide.isObject());
+    CHECK(wide.asObject().size() > 100);
+    CHECK_THROWS_AS(serin::stringToShape("round"), std::runtime_error);
+}
+
+TEST_CASE("Memory statistics attribute allocations to load and dump phases") {
+    // The tests link serin_alloc_hooks, so only a platform without block sizes skips this
+    if (!serin::memoryStatsAvailable()) {
+        MESSAGE("skipped: allocation counting is not supported on this platform");
+        return;
+    }
+    const std::string json = serin::dumpsJson(serin::loadJson("tests/data/sample3_nested.json"));
+    serin::enableMemoryStats();
+    serin::resetMemoryStats();
+    serin::Value value = serin::loadsJson(json);
+    const std::string yaml = serin::dumpsYaml(value);
+    const serin::MemoryStats loaded = serin::memoryStats();
+    serin::enableMemoryStats(false);
+
+    using Phase = serin::Phase;
+    CHECK(loaded.phase(Phase::Parse).bytes > 0);
+    CHECK(loaded.phase(Phase::Build).allocations > 0);
+    CHECK(loaded.phase(Phase::Emit).bytes >= yaml.size());
+    CHECK_EQ(loaded.phase(Phase::Read).allocations, 0u);
+    CHECK(loaded.peakBytes >= loaded.liveBytes);
+    CHECK(loaded.peakBytes <= loaded.bytes);
+    CHECK_EQ(std::string(serin::phaseName(Phase::Build)), "build");
+
+    // Nothing is counted while disabled
+    serin::resetMemoryStats();
+    value = serin::loadsYaml(yaml);
+    CHECK_EQ(serin::memoryStats().allocations, 0u);
+
+    const serin::NodeOverhead overhead = serin::nodeOverhead();
+    CHECK_EQ(overhead.value, sizeof(serin::Value));
+    CHECK(overhead.objectMember > overhead.value);
+}
+
+TEST_CASE("Tracing reports the time and bytes of each phase") {
+    if (!serin::tracingAvailable()) {
+        return;
+    }
+    const std::string json = serin::dumpsJson(serin::loadJson("tests/data/sample3_nested.json"));
+    serin::TraceRecorder recorder;
+    recorder.start();
+    const serin::Value value = serin::loadsJson(json);
+    const std::string yaml = serin::dumpsYaml(value);
+    recorder.stop();
+    serin::loadsYaml(yaml);
+
+    const auto events = recorder.events();
+    REQUIRE_EQ(events.size(), 3u);
+    CHECK(events[0].phase == serin::Phase::Parse);
+    CHECK(events[1].phase == serin::Phase::Build);
+    CHECK(events[2].phase == serin::Phase::Emit);
+    CHECK_EQ(events[0].bytes, json.size());
+    CHECK_EQ(events[2].bytes, yaml.size());
+    CHECK(events[1].startNs >= events[0].startNs + events[0].durationNs);
+    CHECK_EQ(recorder.totals()[static_cast<size_t>(serin::Phase::Emit)].count, 1u);
+
+    const serin::Value trace = serin::loadsJson(recorder.chromeTrace());
+    const auto& traceEvents = expectArray(expectObject(trace).at("traceEvents"));
+    REQUIRE_EQ(traceEvents.size(), 3u);
+    CHECK_EQ(expectString(expectObject(traceEvents[1]).at("name")), "build");
+    CHECK_EQ(expectString(expectObject(traceEvents[1]).at("ph")), "X");
+
+    // Streaming reports one event per phase however many entries there are
+    const auto input = std::filesystem::temp_directory_path() / "serin_trace_input.json";
+    const auto output = std::filesystem::temp_directory_path() / "serin_trace_output.yaml";
+    serin::GeneratorOptions options;
+    options.shape = serin::Shape::Table;
+    options.targetBytes = 32 * 1024;
+    serin::generateFile(input.string(), options);
+    size_t streamed = 0;
+    serin::setTraceCallback([&](const serin::TraceEvent& event) { streamed += event.phase == serin::Phase::Emit; });
+    serin::convertStream(input.string(), output.string());
+    serin::setTraceCallback(nullptr);
+    CHECK_EQ(streamed, 1u);
+    std::filesystem::remove(input);
+    std::filesystem::remove(output);
+}
+
+TEST_CASE("Batch load and convert keep input order and collect per-file errors") {
+    const std::vector<std::string> paths = {"tests/data/sample1_user.json", "tests/data/missing.json",
+                                            "tests/data/sample3_nested.json", "tests/data/sample1_user.json"};
+    serin::BatchOptions options;
+    options.threads = 3;
+    const auto loaded = serin::loadMany(paths, options);
+    REQUIRE_EQ(loaded.size(), paths.size());
+    for (size_t i = 0; i < paths.size(); ++i) {
+        CHECK_EQ(loaded[i].path, paths[i]);
+    }
+    CHECK(loaded[0].ok());
+    CHECK_FALSE(loaded[1].ok());
+    CHECK(loaded[2].ok());
+    CHECK_EQ(serin::dumpsJson(loaded[2].value), serin::dumpsJson(serin::loadJson(paths[2])));
+    CHECK_EQ(serin::dumpsJson(loaded[3].value), serin::dumpsJson(loaded[0].value));
+
+    const auto dir = std::filesystem::temp_directory_path();
+    auto readFile = [](const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    };
+    const std::vector<std::pair<std::string, std::string>> pairs = {
+        {paths[0], (dir / "serin_batch_1.yaml").string()},
+        {paths[1], (dir / "serin_batch_2.yaml").string()},
+        {paths[2], (dir / "serin_batch_3.toon").string()}};
+    const auto converted = serin::convertMany(pairs, serin::Type::UNKOWN, options);
+    REQUIRE_EQ(converted.size(), pairs.size());
+    CHECK(converted[0].ok());
+    CHECK_FALSE(converted[1].ok());
+    REQUIRE(converted[2].ok());
+    CHECK_EQ(converted[2].outputBytes, std::filesystem::file_size(pairs[2].second));
+    CHECK_EQ(readFile(pairs[0].second), serin::dumpsYaml(serin::loadJson(paths[0])));
+    CHECK_EQ(readFile(pairs[2].second), serin::dumpsToon(serin::loadJson(paths[2])));
+
+    CHECK(serin::loadMany({}).empty());
+
+    // Batches started from several threads at once share the worker pool
+    std::atomic<size_t> wrong{0};
+    std::vector<std::thread> callers;
+    for (int i = 0; i < 4; ++i) {
+        callers.emplace_back([&] {
+            for (int round = 0; round < 25; ++round) {
+                const auto again = serin::loadMany(paths, options);
+                if (again.size() != paths.size() || !again[2].ok() || again[1].ok()) {
+                    ++wrong;
+                }
+            }
+        });
+    }
+    for (auto& caller : callers) {
+        caller.join();
+    }
+    CHECK_EQ(wrong.load(), 0u);
+    std::filesystem::remove(pairs[0].second);
+    std::filesystem::remove(pairs[2].second);
+}
+
+TEST_CASE("Batch conversion with a manifest skips outputs that are up to date") {
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::temp_directory_path() / "serin_manifest_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    auto write = [](const fs::path& path, const std::string& text) { std::ofstream(path, std::ios::binary) << text; };
+    write(dir / "a.json", "{\"id\": 1}");
+    write(dir / "b.json", "{\"id\": 2}");
+    const std::vector<std::pair<std::string, std::string>> pairs = {
+        {(dir / "a.json").string(), (dir / "a.yaml").string()},
+        {(dir / "b.json").string(), (dir / "b.yaml").string()}};
+    serin::BatchOptions options;
+    options.manifest = (dir / "manifest").string();
+
+    auto skipped = [&] {
+        std::vector<bool> flags;
+        for (const auto& result : serin::convertMany(pairs, serin::Type::UNKOWN, options)) {
+            CHECK(result.ok());
+            flags.push_back(result.skipped);
+        }
+        return flags;
+    };
+    CHECK_EQ(skipped(), std::vector<bool>{false, false});
+    CHECK_FALSE(fs::exists(options.manifest + ".tmp"));
+    CHECK_EQ(skipped(), std::vector<bool>{true, true});
+
+    // Changed input, deleted output, other options and a damaged manifest all convert again
+    write(dir / "a.json", "{\"id\": 3}");
+    CHECK_EQ(skipped(), std::vector<bool>{false, true});
+    CHECK_EQ(expectNumber(expectObject(serin::loadYaml(pairs[0].second)).at("id")), 3);
+    fs::remove(pairs[1].second);
+    CHECK_EQ(skipped(), std::vector<bool>{true, false});
+    options.indent = 4;
+    CHECK_EQ(skipped(), std::vector<bool>{false, false});
+    write(options.manifest, "SERINMF");
+    CHECK_EQ(skipped(), std::vector<bool>{false, false});
+    CHECK_EQ(skipped(), std::vector<bool>{true, true});
+    fs::remove_all(dir);
+}
+
+TEST_CASE("Content sniffing tells JSON, YAML and TOON apart from the first bytes") {
+    CHECK(serin::sniff("{\"id\": 1}") == serin::Type::JSON);
+    CHECK(serin::sniff("\xEF\xBB\xBF  [1, 2, 3]") == serin::Type::JSON);
+    CHECK(serin::sniff("\"text\"") == serin::Type::JSON);
+    CHECK(serin::sniff("[3]: a,b,c") == serin::Type::TOON);
+    CHECK(serin::sniff("users[2]{id,name}:\n  1,Ada\n  2,Alan") == serin::Type::TOON);
+    CHECK(serin::sniff("\"full name\"[2|]: a|b") == serin::Type::TOON);
+    CHECK(serin::sniff("name: Ada\ntags: [1, 2]\n- [3]\n") == serin::Type::YAML);
+    CHECK(serin::sniff("---\nname: Ada") == serin::Type::YAML);
+    CHECK(serin::sniff(" \n\t") == serin::Type::UNKOWN);
+
+    for (const char* name : {"sample1_user", "sample2_users", "sample3_nested", "sample4_users"}) {
+        for (serin::Type type : {serin::Type::JSON, serin::Type::YAML, serin::Type::TOON}) {
+            const char* extension = type == serin::Type::JSON ? ".json" : type == serin::Type::YAML ? ".yaml" : ".toon";
+            const std::string path = std::string("tests/data/") + name + extension;
+            std::ifstream file(path, std::ios::binary);
+            const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            CHECK_MESSAGE(serin::sniff(text) == type, path);
+        }
+    }
+}
+
+TEST_CASE("dumpAll writes every target from one value") {
+    namespace fs = std::filesystem;
+    const serin::Value value = serin::loadJson("tests/data/sample3_nested.json");
+    const fs::path dir = fs::temp_directory_path();
+    const std::vector<serin::DumpTarget> targets = {{(dir / "serin_all.json").string(), serin::Type::UNKOWN, 4},
+                                                    {(dir / "serin_all.yaml").string()},
+                                                    {(dir / "serin_all.out").string(), serin::Type::TOON}};
+    serin::dumpAll(value, targets);
+    auto readFile = [](const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    };
+    CHECK_EQ(readFile(targets[0].path), serin::dumpsJson(value, 4));
+    CHECK_EQ(readFile(targets[1].path), serin::dumpsYaml(value));
+    CHECK_EQ(readFile(targets[2].path), serin::dumpsToon(value));
+
+    // A failing target does not stop the others
+    fs::remove(targets[1].path);
+    CHECK_THROWS_WITH_AS(serin::dumpAll(value, {{(dir / "serin_all.txt").string()}, targets[1]}),
+                         doctest::Contains("serin_all.txt"), std::runtime_error);
+    CHECK(fs::exists(targets[1].path));
+    for (const auto& target : targets) {
+        fs::remove(target.path);
+    }
+}
+
+TEST_CASE("dumpShards splits an array into numbered files that load back to the whole") {
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::temp_directory_path() / "serin_shards";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    serin::GeneratorOptions generator;
+    generator.shape = serin::Shape::Table;
+    generator.targetBytes = 64 * 1024;
+    const serin::Value value = serin::generate(generator);
+    const auto& rows = expectArray(expectObject(value).at("rows"));
+
+    serin::ShardOptions options;
+    options.rows = 100;
+    options.threads = 3;
+    const auto paths = serin::dumpShards(value, (dir / "part.toon").string(), options);
+    REQUIRE_EQ(paths.size(), (rows.size() + 99) / 100);
+    CHECK_EQ(fs::path(paths[1]).filename().string(), "part-00001.toon");
+    std::ifstream file(paths.back(), std::ios::binary);
+    std::string header;
+    std::getline(file, header);
+    CHECK_EQ(header, "rows[" + std::to_string(rows.size() - 100 * (paths.size() - 1)) +
+                         "]{id,name,email,age,score,active,city}:");
+
+    options.rows = 0;
+    options.bytes = 16 * 1024;
+    serin::Array joined;
+    for (const auto& path : serin::dumpShards(value, (dir / "part.json").string(), options)) {
+        CHECK(fs::file_size(path) < 20 * 1024);
+        const serin::Value shard = serin::loadJson(path);
+        for (const auto& row : expectArray(expectObject(shard).at("rows"))) {
+            joined.push_back(row);
+        }
+    }
+    CHECK_EQ(serin::dumpsJson(serin::Value(std::move(joined))), serin::dumpsJson(serin::Value(rows)));
+
+    CHECK_THROWS_AS(serin::dumpShards(serin::Value(1.5), (dir / "x.json").string(), options), std::runtime_error);
+    fs::remove_all(dir);
+}
+
+TEST_CASE("dumpShards writes what dumps() gives each slice and keeps every member") {
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::temp_directory_path() / "serin_shards_members";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    auto readFile = [](const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    };
+    const serin::Value users = serin::loadJson("tests/data/sample4_users.json");
+    const serin::Array& items = expectArray(expectObject(users).at("users"));
+    REQUIRE(items.size() > 1);
+
+    serin::ShardOptions options;
+    options.rows = 1;
+    const std::pair<const char*, serin::Type> formats[] = {
+        {"json", serin::Type::JSON}, {"yaml", serin::Type::YAML},
+        {"toon", serin::Type::TOON}, {"serinb", serin::Type::SERIN_BIN}};
+    for (const auto& [extension, format] : formats) {
+        CAPTURE(extension);
+        const auto paths = serin::dumpShards(users, (dir / "part.").string() + extension, options);
+        REQUIRE_EQ(paths.size(), items.size());
+        for (size_t i = 0; i < paths.size(); ++i) {
+            serin::Object slice;
+            slice.emplace("users", serin::Value(serin::Array{items[i]}));
+            CHECK_EQ(readFile(paths[i]), serin::dumps(serin::Value(std::move(slice)), format));
+        }
+    }
+
+    // Members besides the array would be missing from every shard
+    serin::Object mixed;
+    mixed.emplace("users", serin::Value(items));
+    mixed.emplace("total", serin::Value(int64_t{3}));
+    const fs::path mixedPath = dir / "mixed.json";
+    CHECK_THROWS_WITH_AS(serin::dumpShards(serin::Value(std::move(mixed)), mixedPath.string(), options),
+                         doctest::Contains("other members"), std::runtime_error);
+    CHECK_FALSE(fs::exists(dir / "mixed-00000.json"));
+    fs::remove_all(dir);
+}
+
+TEST_CASE("DocumentCache reuses parsed documents until the file changes") {
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::temp_directory_path() / "serin_cache_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    const std::string a = (dir / "a.yaml").string();
+    const std::string b = (dir / "b.json").string();
+    std::ofstream(a) << "name: first\n";
+    std::ofstream(b) << "{\"id\": 1}";
+
+    serin::DocumentCache cache;
+    const auto first = cache.load(a);
+    CHECK_EQ(cache.load(a).get(), first.get());
+    CHECK_EQ(cache.stats().hits, 1u);
+    CHECK_EQ(cache.stats().misses, 1u);
+    CHECK(cache.stats().bytes > 0);
+
+    // A rewrite with another size is seen by the next load; old handles stay valid
+    std::ofstream(a) << "name: second one\n";
+    const auto second = cache.load(a);
+    CHECK_NE(second.get(), first.get());
+    CHECK_EQ(expectString(expectObject(*first).at("name")), "first");
+    CHECK_EQ(expectString(expectObject(*second).at("name")), "second one");
+    CHECK_EQ(cache.stats().evictions, 1u);
+
+    // Entry and byte limits evict the least recently used document
+    cache.setLimits({size_t{1} << 20, 1});
+    cache.load(b);
+    CHECK_EQ(cache.stats().entries, 1u);
+    cache.load(b);
+    CHECK_EQ(cache.stats().hits, 2u);
+    cache.setLimits({0, 0});
+    CHECK_EQ(cache.stats().entries, 0u);
+    CHECK_THROWS_AS(cache.load((dir / "missing.json").string()), std::runtime_error);
+
+    // load() goes through the cache once one is set
+    auto shared = std::make_shared<serin::DocumentCache>();
+    serin::setLoadCache(shared);
+    serin::load(b);
+    serin::load(b);
+    serin::setLoadCache(nullptr);
+    serin::load(b);
+    CHECK_EQ(shared->stats().hits, 1u);
+    CHECK_EQ(shared->stats().misses, 1u);
+    fs::remove_all(dir);
+}
+
+TEST_CASE("Snapshot readers follow published versions and SnapshotWatcher reloads the file") {
+    serin::Snapshot<int> numbers(1);
+    serin::Snapshot<int>::Reader reader(numbers);
+    CHECK_EQ(reader.get(), 1);
+    const auto held = reader.shared();
+    numbers.publish(2);
+    CHECK_EQ(numbers.version(), 2u);
+    CHECK_EQ(reader.get(), 2);
+    CHECK_EQ(*held, 1);
+
+    // Readers on other threads only ever move forward, and reach the last version
+    std::atomic<bool> backwards{false};
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&] {
+            serin::Snapshot<int>::Reader own(numbers);
+            int last = 0;
+            while (last < 2000) {
+                const int seen = own.get();
+                if (seen < last) {
+                    backwards = true;
+                }
+                last = seen;
+            }
+        });
+    }
+    for (int i = 3; i <= 2000; ++i) {
+        numbers.publish(i);
+    }
+    for (auto& thread : readers) {
+        thread.join();
+    }
+    CHECK_FALSE(backwards);
+    CHECK_EQ(*numbers.load(), 2000);
+
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::temp_directory_path() / "serin_watch_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    const std::string path = (dir / "config.json").string();
+    std::ofstream(path) << "{\"level\": 1}";
+
+    auto waitFor = [](auto&& done) {
+        for (int i = 0; i < 200 && !done(); ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return done();
+    };
+
+    serin::Snapshot<serin::Value> config;
+    std::string lastError;
+    std::mutex errorMutex;
+    serin::SnapshotWatcher watcher(path, config, [&](const std::string& message) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        lastError = message;
+    });
+    serin::Snapshot<serin::Value>::Reader configReader(config);
+    CHECK_EQ(expectNumber(expectObject(configReader.get()).at("level")), 1);
+
+    // Replaced by rename, the way editors save
+    std::ofstream(path + ".tmp") << "{\"level\": 2}";
+    fs::rename(path + ".tmp", path);
+    REQUIRE(waitFor([&] { return watcher.reloads() == 1; }));
+    CHECK_EQ(expectNumber(expectObject(configReader.get()).at("level")), 2);
+
+    // A broken version is reported and the last good one stays
+    std::ofstream(path) << "{\"level\": ";
+    REQUIRE(waitFor([&] {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        return !lastError.empty();
+    }));
+    CHECK_EQ(watcher.reloads(), 1u);
+    CHECK_EQ(expectNumber(expectObject(configReader.get()).at("level")), 2);
+
+    // Other files written faster than the settle window do not hold it open
+    std::atomic<bool> busy{true};
+    std::thread neighbour([&] {
+        while (busy) {
+            std::ofstream(dir / "app.log", std::ios::app) << "line\n";
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    });
+    std::ofstream(path) << "{\"level\": 3}";
+    const bool reloaded = waitFor([&] { return watcher.reloads() == 2; });
+    busy = false;
+    neighbour.join();
+    REQUIRE(reloaded);
+    CHECK_EQ(expectNumber(expectObject(configReader.get()).at("level")), 3);
+
+    CHECK_THROWS_AS(serin::SnapshotWatcher((dir / "missing.json").string(), config), std::runtime_error);
+    fs::remove_all(dir);
+}
+
+TEST_CASE("YamlReloader reparses only the top-level members that changed") {
+    const std::string before = "# settings\nserver:\n  host: local\n  ports:\n    - 80\n    - 443\n"
+                               "limits:\n  cpu: 2\nname: demo\n";
+    const std::string after = "# settings\nserver:\n  host: local\n  ports:\n    - 80\n    - 443\n"
+                              "limits:\n  cpu: 4\n  memory: 8\nname: demo\nextra: [1]\n";
+
+    serin::YamlReloader reloader;
+    CHECK_EQ(reloader.update(before).reparsed, 3u);
+    CHECK_EQ(serin::dumpsJson(reloader.value()), serin::dumpsJson(serin::loadsYaml(before)));
+    const auto server = reloader.find("server");
+    REQUIRE(server);
+
+    const auto& stats = reloader.update(after);
+    CHECK_EQ(stats.sections, 4u);
+    CHECK_EQ(stats.reparsed, 2u);
+    CHECK_EQ(reloader.find("server").get(), server.get());
+    CHECK_EQ(expectNumber(expectObject(*reloader.find("limits")).at("cpu")), 4);
+    CHECK_EQ(reloader.members().size(), 4u);
+    CHECK_EQ(serin::dumpsJson(reloader.value()), serin::dumpsJson(serin::loadsYaml(after)));
+    CHECK_FALSE(reloader.find("missing"));
+
+    // Documents the loader treats specially still come out the same
+    const char* const documents[] = {
+        "a: 1\na: 2\nb:\n  c: 3\n",        // a repeated key keeps its first value
+        "a: 1\n- stray\nb: 2\n",            // a list item at the root ends the mapping
+        "a: 1\n  b: 2\nc: 3\n",             // so does a nested line under a scalar
+        "  a: 1\n  b:\n    - x\nc: 9\n",    // an indented root
+        "- 1\n- 2\n",                       // a sequence root is parsed whole
+        "just text\n",
+        "",
+    };
+    for (const char* document : documents) {
+        CAPTURE(document);
+        reloader.update(document);
+        CHECK_EQ(serin::dumpsJson(reloader.value()), serin::dumpsJson(serin::loadsYaml(document)));
+    }
+
+    // A failed update keeps the previous document
+    reloader.update(before);
+    const size_t previous = serin::getMaxDepth();
+    serin::setMaxDepth(3);
+    CHECK_THROWS_AS(reloader.update(after + "deep:\n  a:\n    b:\n      c: 1\n"), std::runtime_error);
+    serin::setMaxDepth(previous);
+    CHECK_EQ(serin::dumpsJson(reloader.value()), serin::dumpsJson(serin::loadsYaml(before)));
+}
+
+TEST_CASE("Binary snapshots round-trip and are read in place") {
+    namespace fs = std::filesystem;
+    const serin::Value users = serin::loadJson("tests/data/sample2_users.json");
+    const std::string bytes = serin::dumpsBinary(users);
+    CHECK_EQ(serin::sniff(bytes), serin::Type::SERIN_BIN);
+    CHECK_EQ(serin::dumpsJson(serin::loadsBinary(bytes)), serin::dumpsJson(users));
+    CHECK_EQ(serin::dumpsJson(serin::loads(bytes, serin::Type::SERIN_BIN)), serin::dumpsJson(users));
+    CHECK_EQ(serin::stringToType("SerinB"), serin::Type::SERIN_BIN);
+    CHECK_EQ(serin::stringToType("xml"), serin::Type::UNKOWN);
+
+    const fs::path dir = fs::temp_directory_path() / "serin_binary_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    const std::string path = (dir / "twitter.serinb").string();
+    const serin::Value twitter = serin::load("tests/data/twitter.json");
+    serin::dump(twitter, path);
+    CHECK_EQ(serin::dumpsJson(serin::load(path)), serin::dumpsJson(twitter));
+
+    const serin::BinaryDocument document(path);
+    const serin::BinaryView statuses = document.root().at("statuses");
+    const serin::Array& expected = expectArray(expectObject(twitter).at("statuses"));
+    REQUIRE(statuses.isArray());
+    REQUIRE_EQ(statuses.size(), expected.size());
+    const serin::BinaryView first = statuses[0];
+    CHECK_EQ(first.at("text").asString(), expectString(expectObject(expected[0]).at("text")));
+    CHECK_EQ(first.at("id").asDouble(), expectNumber(expectObject(expected[0]).at("id")));
+    CHECK_EQ(first.key(0), expectObject(expected[0]).begin()->first);
+    CHECK_FALSE(first.find("no such key"));
+    CHECK_EQ(serin::dumpsJson(first.toValue()), serin::dumpsJson(expected[0]));
+    CHECK_THROWS_AS(first.asInt(), std::runtime_error);
+    CHECK_THROWS_AS(statuses[expected.size()], std::runtime_error);
+
+    // Damaged input is reported, not read out of bounds
+    CHECK_THROWS_AS(serin::loadsBinary(bytes.substr(0, bytes.size() / 2)), std::runtime_error);
+    std::string bad = bytes;
+    bad[40] = '\x7F'; // root slot payload
+    CHECK_THROWS_AS(serin::loadsBinary(bad), std::runtime_error);
+    CHECK_THROWS_AS(serin::BinaryDocument::fromBytes("{\"a\": 1}"), std::runtime_error);
+
+    // validate() and stats() walk the slots without building a Value
+    CHECK(serin::validate(bytes, serin::Type::SERIN_BIN));
+    CHECK(serin::validateFile(path));
+    const serin::ValidationResult damaged = serin::validate(bad, serin::Type::SERIN_BIN);
+    CHECK_FALSE(damaged);
+    CHECK_EQ(damaged.offset, 32u);
+    CHECK_FALSE(serin::validate(bytes.substr(0, bytes.size() / 2), serin::Type::SERIN_BIN));
+    std::string cyclic = bytes;
+    cyclic.replace(32, 16, std::string("\x05\0\0\0\x01\0\0\0\x20\0\0\0\0\0\0\0", 16)); // [root]
+    CHECK_FALSE(serin::validate(cyclic, serin::Type::SERIN_BIN));
+    const serin::DocumentStats binaryStats = serin::statsFile(path);
+    const serin::DocumentStats textStats = serin::stats(twitter);
+    CHECK_EQ(binaryStats.nodes(), textStats.nodes());
+    CHECK_EQ(binaryStats.maxDepth, textStats.maxDepth);
+    CHECK_EQ(binaryStats.keyFrequency, textStats.keyFrequency);
+    CHECK_THROWS_AS(serin::stats(bad, serin::Type::SERIN_BIN), std::runtime_error);
+
+    const serin::Projection names{"$.users[*].name"};
+    CHECK_EQ(serin::dumpsJson(serin::loads(bytes, serin::Type::SERIN_BIN, names)),
+             serin::dumpsJson(serin::project(users, names)));
+    CHECK_EQ(serin::dumpsJson(serin::load(path, serin::Projection{"/search_metadata"})),
+             serin::dumpsJson(serin::project(twitter, serin::Projection{"/search_metadata"})));
+
+    // Streamed entry by entry, and split into shards of about 16 KB
+    const std::string streamed = (dir / "streamed.json").string();
+    CHECK_EQ(serin::convertStream(path, streamed), expectObject(twitter).size());
+    CHECK_EQ(serin::dumpsJson(serin::loadJson(streamed)), serin::dumpsJson(twitter));
+    serin::ShardOptions shardOptions;
+    shardOptions.bytes = 16 * 1024;
+    size_t rows = 0;
+    serin::Object onlyStatuses;
+    onlyStatuses.emplace("statuses", expectObject(twitter).at("statuses"));
+    CHECK_THROWS_AS(serin::dumpShards(twitter, (dir / "part.serinb").string(), shardOptions), std::runtime_error);
+    const auto shards =
+        serin::dumpShards(serin::Value(std::move(onlyStatuses)), (dir / "part.serinb").string(), shardOptions);
+    CHECK(shards.size() > 2);
+    for (const auto& shard : shards) {
+        CHECK(fs::file_size(shard) < 24 * 1024);
+        rows += expectArray(expectObject(serin::loadBinary(shard)).at("statuses")).size();
+    }
+    CHECK_EQ(rows, expected.size());
+    fs::remove_all(dir);
+}